@@ -444,10 +444,10 @@ bool FC64Emulator::Init()
 void FC64Emulator::SetupCodeAnalysisLabels()
 {
     // Add IO Labels to code analysis
-    AddVICRegisterLabels(IOSystem[0]);  // Page $D000-$D3ff
-    AddSIDRegisterLabels(IOSystem[1]);  // Page $D400-$D7ff
-    IOSystem[2].SetLabelAtAddress("ColourRAM", ELabelType::Data, 0x0000);    // Colour RAM $D800
-    AddCIARegisterLabels(IOSystem[3]);  // Page $DC00-$Dfff
+    AddVICRegisterLabels(CodeAnalysis, IOSystem[0]);  // Page $D000-$D3ff
+    AddSIDRegisterLabels(CodeAnalysis, IOSystem[1]);  // Page $D400-$D7ff
+    IOSystem[2].SetLabelAtAddress(CodeAnalysis, "ColourRAM", ELabelType::Data, 0x0000);    // Colour RAM $D800
+    AddCIARegisterLabels(CodeAnalysis, IOSystem[3]);  // Page $DC00-$Dfff
 }
 
 void FC64Emulator::UpdateCodeAnalysisPages(uint8_t cpuPort)
@@ -537,6 +537,25 @@ void FC64Emulator::UpdateCodeAnalysisPages(uint8_t cpuPort)
         }
     }
 
+    // Point the analyser's memory reads at whatever the CPU port has paged in
+    // I/O pages have no backing memory so reads there go through the CPU interface
+    for (int pageNo = 40; pageNo < 64; pageNo++)
+    {
+        const uint16_t pageAddr = (uint16_t)(pageNo * FCodeAnalysisPage::kPageSize);
+        uint8_t* pReadMem = &C64Emu.ram[pageAddr];
+
+        if (pageNo < 48 && bBasicROMMapped)
+            pReadMem = &C64Emu.rom_basic[pageAddr - 0xA000];
+        else if (pageNo >= 52 && pageNo < 56 && bIOMapped)
+            pReadMem = nullptr;
+        else if (pageNo >= 52 && pageNo < 56 && bCharacterROMMapped)
+            pReadMem = &C64Emu.rom_char[pageAddr - 0xD000];
+        else if (pageNo >= 56 && bKernelROMMapped)
+            pReadMem = &C64Emu.rom_kernal[pageAddr - 0xE000];
+
+        CodeAnalysis.SetPageMemory(pageNo, pReadMem, nullptr);
+    }
+
     // FIXME: invalid signature for method SetCodeAnalysisDirty
     //CodeAnalysis.SetCodeAnalysisDirty();
 }
@@ -671,7 +690,10 @@ void FC64Emulator::Tick()
     const float frameTime = (float)std::min(1000000.0f / ImGui::GetIO().Framerate, 32000.0f) * 1.0f;// speccyInstance.ExecSpeedScale;
     FCodeAnalysisViewState& viewState =  CodeAnalysis.GetFocussedViewState();
 
+    CodeAnalysis.Debugger.ProcessCommands();
     c64_exec(&C64Emu, (uint32_t)std::max(static_cast<uint32_t>(frameTime), uint32_t(1)));
+    if (CodeAnalysis.Debugger.IsStopped() == false)
+        CodeAnalysis.OnFrameEnd();
 
     ui_c64_draw(&C64UI);
     if (ImGui::Begin("C64 Screen"))
@@ -868,8 +890,6 @@ int    FC64Emulator::OnCPUTrap(uint16_t pc, int ticks, uint64_t pins)
     const bool bWrite = !!(pins & M6502_RW);
 
     bool bBreak = RegisterCodeExecuted(CodeAnalysis, LastPC, pc);
-    FCodeInfo* pCodeInfo = CodeAnalysis.GetCodeInfoForAddress(LastPC);
-    pCodeInfo->FrameLastExecuted = CodeAnalysis.CurrentFrameNo;
 
     // check for breakpointed code line
     if (bBreak)
@@ -923,6 +943,7 @@ uint64_t FC64Emulator::OnCPUTick(uint64_t pins)
             // FIXME: parameter conversion for SetLastWriterForAddress
             FAddressRef pcRef(0, pc);
             CodeAnalysis.SetLastWriterForAddress(addr, pcRef);
+            CodeAnalysis.InvalidateDecodedInstructionOnWrite(addr);	// writes aren't registered so there's no SMC check
 
             if (bIOMapped && (addr >> 12) == 0xd)
             {
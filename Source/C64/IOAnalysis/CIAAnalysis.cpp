@@ -97,18 +97,18 @@ void	FCIAAnalysis::DrawUI(void)
 	ImGui::EndChild();
 }
 
-void AddCIARegisterLabels(FCodeAnalysisPage& IOPage)
+void AddCIARegisterLabels(FCodeAnalysisState& state, FCodeAnalysisPage& IOPage)
 {
 	// CIA 1 -$DC00 - $DC0F
 	std::vector<FRegDisplayConfig>& CIA1RegList = g_CIA1RegDrawInfo;
 
 	for (int reg = 0; reg < (int)CIA1RegList.size(); reg++)
-		IOPage.SetLabelAtAddress(CIA1RegList[reg].Name, ELabelType::Data, reg);
+		IOPage.SetLabelAtAddress(state, CIA1RegList[reg].Name, ELabelType::Data, reg);
 
 	// CIA 2 -$DD00 - $DD0F
 	std::vector<FRegDisplayConfig>& CIA2RegList = g_CIA1RegDrawInfo;
 
 	for (int reg = 0; reg < (int)CIA2RegList.size(); reg++)
-		IOPage.SetLabelAtAddress(CIA2RegList[reg].Name, ELabelType::Data, reg + 0x100);	// offset by 256 bytes
+		IOPage.SetLabelAtAddress(state, CIA2RegList[reg].Name, ELabelType::Data, reg + 0x100);	// offset by 256 bytes
 
 }
\ No newline at end of file
@@ -39,4 +39,4 @@ public:
 	FCIA2Analysis();
 };
 
-void AddCIARegisterLabels(FCodeAnalysisPage& IOPage);
\ No newline at end of file
+void AddCIARegisterLabels(FCodeAnalysisState& state, FCodeAnalysisPage& IOPage);
\ No newline at end of file
@@ -24,4 +24,4 @@ private:
 	FCodeAnalysisState* pCodeAnalysis = nullptr;
 };
 
-void AddSIDRegisterLabels(FCodeAnalysisPage& IOPage);
\ No newline at end of file
+void AddSIDRegisterLabels(FCodeAnalysisState& state, FCodeAnalysisPage& IOPage);
\ No newline at end of file
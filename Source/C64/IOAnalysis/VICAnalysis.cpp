@@ -222,8 +222,8 @@ void FVICAnalysis::DrawUI(void)
 	ImGui::EndChild();
 }
 
-void AddVICRegisterLabels(FCodeAnalysisPage& IOPage)
+void AddVICRegisterLabels(FCodeAnalysisState& state, FCodeAnalysisPage& IOPage)
 {
 	for(int reg=0;reg< (int)g_VICRegDrawInfo.size();reg++)
-		IOPage.SetLabelAtAddress(g_VICRegDrawInfo[reg].Name, ELabelType::Data, reg);
+		IOPage.SetLabelAtAddress(state, g_VICRegDrawInfo[reg].Name, ELabelType::Data, reg);
 }
\ No newline at end of file
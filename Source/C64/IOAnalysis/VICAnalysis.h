@@ -24,4 +24,4 @@ private:
 	FCodeAnalysisState* pCodeAnalysis = nullptr;
 };
 
-void AddVICRegisterLabels(FCodeAnalysisPage& IOPage);
\ No newline at end of file
+void AddVICRegisterLabels(FCodeAnalysisState& state, FCodeAnalysisPage& IOPage);
\ No newline at end of file
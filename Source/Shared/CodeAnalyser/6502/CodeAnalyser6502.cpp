@@ -1,73 +1,6 @@
 #include "CodeAnalyser6502.h"
 #include "../CodeAnalyser.h"
-
-enum class EAddressMode : uint8_t
-{
-	ZPIndirect_X,
-	ZP,
-	Immediate,
-	Absolute,
-	ZPIndirect_Y,
-	ZP_X,
-	Absolute_Y,
-	Absolute_X,
-	Accumulator,
-	NA
-};
-
-static EAddressMode g_Group00_AddressModes[8] =
-{
-	EAddressMode::Immediate,	// 000
-	EAddressMode::ZP,			// 001
-	EAddressMode::NA,			// 010 - missing
-	EAddressMode::Absolute,		// 011
-	EAddressMode::NA,			// 100 - missing
-	EAddressMode::ZP_X,			// 101
-	EAddressMode::NA,			// 110 - missing
-	EAddressMode::Absolute_X,	// 111
-};
-
-static EAddressMode g_Group01_AddressModes[8] =
-{
-	EAddressMode::ZPIndirect_X,
-	EAddressMode::ZP,
-	EAddressMode::Immediate,
-	EAddressMode::Absolute,
-	EAddressMode::ZPIndirect_Y,
-	EAddressMode::ZP_X,
-	EAddressMode::Absolute_Y,
-	EAddressMode::Absolute_X,
-};
-
-static EAddressMode g_Group10_AddressModes[8] =
-{
-	EAddressMode::Immediate,
-	EAddressMode::ZP,
-	EAddressMode::Accumulator,
-	EAddressMode::Absolute,
-	EAddressMode::NA,	// 100 - missing
-	EAddressMode::ZP_X,
-	EAddressMode::NA,	// 110 - missing
-	EAddressMode::Absolute_X,
-};
-
-EAddressMode GetInstructionAddressMode(uint8_t opcode)
-{
-	const uint8_t instrGroup = opcode & 3;
-	const uint8_t addrMode = (opcode >> 2) & 7;
-
-	switch (instrGroup)
-	{
-		case 0x00:
-			return g_Group00_AddressModes[addrMode];
-		case 0x01:
-			return g_Group01_AddressModes[addrMode];
-		case 0x02:
-			return g_Group10_AddressModes[addrMode];
-	}
-
-	return EAddressMode::NA;
-}
+#include "M6502OpcodeInfo.h"
 
 bool CheckPointerIndirectionInstruction6502(const FCodeAnalysisState& state, uint16_t pc, uint16_t* out_addr)
 {
@@ -82,12 +15,12 @@ bool CheckPointerIndirectionInstruction6502(const FCodeAnalysisState& state, uin
 	}*/
 
 	// otherwise decode addressing mode
-	const EAddressMode addrMode = GetInstructionAddressMode(instrByte);
+	const EM6502AddressMode addrMode = GetM6502OpcodeInfo(instrByte).AddressMode;
 
 	switch (addrMode)
 	{
-	case EAddressMode::ZPIndirect_X:
-	case EAddressMode::ZPIndirect_Y:
+	case EM6502AddressMode::ZPIndirect_X:
+	case EM6502AddressMode::ZPIndirect_Y:
 		*out_addr = state.ReadByte(pc + 1);
 		return true;
 	}
@@ -119,18 +52,18 @@ bool CheckPointerRefInstruction6502(const FCodeAnalysisState& state, uint16_t pc
 	}*/
 
 	// otherwise decode addressing mode
-	const EAddressMode addrMode = GetInstructionAddressMode(instrByte);
+	const EM6502AddressMode addrMode = GetM6502OpcodeInfo(instrByte).AddressMode;
 
 	switch (addrMode)
 	{
-	case EAddressMode::Absolute:
-	case EAddressMode::Absolute_X:
-	case EAddressMode::Absolute_Y:
+	case EM6502AddressMode::Absolute:
+	case EM6502AddressMode::Absolute_X:
+	case EM6502AddressMode::Absolute_Y:
 		*out_addr = state.ReadWord(pc + 1);
 		return true;
 
-	case EAddressMode::ZP:
-	case EAddressMode::ZP_X:
+	case EM6502AddressMode::ZP:
+	case EM6502AddressMode::ZP_X:
 		*out_addr = state.ReadByte(pc + 1);
 		return true;
 	}
@@ -191,17 +124,10 @@ bool CheckJumpInstruction6502(const FCodeAnalysisState& state, uint16_t pc, uint
 {
 	const uint8_t instrByte = state.ReadByte(pc);
 
-	switch (instrByte)
+	switch (GetM6502OpcodeInfo(instrByte).Flow)
 	{
 		// to relative address
-		case 0x10:	// BPL
-		case 0x30:	// BMI
-		case 0x50:	// BVC
-		case 0x70:	// BVS
-		case 0x90:	// BCC
-		case 0xB0:	// BCS
-		case 0xD0:	// BNE
-		case 0xF0:	// BEQ
+		case EM6502Flow::Branch:
 		{
 			const int8_t relJump = (int8_t)state.ReadByte(pc + 1);
 			*out_addr = pc + 2 + relJump;	// +2 because it's relative to the next instruction
@@ -209,43 +135,26 @@ bool CheckJumpInstruction6502(const FCodeAnalysisState& state, uint16_t pc, uint
 		}
 			
 		// to absolute 16 address
-		case 0x20:	// JSR
-		case 0x4C:	// JMP abs
-		//case 0x6C:	// JMP indirect
+		case EM6502Flow::Call:
+		case EM6502Flow::Jump:
 			*out_addr = state.ReadWord(pc + 1);
 			return true;
-		case 0x6C:	// JMP indirect
+		case EM6502Flow::JumpIndirect:
 			*out_addr = state.ReadWord(state.ReadWord(pc + 1));
-		return true;
+			return true;
+		default:
+			return false;
 	}
-	return false;
 }
 
 bool CheckCallInstruction6502(const FCodeAnalysisState& state, uint16_t pc)
 {
-	const uint8_t instrByte = state.ReadByte(pc);
-
-	switch (instrByte)
-	{
-	case 0x20:	// JSR
-		return true;
-	}
-	return false;
+	return GetM6502OpcodeInfo(state.ReadByte(pc)).Flow == EM6502Flow::Call;
 }
 
 bool CheckStopInstruction6502(const FCodeAnalysisState& state, uint16_t pc)
 {
-	const uint8_t instrByte = state.ReadByte(pc);
-
-	switch (instrByte)
-	{
-	case 0x00:	// BRK
-	case 0x20:	// JSR
-	case 0x40:	// RTI
-	case 0x60:	// RTS
-		return true;
-	}
-	return false;
+	return GetM6502OpcodeInfo(state.ReadByte(pc)).bStopsAnalysis;
 }
 
 bool RegisterCodeExecuted6502(FCodeAnalysisState& state, uint16_t pc, uint16_t oldpc)
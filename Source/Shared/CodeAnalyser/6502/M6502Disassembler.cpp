@@ -1,6 +1,6 @@
 #include "M6502Disassembler.h"
 
-uint16_t M6502DisassembleCodeInfoItem(uint16_t pc, FCodeAnalysisState& state, FCodeInfo* pCodeInfo)
+uint16_t M6502DisassembleCodeInfoItem(uint16_t pc, FCodeAnalysisState& state, const FCodeInfo* pCodeInfo, std::string& outText)
 {
 	// TODO: Implement
 	return pc;
@@ -0,0 +1,127 @@
+#pragma once
+#include <cstdint>
+#include <array>
+
+// Compile time table of the 6502 opcode properties the analyser cares about
+
+enum class EM6502AddressMode : uint8_t
+{
+	ZPIndirect_X,
+	ZP,
+	Immediate,
+	Absolute,
+	ZPIndirect_Y,
+	ZP_X,
+	Absolute_Y,
+	Absolute_X,
+	Accumulator,
+	NA
+};
+
+enum class EM6502Flow : uint8_t
+{
+	None,
+	Branch,			// relative conditional branch
+	Jump,			// JMP abs
+	JumpIndirect,	// JMP (abs)
+	Call,			// JSR
+	Return,			// RTS, RTI
+	Break,			// BRK
+};
+
+struct FM6502OpcodeInfo
+{
+	EM6502AddressMode	AddressMode = EM6502AddressMode::NA;
+	EM6502Flow			Flow = EM6502Flow::None;
+	bool				bStopsAnalysis = false;	// static analysis doesn't continue to the next instruction
+};
+
+typedef std::array<FM6502OpcodeInfo, 256> FM6502OpcodeTable;
+
+// address mode is encoded in bits 2-4, with a different mapping for each instruction group in bits 0-1
+constexpr EM6502AddressMode GetM6502GroupAddressMode(uint8_t opcode)
+{
+	constexpr EM6502AddressMode kGroup00_AddressModes[8] =
+	{
+		EM6502AddressMode::Immediate,	// 000
+		EM6502AddressMode::ZP,			// 001
+		EM6502AddressMode::NA,			// 010 - missing
+		EM6502AddressMode::Absolute,	// 011
+		EM6502AddressMode::NA,			// 100 - missing
+		EM6502AddressMode::ZP_X,		// 101
+		EM6502AddressMode::NA,			// 110 - missing
+		EM6502AddressMode::Absolute_X,	// 111
+	};
+
+	constexpr EM6502AddressMode kGroup01_AddressModes[8] =
+	{
+		EM6502AddressMode::ZPIndirect_X,
+		EM6502AddressMode::ZP,
+		EM6502AddressMode::Immediate,
+		EM6502AddressMode::Absolute,
+		EM6502AddressMode::ZPIndirect_Y,
+		EM6502AddressMode::ZP_X,
+		EM6502AddressMode::Absolute_Y,
+		EM6502AddressMode::Absolute_X,
+	};
+
+	constexpr EM6502AddressMode kGroup10_AddressModes[8] =
+	{
+		EM6502AddressMode::Immediate,
+		EM6502AddressMode::ZP,
+		EM6502AddressMode::Accumulator,
+		EM6502AddressMode::Absolute,
+		EM6502AddressMode::NA,	// 100 - missing
+		EM6502AddressMode::ZP_X,
+		EM6502AddressMode::NA,	// 110 - missing
+		EM6502AddressMode::Absolute_X,
+	};
+
+	const uint8_t addrMode = (opcode >> 2) & 7;
+
+	switch (opcode & 3)
+	{
+	case 0x00:
+		return kGroup00_AddressModes[addrMode];
+	case 0x01:
+		return kGroup01_AddressModes[addrMode];
+	case 0x02:
+		return kGroup10_AddressModes[addrMode];
+	default:
+		return EM6502AddressMode::NA;
+	}
+}
+
+constexpr FM6502OpcodeTable MakeM6502OpcodeTable()
+{
+	FM6502OpcodeTable table = {};
+
+	for (int opcode = 0; opcode < 256; opcode++)
+		table[opcode].AddressMode = GetM6502GroupAddressMode((uint8_t)opcode);
+
+	// BPL, BMI, BVC, BVS, BCC, BCS, BNE, BEQ
+	for (int branch = 0; branch < 8; branch++)
+		table[0x10 | (branch << 5)].Flow = EM6502Flow::Branch;
+
+	table[0x4C].Flow = EM6502Flow::Jump;
+	table[0x6C].Flow = EM6502Flow::JumpIndirect;
+	table[0x20].Flow = EM6502Flow::Call;
+	table[0x40].Flow = EM6502Flow::Return;	// RTI
+	table[0x60].Flow = EM6502Flow::Return;	// RTS
+	table[0x00].Flow = EM6502Flow::Break;
+
+	for (FM6502OpcodeInfo& info : table)
+		info.bStopsAnalysis = info.Flow != EM6502Flow::None && info.Flow != EM6502Flow::Branch;
+
+	return table;
+}
+
+inline constexpr FM6502OpcodeTable g_M6502OpcodeTable = MakeM6502OpcodeTable();
+
+static_assert(g_M6502OpcodeTable[0xF0].Flow == EM6502Flow::Branch, "branch table error");
+static_assert(g_M6502OpcodeTable[0xB1].AddressMode == EM6502AddressMode::ZPIndirect_Y, "address mode table error");
+
+inline const FM6502OpcodeInfo& GetM6502OpcodeInfo(uint8_t opcode)
+{
+	return g_M6502OpcodeTable[opcode];
+}
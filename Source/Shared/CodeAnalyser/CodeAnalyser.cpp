@@ -5,12 +5,15 @@
 #include <cassert>
 #include <stdio.h>
 #include <string.h>
+#include <functional>
 
 #include <imgui.h>
 
 #include "Util/Misc.h"
+#include "Util/WorkerPool.h"
 #include "Util/GraphicsView.h"
 #include "UI/ImageViewer.h"
+#include "UI/CodeAnalyserUI.h"
 
 #include "Z80/CodeAnalyserZ80.h"
 #include "6502/CodeAnalyser6502.h"
@@ -43,9 +46,42 @@ int16_t	FCodeAnalysisState::CreateBank(const char* bankName, int noKb,uint8_t* p
 		sprintf(pageName, "%s:%d", bankName, pageNo);
 		RegisterPage(&newBank.Pages[pageNo], pageName);
 	}
+	UpdateBankPageTable(newBank);
 	return bankId;
 }
 
+// Rebuild a bank's entries in the flat page lookup used to resolve address refs
+// Only needs doing when the bank is created or its primary mapped page changes.
+void FCodeAnalysisState::UpdateBankPageTable(const FCodeAnalysisBank& bank)
+{
+	if (BankPageTable.size() < Banks.size() * kNoPagesInAddressSpace)
+		BankPageTable.resize(Banks.size() * kNoPagesInAddressSpace, nullptr);
+
+	FCodeAnalysisPage** pBankEntries = &BankPageTable[bank.Id * kNoPagesInAddressSpace];
+	for (int pageNo = 0; pageNo < kNoPagesInAddressSpace; pageNo++)
+	{
+		const int bankPageNo = pageNo - bank.PrimaryMappedPage;
+		const bool bInBank = bank.PrimaryMappedPage != -1 && bankPageNo >= 0 && bankPageNo < bank.NoPages;
+		pBankEntries[pageNo] = bInBank ? &bank.Pages[bankPageNo] : nullptr;
+	}
+}
+
+void FCodeAnalysisState::SetBankPrimaryMappedPage(int16_t bankId, int pageNo)
+{
+	FCodeAnalysisBank* pBank = GetBank(bankId);
+	if (pBank == nullptr)
+		return;
+
+	pBank->PrimaryMappedPage = pageNo;
+	UpdateBankPageTable(*pBank);
+}
+
+static uint64_t GetPageRangeBits(int startPageNo, int noPages)
+{
+	const uint64_t rangeBits = noPages >= 64 ? ~0ull : (1ull << noPages) - 1;
+	return rangeBits << startPageNo;
+}
+
 // Set bank to memory pages starting at pageNo
 bool FCodeAnalysisState::MapBank(int16_t bankId, int startPageNo)
 {
@@ -53,14 +89,19 @@ bool FCodeAnalysisState::MapBank(int16_t bankId, int startPageNo)
 	if (pBank == nullptr || MappedBanks[startPageNo] == bankId)	// not found or already mapped to this locatiom
 		return false;
 
+	FlushDataAccessLog();	// logged accesses belong to the old mapping
+
 	if (pBank->PrimaryMappedPage == -1 )	// Newly mapped?
 	{
 		pBank->PrimaryMappedPage = startPageNo;
+		UpdateBankPageTable(*pBank);
 		pBank->bIsDirty = true;
+		AddBankGlobalLabels(*pBank);
+		bCodeAnalysisDataDirty = true;	// item list needs building
 	}
 	assert(pBank->PrimaryMappedPage != -1);
 
-	pBank->MappedPages.push_back(startPageNo);
+	pBank->MappedPageBits |= 1ull << startPageNo;
 	for (int bankPageNo = 0; bankPageNo < pBank->NoPages; bankPageNo++)
 	{
 		//if(pBank->bReadOnly)
@@ -68,12 +109,16 @@ bool FCodeAnalysisState::MapBank(int16_t bankId, int startPageNo)
 		//else
 		SetCodeAnalysisRWPage(startPageNo + bankPageNo, &pBank->Pages[bankPageNo], &pBank->Pages[bankPageNo]);	// Read/Write
 
+		uint8_t* pPageMem = pBank->Memory != nullptr ? &pBank->Memory[bankPageNo * FCodeAnalysisPage::kPageSize] : nullptr;
+		SetPageMemory(startPageNo + bankPageNo, pPageMem, pBank->bReadOnly ? nullptr : pPageMem);
+
 		MappedBanks[startPageNo + bankPageNo] = bankId;
+		PageMappingGeneration[startPageNo + bankPageNo]++;	// references into the page need registering again
 	}
-	bMemoryRemapped = true;
 
-	//RemappedBanks.push_back(bankId);
-	bCodeAnalysisDataDirty = true;
+	// only the remapped pages of the item list need updating - see UpdateItemList()
+	RemappedPageBits |= GetPageRangeBits(startPageNo, pBank->NoPages);
+	bMemoryRemapped = true;
 
 	return true;
 }
@@ -84,32 +129,75 @@ bool FCodeAnalysisState::UnMapBank(int16_t bankId, int startPageNo)
 	if (pBank == nullptr || MappedBanks[startPageNo] != bankId)
 		return false;
 
+	FlushDataAccessLog();
+
 	for (int bankPage = 0; bankPage < pBank->NoPages; bankPage++)
+	{
 		MappedBanks[startPageNo + bankPage] = -1;
+		SetPageMemory(startPageNo + bankPage, nullptr, nullptr);
+		PageMappingGeneration[startPageNo + bankPage]++;
+	}
 
-	// erase from mapped pages - better way?
-	auto it = pBank->MappedPages.begin();
+	pBank->MappedPageBits &= ~(1ull << startPageNo);
+	RemappedPageBits |= GetPageRangeBits(startPageNo, pBank->NoPages);
+	bMemoryRemapped = true;
 
-	while (it != pBank->MappedPages.end())
+	return true;
+}
+
+void FCodeAnalysisState::InvalidateDecodedInstruction(uint16_t address)
+{
+	FCodeInfo* pCodeInfo = GetCodeInfoForAddress(address);
+	if (pCodeInfo == nullptr)
 	{
-		if (*it == startPageNo)
-			it = pBank->MappedPages.erase(it);
-		else
-			++it;
+		const FDataInfo* pDataInfo = GetReadDataInfoForAddress(address);
+		if (pDataInfo->DataType == EDataType::InstructionOperand)
+			pCodeInfo = GetCodeInfoForAddress(pDataInfo->InstructionAddress);
 	}
 
-	return true;
+	if (pCodeInfo != nullptr)
+		pCodeInfo->Decoded.bValid = false;
 }
 
 bool FCodeAnalysisState::IsBankIdMapped(int16_t bankId) const
 {
-	for (int bankIdx = 0; bankIdx < kNoPagesInAddressSpace; bankIdx++)
+	const FCodeAnalysisBank* pBank = GetBank(bankId);
+	return pBank != nullptr && pBank->IsMapped();
+}
+
+FLabelInfo* FCodeAnalysisState::FindLabelAtOrBeforeAddress(FAddressRef addrRef, uint16_t& outLabelAddress, uint32_t labelTypeMask) const
+{
+	const FCodeAnalysisBank* pBank = GetBank(addrRef.BankId);
+
+	for (int addrVal = addrRef.Address; addrVal >= 0;)
 	{
-		if (MappedBanks[bankIdx] == bankId)
-			return true;
+		// below the start of the bank - carry on in whatever is mapped there
+		if (pBank == nullptr || pBank->AddressValid(addrVal) == false)
+		{
+			pBank = GetBank(GetBankFromAddress(addrVal));
+			if (pBank == nullptr)
+				return nullptr;
+		}
+
+		const uint16_t bankAddr = addrVal - pBank->GetMappedAddress();
+		const FCodeAnalysisPage& page = pBank->Pages[bankAddr >> kPageShift];
+		const int pageStart = addrVal & ~kPageMask;
+
+		// step back through the labels in this page
+		for (int pageAddr = page.FindLabelAtOrBefore(addrVal & kPageMask); pageAddr != -1; pageAddr = pageAddr > 0 ? page.FindLabelAtOrBefore(pageAddr - 1) : -1)
+		{
+			FLabelInfo* pLabel = page.Labels[pageAddr];
+			if (labelTypeMask & (1 << (int)pLabel->LabelType))
+			{
+				outLabelAddress = pageStart + pageAddr;
+				return pLabel;
+			}
+		}
+
+		addrVal = pageStart - 1;
 	}
 
-	return false;
+	return nullptr;
 }
 
 bool FCodeAnalysisState::IsAddressValid(FAddressRef addr) const
@@ -124,8 +212,68 @@ bool FCodeAnalysisState::IsAddressValid(FAddressRef addr) const
 	return true;
 }
 
+void FItemList::UpdateSegmentStarts()
+{
+	NoItems = 0;
+	for (int segmentNo = 0; segmentNo < (int)Segments.size(); segmentNo++)
+	{
+		SegmentStarts[segmentNo] = NoItems;
+		NoItems += (int)Segments[segmentNo]->size();
+	}
+}
+
+// index in the bank's ItemList of the first item at or after the address, may be one past the end
+static int GetBankItemIndex(const FCodeAnalysisBank& bank, uint16_t addr)
+{
+	const uint16_t bankAddr = addr - bank.GetMappedAddress();
+	const int pageNo = bankAddr >> FCodeAnalysisPage::kPageShift;
+	if (pageNo >= (int)bank.ItemListSegments.size() || pageNo >= bank.ItemList.GetNoSegments())	// item list hasn't been built
+		return -1;
+
+	return bank.ItemList.GetSegmentStart(pageNo) + bank.ItemListSegments[pageNo].ItemIndexForAddress[bankAddr & FCodeAnalysisPage::kPageMask];
+}
+
+int FCodeAnalysisState::GetBankItemListIndex(FAddressRef addr) const
+{
+	const FCodeAnalysisBank* pBank = GetBank(addr.BankId);
+	if (pBank == nullptr || pBank->AddressValid(addr.Address) == false)
+		return -1;
+
+	const int index = GetBankItemIndex(*pBank, addr.Address);
+	return index < pBank->ItemList.size() ? index : -1;
+}
+
+int FCodeAnalysisState::GetItemListIndex(FAddressRef addr) const
+{
+	const FCodeAnalysisBank* pBank = GetBank(addr.BankId);
+
+	// bank isn't in the address space list - look in what's mapped there
+	if (pBank == nullptr || pBank->IsMapped() == false)
+	{
+		addr.BankId = GetBankFromAddress(addr.Address);
+		pBank = GetBank(addr.BankId);
+		if (pBank == nullptr || pBank->IsMapped() == false)
+			return -1;
+	}
+
+	if (pBank->AddressValid(addr.Address) == false)
+		return -1;
+
+	const uint16_t bankAddr = addr.Address - pBank->GetMappedAddress();
+	const int pageNo = bankAddr >> FCodeAnalysisPage::kPageShift;
+	const int segmentNo = pBank->GetFirstMappedPage() + pageNo;	// the list has a segment per address space page
+	if (pageNo >= (int)pBank->ItemListSegments.size() || segmentNo >= ItemList.GetNoSegments())
+		return -1;
+
+	// past the page's last item is the start of the next segment in the list
+	const int index = ItemList.GetSegmentStart(segmentNo) + pBank->ItemListSegments[pageNo].ItemIndexForAddress[bankAddr & FCodeAnalysisPage::kPageMask];
+	return index < ItemList.size() ? index : -1;
+}
+
 bool FCodeAnalysisState::MapBankForAnalysis(FCodeAnalysisBank& bank)
 {
+	FlushDataAccessLog();
+
 	for (int i = 0; i < kNoPagesInAddressSpace; i++)
 	{
 #ifdef _DEBUG
@@ -133,14 +281,17 @@ bool FCodeAnalysisState::MapBankForAnalysis(FCodeAnalysisBank& bank)
 		assert(pMappedBank->PrimaryMappedPage != -1);
 #endif
 		MappedBanksBackup[i] = MappedBanks[i];
+		MappedMemBackup[i] = MappedMem[i];
+		MappedWriteMemBackup[i] = MappedWriteMem[i];
 	}
 
 	const int startPageNo = bank.PrimaryMappedPage;
 	assert(startPageNo != -1);
 	for (int bankPageNo = 0; bankPageNo < bank.NoPages; bankPageNo++)
 	{
+		uint8_t* pPageMem = &bank.Memory[bankPageNo * FCodeAnalysisPage::kPageSize];
 		MappedBanks[startPageNo + bankPageNo] = bank.Id;
-		MappedMem[startPageNo + bankPageNo] = &bank.Memory[bankPageNo * FCodeAnalysisPage::kPageSize];
+		SetPageMemory(startPageNo + bankPageNo, pPageMem, pPageMem);
 		SetCodeAnalysisRWPage(startPageNo + bankPageNo, &bank.Pages[bankPageNo], &bank.Pages[bankPageNo]);	// Read/Write
 	}
 
@@ -151,14 +302,15 @@ void FCodeAnalysisState::UnMapAnalysisBanks()
 {
 	for (int i = 0; i < kNoPagesInAddressSpace; i++)
 	{
+		const bool bRemapped = MappedBanks[i] != MappedBanksBackup[i];
 		MappedBanks[i] = MappedBanksBackup[i];
+		SetPageMemory(i, MappedMemBackup[i], MappedWriteMemBackup[i]);
 		const FCodeAnalysisBank* pMappedBank = GetBank(MappedBanks[i]);
 		assert(pMappedBank->PrimaryMappedPage != -1);
-		if (MappedMem[i] != nullptr)
+		if (bRemapped)
 		{
 			const int mappedPage = i - pMappedBank->PrimaryMappedPage;
 			SetCodeAnalysisRWPage(i, &pMappedBank->Pages[mappedPage], &pMappedBank->Pages[mappedPage]);	// Read/Write
-			MappedMem[i] = nullptr;
 		}
 	}
 }
@@ -391,7 +543,7 @@ FLabelInfo* GenerateLabelForAddress(FCodeAnalysisState &state, FAddressRef addre
 	if (pLabel != nullptr)
 		return nullptr;
 		
-	pLabel = FLabelInfo::Allocate();
+	pLabel = FLabelInfo::Allocate(state);
 	pLabel->LabelType = labelType;
 	//pLabel->Address = address;
 	pLabel->ByteSize = 0;
@@ -430,8 +582,6 @@ FLabelInfo* GenerateLabelForAddress(FCodeAnalysisState &state, FAddressRef addre
 	}
 
 	pLabel->Name = label;
-	if (pLabel->Global)
-		GenerateGlobalInfo(state);
 	state.SetLabelForAddress(address, pLabel);
 	return pLabel;	
 }
@@ -443,22 +593,45 @@ void UpdateCodeInfoForAddress(FCodeAnalysisState &state, uint16_t pc)
 		return;
 
 	pCodeInfo->bIsCall = CheckCallInstruction(state, pc);
+	// disassembly text is picked up by GetDisassemblyText() as its key includes the operand type & opcode bytes
+}
+
+// Disassembly text is generated when it's needed rather than stored in the code info
+// Assumes the address passed in is mapped to physical memory
+const std::string& GetDisassemblyText(FCodeAnalysisState& state, uint16_t pc, const FCodeInfo* pCodeInfo)
+{
+	uint8_t opcodeBytes[4];
+	const int noBytes = std::min((int)pCodeInfo->ByteSize, (int)sizeof(opcodeBytes));
+	for (int i = 0; i < noBytes; i++)
+		opcodeBytes[i] = state.ReadByte(pc + i);
+
+	const uint64_t key = FDisassemblyCache::MakeKey(pc, opcodeBytes, noBytes, pCodeInfo->OperandType, GetNumberDisplayMode());
+	const std::string* pCachedText = state.DisassemblyCache.Find(key);
+	if (pCachedText != nullptr)
+		return *pCachedText;
 
+	std::string text;
 	if (state.CPUInterface->CPUType == ECPUType::Z80)
-		Z80DisassembleCodeInfoItem(pc, state, pCodeInfo);
+		Z80DisassembleCodeInfoItem(pc, state, pCodeInfo, text);
 	else if (state.CPUInterface->CPUType == ECPUType::M6502)
-		M6502DisassembleCodeInfoItem(pc, state, pCodeInfo);
+		M6502DisassembleCodeInfoItem(pc, state, pCodeInfo, text);
+
+	return state.DisassemblyCache.Add(key, std::move(text));
 }
 
 // This assumes that the address passed in is mapped to physical memory
 uint16_t WriteCodeInfoForAddress(FCodeAnalysisState &state, uint16_t pc)
 {
+	// data reads & SMC checks depend on code info so register pending accesses against the current code
+	state.FlushDataAccessLog();
+
 	FCodeInfo* pCodeInfo = state.GetCodeInfoForAddress(pc);
 	if (pCodeInfo == nullptr)
 	{
-		pCodeInfo = FCodeInfo::Allocate();
+		pCodeInfo = FCodeInfo::Allocate(state);
 		state.SetCodeInfoForAddress(pc, pCodeInfo);
 	}	
+	pCodeInfo->Decoded.bValid = false;	// instruction may have changed
 
 	// does this function branch?
 	uint16_t jumpAddr;
@@ -497,13 +670,14 @@ uint16_t WriteCodeInfoForAddress(FCodeAnalysisState &state, uint16_t pc)
 		}
 	}
 
-	// generate disassembly
+	// get instruction size - the text is generated when it's drawn or exported, see GetDisassemblyText()
 	uint16_t newPC = pc;
+	uint8_t opcode = 0;
 
 	if (state.CPUInterface->CPUType == ECPUType::Z80)
-		newPC = Z80DisassembleCodeInfoItem(pc,state,pCodeInfo);
+		newPC = Z80DisassembleGetNextPC(pc, state, opcode);
 	else if (state.CPUInterface->CPUType == ECPUType::M6502)
-		newPC = M6502DisassembleCodeInfoItem(pc, state, pCodeInfo);
+		newPC = M6502DisassembleGetNextPC(pc, state, opcode);
 
 	state.SetCodeInfoForAddress(pc, pCodeInfo);	
 
@@ -516,53 +690,73 @@ uint16_t WriteCodeInfoForAddress(FCodeAnalysisState &state, uint16_t pc)
 		pOperandData->InstructionAddress = state.AddressRefFromPhysicalAddress(pc);
 	}
 	pCodeInfo->ByteSize = newPC - pc;
+	state.UpdateCodeBitsForAddressRange(pc, pCodeInfo->ByteSize);
 
 	return newPC;
 }
 
-// return if we should continue
-bool AnalyseAtPC(FCodeAnalysisState &state, uint16_t& pc)
+static void DecodeInstruction(FCodeAnalysisState& state, uint16_t pc, FDecodedInstruction& decoded)
 {
-	FCodeInfo* pCodeInfo = state.GetCodeInfoForAddress(pc);
+	decoded = FDecodedInstruction();
+	decoded.bJump = CheckJumpInstruction(state, pc, &decoded.JumpAddress);
+	decoded.bPointer = CheckPointerRefInstruction(state, pc, &decoded.PointerAddress);
+	decoded.bValid = true;
+}
 
-	// Register Code accesses
-	// 
+// Register Code accesses
+static void RegisterInstructionReferences(FCodeAnalysisState& state, uint16_t pc, const FDecodedInstruction& decoded, FCodeInfo* pCodeInfo)
+{
 	// set jump reference
-	uint16_t jumpAddr;
-	if (CheckJumpInstruction(state, pc, &jumpAddr))
+	if (decoded.bJump)
 	{
-		FLabelInfo* pLabel = state.GetLabelForPhysicalAddress(jumpAddr);
+		FLabelInfo* pLabel = state.GetLabelForPhysicalAddress(decoded.JumpAddress);
 		if (pLabel != nullptr)
 			pLabel->References.RegisterAccess(state.AddressRefFromPhysicalAddress(pc));
 		if (pCodeInfo != nullptr)
 		{
-			pCodeInfo->JumpAddress = state.AddressRefFromPhysicalAddress(jumpAddr);
+			pCodeInfo->JumpAddress = state.AddressRefFromPhysicalAddress(decoded.JumpAddress);
 			assert(state.IsAddressValid(pCodeInfo->JumpAddress));
 		}
-
 	}
 
 	// set pointer reference
-	uint16_t ptr;
-	if (CheckPointerRefInstruction(state, pc, &ptr))
+	if (decoded.bPointer)
 	{
-		FLabelInfo* pLabel = state.GetLabelForPhysicalAddress(ptr);
+		FLabelInfo* pLabel = state.GetLabelForPhysicalAddress(decoded.PointerAddress);
 		if (pLabel != nullptr)
 			pLabel->References.RegisterAccess(state.AddressRefFromPhysicalAddress(pc));
 		if (pCodeInfo != nullptr)
-			pCodeInfo->PointerAddress = state.AddressRefFromPhysicalAddress(ptr);
+			pCodeInfo->PointerAddress = state.AddressRefFromPhysicalAddress(decoded.PointerAddress);
 	}
+}
+
+// return if we should continue
+bool AnalyseAtPC(FCodeAnalysisState &state, uint16_t& pc)
+{
+	FCodeInfo* pCodeInfo = state.GetCodeInfoForAddress(pc);
 
 	const char* pOldComment = nullptr;
 	if (pCodeInfo != nullptr)
 	{
+		// the instruction is only decoded again if it's been written to
+		FDecodedInstruction& decoded = pCodeInfo->Decoded;
+		if (decoded.bValid == false)
+			DecodeInstruction(state, pc, decoded);
+
+		// references only need registering again if labels, references or the banks mapped where they point have changed since
+		const uint32_t referenceGeneration = state.GetReferenceGeneration(decoded);
+		if (decoded.ReferenceGeneration != referenceGeneration)
+		{
+			RegisterInstructionReferences(state, pc, decoded, pCodeInfo);
+			decoded.ReferenceGeneration = referenceGeneration;
+		}
+
 		if(pCodeInfo->bSelfModifyingCode)	// check SMC
 		{
 			pCodeInfo->bSelfModifyingCode = false;
 			for(uint16_t operandAddr = 0;operandAddr<pCodeInfo->ByteSize;operandAddr++)
 			{
-				FDataInfo* pOpDataInfo = state.GetReadDataInfoForAddress(pc + operandAddr);
-				if(pOpDataInfo->Writes.IsEmpty() == false)
+				if(state.GetDataWritesForAddress((uint16_t)(pc + operandAddr)).IsEmpty() == false)
 				{
 					pCodeInfo->bSelfModifyingCode = true;
 				}					
@@ -571,6 +765,10 @@ bool AnalyseAtPC(FCodeAnalysisState &state, uint16_t& pc)
 		return false;
 	}
 
+	FDecodedInstruction decoded;
+	DecodeInstruction(state, pc, decoded);
+	RegisterInstructionReferences(state, pc, decoded, nullptr);
+
 	const uint16_t newPC = WriteCodeInfoForAddress(state, pc);
 
 	// get new code info
@@ -602,7 +800,7 @@ bool RegisterCodeExecuted(FCodeAnalysisState &state, uint16_t pc, uint16_t oldpc
 	FCodeInfo* pCodeInfo = state.GetCodeInfoForAddress(pc);
 	if (pCodeInfo != nullptr)
 	{
-		pCodeInfo->FrameLastExecuted = state.CurrentFrameNo;
+		state.GetReadPage(pc)->LastFrameExecuted[pc & FCodeAnalysisPage::kPageMask] = state.CurrentFrameNo;
 		pCodeInfo->ExecutionCount++;
 	}
 
@@ -625,110 +823,288 @@ void RegisterDataRead(FCodeAnalysisState& state, uint16_t pc, uint16_t dataAddr)
 {
 	if (dataAddr == g_DbgReadAddress)
 	{
-		LOGINFO("Access 0x%04X at PC:", g_DbgReadAddress, pc);
+		LOGINFO("Access 0x%04X at PC: 0x%04X", g_DbgReadAddress, pc);
 	}
 
 	if (state.GetCodeInfoForAddress(dataAddr) == nullptr)	// don't register instruction data reads
 	{
-		FDataInfo* pDataInfo = state.GetReadDataInfoForAddress(dataAddr);
-		pDataInfo->ReadCount++;
-		pDataInfo->LastFrameRead = state.CurrentFrameNo;
-		pDataInfo->Reads.RegisterAccess(state.AddressRefFromPhysicalAddress(pc));
+		FCodeAnalysisPage* pPage = state.GetReadPage(dataAddr);
+		const uint16_t pageAddr = dataAddr & FCodeAnalysisPage::kPageMask;
+		pPage->ReadCount[pageAddr]++;
+		pPage->LastFrameRead[pageAddr] = state.CurrentFrameNo;
+		pPage->GetOrCreateDataReads(pageAddr).RegisterAccess(state.AddressRefFromPhysicalAddress(pc));
 	}
 }
 
 void RegisterDataWrite(FCodeAnalysisState &state, uint16_t pc,uint16_t dataAddr,uint8_t value)
 {
-	FDataInfo* pDataInfo = state.GetWriteDataInfoForAddress(dataAddr);
-	pDataInfo->WriteCount++;
-	pDataInfo->LastFrameWritten = state.CurrentFrameNo;
-	pDataInfo->Writes.RegisterAccess(state.AddressRefFromPhysicalAddress(pc));
-
-	// check for SMC
-	if (pDataInfo->DataType == EDataType::InstructionOperand)
+	FCodeAnalysisPage* pPage = state.GetWritePage(dataAddr);
+	const uint16_t pageAddr = dataAddr & FCodeAnalysisPage::kPageMask;
+	pPage->WriteCount[pageAddr]++;
+	pPage->LastFrameWritten[pageAddr] = state.CurrentFrameNo;
+	pPage->GetOrCreateDataWrites(pageAddr).RegisterAccess(state.AddressRefFromPhysicalAddress(pc));
+
+	// check for SMC - most writes are to data so the code bit filters them out
+	if (pPage->IsCode(pageAddr) && pPage->DataInfo[pageAddr].DataType == EDataType::InstructionOperand)
 	{
 		// TODO: record some info such as what byte was written
-		FCodeInfo* pCodeWrittenTo = state.GetCodeInfoForAddress(pDataInfo->InstructionAddress);
+		FCodeInfo* pCodeWrittenTo = state.GetCodeInfoForAddress(pPage->DataInfo[pageAddr].InstructionAddress);
 		if (pCodeWrittenTo != nullptr)	// sometime data can be malformed so do a defensive check
+		{
 			pCodeWrittenTo->bSelfModifyingCode = true;
+			pCodeWrittenTo->Decoded.bValid = false;
+		}
 	}
 }
 
-void ReAnalyseCode(FCodeAnalysisState &state)
+// Register all the logged data accesses
+// Records are sorted by address so each data info is fetched once & the pages are walked in order.
+// The sort is stable & only on address so accesses to an address keep their order - reads & writes are registered
+// in the order they happened, in runs of the same access type.
+void FCodeAnalysisState::FlushDataAccessLog()
 {
-	int addr = 0;
-	while ( addr < (1 << 16))
+	if (NoLoggedDataAccesses == 0)
+		return;
+
+	FDataAccessRecord* pLog = DataAccessLog.data();
+	const int noRecords = NoLoggedDataAccesses;
+	NoLoggedDataAccesses = 0;
+
+	std::stable_sort(pLog, pLog + noRecords, [](const FDataAccessRecord& a, const FDataAccessRecord& b)
 	{
-		FCodeInfo* pCodeInfo = state.GetCodeInfoForAddress(addr);
-		if (pCodeInfo != nullptr)
-		{
-			pCodeInfo->bSelfModifyingCode = false;
+		return a.Address < b.Address;
+	});
+
+	int recordNo = 0;
+	while (recordNo < noRecords)
+	{
+		const uint16_t dataAddr = pLog[recordNo].Address;
+		const uint16_t pageAddr = dataAddr & FCodeAnalysisPage::kPageMask;
+		const bool bWrite = pLog[recordNo].bWrite;
+
+		// find run of consecutive accesses of the same type to this address
+		int runEnd = recordNo + 1;
+		while (runEnd < noRecords && pLog[runEnd].Address == dataAddr && pLog[runEnd].bWrite == bWrite)
+			runEnd++;
 
-			for (int i = 0; i < pCodeInfo->ByteSize; i++)
+		if (bWrite)
+		{
+			FCodeAnalysisPage* pPage = GetWritePage(dataAddr);
+			FItemReferenceTracker& writes = pPage->GetOrCreateDataWrites(pageAddr);
+			FAddressRef pcRef;
+			for (int i = recordNo; i < runEnd; i++)
 			{
-				FDataInfo* pOperandData = state.GetReadDataInfoForAddress(addr + i);
-				pOperandData->ByteSize = 1;
-				pOperandData->DataType = EDataType::InstructionOperand;
-				pOperandData->InstructionAddress = state.AddressRefFromPhysicalAddress(addr);
-				if (pOperandData->Writes.IsEmpty() == false)
-					pCodeInfo->bSelfModifyingCode = true;
-				if (i > 0)	// make sure other entries after are null
-					state.SetCodeInfoForAddress(addr + i, nullptr);
+				if (i == recordNo || pLog[i].PC != pLog[i - 1].PC)	// repeated writes from the same instruction are already registered
+				{
+					pcRef = AddressRefFromPhysicalAddress(pLog[i].PC);
+					writes.RegisterAccess(pcRef);
+				}
 			}
+			pPage->WriteCount[pageAddr] += runEnd - recordNo;
+			pPage->LastFrameWritten[pageAddr] = CurrentFrameNo;
+			pPage->LastWriter[pageAddr] = pcRef;
 
-			if (pCodeInfo->ByteSize == 0)
+			// check for SMC
+			if (pPage->IsCode(pageAddr) && pPage->DataInfo[pageAddr].DataType == EDataType::InstructionOperand)
 			{
-				state.SetCodeInfoForAddress(addr, nullptr);
-				addr++;
+				FCodeInfo* pCodeWrittenTo = GetCodeInfoForAddress(pPage->DataInfo[pageAddr].InstructionAddress);
+				if (pCodeWrittenTo != nullptr)	// sometime data can be malformed so do a defensive check
+				{
+					pCodeWrittenTo->bSelfModifyingCode = true;
+					pCodeWrittenTo->Decoded.bValid = false;
+				}
 			}
-			else
-				addr += pCodeInfo->ByteSize;
 		}
-		else
+		else if (GetCodeInfoForAddress(dataAddr) == nullptr)	// don't register instruction data reads
 		{
-			FDataInfo* pDataInfo = state.GetReadDataInfoForAddress(addr);
-			addr++;
+			if (dataAddr == g_DbgReadAddress)
+			{
+				LOGINFO("Access 0x%04X at PC: 0x%04X", g_DbgReadAddress, pLog[recordNo].PC);
+			}
+
+			FCodeAnalysisPage* pPage = GetReadPage(dataAddr);
+			FItemReferenceTracker& reads = pPage->GetOrCreateDataReads(pageAddr);
+			for (int i = recordNo; i < runEnd; i++)
+			{
+				if (i == recordNo || pLog[i].PC != pLog[i - 1].PC)
+					reads.RegisterAccess(AddressRefFromPhysicalAddress(pLog[i].PC));
+			}
+			pPage->ReadCount[pageAddr] += runEnd - recordNo;
+			pPage->LastFrameRead[pageAddr] = CurrentFrameNo;
 		}
+
+		recordNo = runEnd;
 	}
 }
 
-// Do we want to do this with every page?
-void ResetReferenceInfo(FCodeAnalysisState &state)
+// Pages of the address space are processed in parallel when no two of them share an analysis page,
+// otherwise workers could write to the same items & the result would depend on the order they ran in.
+// Without pool workers (single core) the pages are just run in turn on this thread.
+static bool CanProcessPagesInParallel(const FCodeAnalysisState& state)
 {
-	for (int i = 0; i < (1 << 16); i++)
+	if (state.bAllowParallelAnalysis == false)
+		return false;
+
+	std::vector<const FCodeAnalysisPage*> pages;
+	for (int pageNo = 0; pageNo < FCodeAnalysisState::kNoPagesInAddressSpace; pageNo++)
 	{
-		FDataInfo* pDataInfo = state.GetReadDataInfoForAddress(i);
-		if (pDataInfo != nullptr)
-		{
-			pDataInfo->LastFrameRead = -1;
-			pDataInfo->Reads.Reset();
-			pDataInfo->LastFrameWritten = -1;
-			pDataInfo->Writes.Reset();
-		}
+		const uint16_t pageAddr = pageNo * FCodeAnalysisPage::kPageSize;
+		const FCodeAnalysisPage* pReadPage = state.GetReadPage(pageAddr);
+		const FCodeAnalysisPage* pWritePage = state.GetWritePage(pageAddr);
+		if (pReadPage == nullptr || pWritePage == nullptr)
+			return false;
+
+		pages.push_back(pReadPage);
+		if (pWritePage != pReadPage)
+			pages.push_back(pWritePage);
+	}
+
+	std::sort(pages.begin(), pages.end());
+	return std::adjacent_find(pages.begin(), pages.end()) == pages.end();
+}
+
+// Run a job for each address space page across the worker pool
+static void ProcessPagesInParallel(const std::function<void(int pageNo)>& pageJob)
+{
+	FWorkerPool::Get().ParallelFor(FCodeAnalysisState::kNoPagesInAddressSpace, pageJob);
+}
+
+// Re-analyse the instruction starting at an address, returns the address of the next one
+static int ReAnalyseInstruction(FCodeAnalysisState& state, int addr)
+{
+	FCodeInfo* pCodeInfo = state.GetCodeInfoForAddress(addr);
+	if (pCodeInfo == nullptr)
+		return addr + 1;
+
+	pCodeInfo->bSelfModifyingCode = false;
 
-		FLabelInfo* pLabelInfo = state.GetLabelForPhysicalAddress(i);
-		if (pLabelInfo != nullptr)
+	for (int i = 0; i < pCodeInfo->ByteSize; i++)
+	{
+		FDataInfo* pOperandData = state.GetReadDataInfoForAddress(addr + i);
+		pOperandData->ByteSize = 1;
+		pOperandData->DataType = EDataType::InstructionOperand;
+		pOperandData->InstructionAddress = state.AddressRefFromPhysicalAddress(addr);
+		if (state.GetDataWritesForAddress((uint16_t)(addr + i)).IsEmpty() == false)
+			pCodeInfo->bSelfModifyingCode = true;
+		if (i > 0)	// make sure other entries after are null
+			state.SetCodeInfoForAddress(addr + i, nullptr);
+	}
+
+	if (pCodeInfo->ByteSize == 0)
+	{
+		state.SetCodeInfoForAddress(addr, nullptr);
+		return addr + 1;
+	}
+
+	return addr + pCodeInfo->ByteSize;
+}
+
+void ReAnalyseCode(FCodeAnalysisState &state)
+{
+	if (CanProcessPagesInParallel(state) == false)
+	{
+		int addr = 0;
+		while (addr < (1 << 16))
+			addr = ReAnalyseInstruction(state, addr);
+
+		for (int pageNo = 0; pageNo < FCodeAnalysisState::kNoPagesInAddressSpace; pageNo++)
+			state.GetReadPage(pageNo * FCodeAnalysisPage::kPageSize)->RebuildCodeBits();
+		return;
+	}
+
+	// Find where the first instruction of each page starts - instructions can overrun from the previous page.
+	// Re-analysing only clears code info inside instructions, which the walk steps over, so this matches what the serial walk would do.
+	int pageStartAddr[FCodeAnalysisState::kNoPagesInAddressSpace + 1];
+	int addr = 0;
+	int lastInstructionAddr = 0;
+	for (int pageNo = 0; pageNo < FCodeAnalysisState::kNoPagesInAddressSpace; pageNo++)
+	{
+		pageStartAddr[pageNo] = addr;
+		const int pageEndAddr = (pageNo + 1) * FCodeAnalysisPage::kPageSize;
+		while (addr < pageEndAddr)
 		{
-			pLabelInfo->References.Reset();
+			const FCodeInfo* pCodeInfo = state.GetCodeInfoForAddress(addr);
+			lastInstructionAddr = addr;
+			addr += (pCodeInfo != nullptr && pCodeInfo->ByteSize > 0) ? pCodeInfo->ByteSize : 1;
 		}
+	}
 
-		state.SetLastWriterForAddress(i,  FAddressRef());
+	// an instruction wrapping round to the start of memory is done last, as it is in the serial walk
+	const bool bLastInstructionWraps = addr > (1 << 16);
+	pageStartAddr[FCodeAnalysisState::kNoPagesInAddressSpace] = bLastInstructionWraps ? lastInstructionAddr : addr;
+
+	// each byte is only touched by the instruction covering it so pages can't interfere with each other
+	ProcessPagesInParallel([&state, &pageStartAddr](int pageNo)
+	{
+		for (int addr = pageStartAddr[pageNo]; addr < pageStartAddr[pageNo + 1];)
+			addr = ReAnalyseInstruction(state, addr);
+	});
+
+	if (bLastInstructionWraps)
+		ReAnalyseInstruction(state, lastInstructionAddr);
+
+	// done once all the pages are re-analysed as instructions can write operand info into the next page
+	ProcessPagesInParallel([&state](int pageNo)
+	{
+		state.GetReadPage(pageNo * FCodeAnalysisPage::kPageSize)->RebuildCodeBits();
+	});
+}
+
+static void ResetReferenceInfoForAddress(FCodeAnalysisState& state, uint16_t addr)
+{
+	FCodeAnalysisPage* pPage = state.GetReadPage(addr);
+	if (pPage != nullptr)
+	{
+		const uint16_t pageAddr = addr & FCodeAnalysisPage::kPageMask;
+		pPage->LastFrameRead[pageAddr] = -1;
+		pPage->LastFrameWritten[pageAddr] = -1;
+		pPage->ResetDataReferences(pageAddr);
+	}
+
+	FLabelInfo* pLabelInfo = state.GetLabelForPhysicalAddress(addr);
+	if (pLabelInfo != nullptr)
+	{
+		pLabelInfo->References.Reset();
+	}
+
+	state.SetLastWriterForAddress(addr, FAddressRef());
+}
+
+// Do we want to do this with every page?
+void ResetReferenceInfo(FCodeAnalysisState &state)
+{
+	state.InvalidateInstructionReferences();	// so executed code registers its references again
+
+	if (CanProcessPagesInParallel(state) == false)
+	{
+		for (int i = 0; i < (1 << 16); i++)
+			ResetReferenceInfoForAddress(state, i);
+		return;
 	}
+
+	ProcessPagesInParallel([&state](int pageNo)
+	{
+		const int pageStartAddr = pageNo * FCodeAnalysisPage::kPageSize;
+		for (int i = pageStartAddr; i < pageStartAddr + FCodeAnalysisPage::kPageSize; i++)
+			ResetReferenceInfoForAddress(state, i);
+	});
 }
 
 // TODO: Phase this out
 FLabelInfo* AddLabel(FCodeAnalysisState &state, uint16_t address,const char *name,ELabelType type)
 {
-	FLabelInfo *pLabel = FLabelInfo::Allocate();
+	return AddLabel(state, address, name, type, type == ELabelType::Function);
+}
+
+FLabelInfo* AddLabel(FCodeAnalysisState& state, uint16_t address, const char* name, ELabelType type, bool bGlobal)
+{
+	FLabelInfo *pLabel = FLabelInfo::Allocate(state);
 	pLabel->Name = name;
 	pLabel->LabelType = type;
 	//pLabel->Address = address;
 	pLabel->ByteSize = 1;
-	pLabel->Global = type == ELabelType::Function;
-	state.SetLabelForPhysicalAddress(address, pLabel);
-
-	if (pLabel->Global)
-		GenerateGlobalInfo(state);
+	pLabel->Global = bGlobal;
+	state.SetLabelForPhysicalAddress(address, pLabel);	// updates the global labels
 
 	return pLabel;
 }
@@ -738,7 +1114,7 @@ FCommentBlock* AddCommentBlock(FCodeAnalysisState& state, FAddressRef addressRef
 	FCommentBlock* pExistingBlock = state.GetCommentBlockForAddress(addressRef);
 	if(pExistingBlock == nullptr)
 	{
-		FCommentBlock* pCommentBlock = FCommentBlock::Allocate();
+		FCommentBlock* pCommentBlock = FCommentBlock::Allocate(state);
 		pCommentBlock->Comment = "";
 		pCommentBlock->ByteSize = 1;
 		state.SetCommentBlockForAddress(addressRef, pCommentBlock);
@@ -749,14 +1125,137 @@ FCommentBlock* AddCommentBlock(FCodeAnalysisState& state, FAddressRef addressRef
 	return pExistingBlock;
 }
 
-// Generate Global Info for items in address space
+static bool IsGlobalDataLabel(const FLabelInfo* pLabel) { return pLabel->LabelType == ELabelType::Data && pLabel->Global; }
+static bool IsGlobalFunctionLabel(const FLabelInfo* pLabel) { return pLabel->LabelType == ELabelType::Function; }
+
+void FCodeAnalysisState::SetLabelGlobal(FAddressRef addrRef, bool bGlobal)
+{
+	FLabelInfo* pLabel = GetLabelForAddress(addrRef);
+	if (pLabel == nullptr)
+		return;
+
+	pLabel->Global = bGlobal;
+	UpdateGlobalLabel(addrRef);
+}
+
+// Keep the global label maps in step with the label at an address
+void FCodeAnalysisState::UpdateGlobalLabel(FAddressRef addrRef)
+{
+	const FCodeAnalysisBank* pBank = GetBank(addrRef.BankId);
+	if (pBank == nullptr || pBank->PrimaryMappedPage == -1)
+		return;
+
+	UpdateGlobalLabelInBank(*pBank, addrRef.Address - pBank->GetMappedAddress());
+}
+
+// For code that sets labels through the page - finds the bank the page belongs to
+void FCodeAnalysisState::UpdateGlobalLabelForPage(const FCodeAnalysisPage* pPage, uint16_t pageAddr)
+{
+	for (const FCodeAnalysisBank& bank : Banks)
+	{
+		if (pPage >= bank.Pages && pPage < bank.Pages + bank.NoPages)
+		{
+			if (bank.PrimaryMappedPage != -1)	// labels in unmapped banks are added when the bank is mapped
+				UpdateGlobalLabelInBank(bank, (uint16_t)((pPage - bank.Pages) * FCodeAnalysisPage::kPageSize + pageAddr));
+			return;
+		}
+	}
+}
+
+void FCodeAnalysisState::UpdateGlobalLabelInBank(const FCodeAnalysisBank& bank, uint16_t bankAddr)
+{
+	const uint32_t key = GetGlobalLabelKey(bank.Id, bankAddr);
+	FLabelInfo* pLabel = bank.Pages[bankAddr >> FCodeAnalysisPage::kPageShift].Labels[bankAddr & FCodeAnalysisPage::kPageMask];
+
+	bGlobalInfoDirty |= GlobalDataLabels.erase(key) != 0;
+	bGlobalInfoDirty |= GlobalFunctionLabels.erase(key) != 0;
+
+	if (pLabel != nullptr)
+	{
+		if (IsGlobalDataLabel(pLabel))
+		{
+			GlobalDataLabels[key] = pLabel;
+			bGlobalInfoDirty = true;
+		}
+		if (IsGlobalFunctionLabel(pLabel))
+		{
+			GlobalFunctionLabels[key] = pLabel;
+			bGlobalInfoDirty = true;
+		}
+	}
+}
+
+// Add global labels for a bank which has just been mapped in
+void FCodeAnalysisState::AddBankGlobalLabels(const FCodeAnalysisBank& bank)
+{
+	for (int pageNo = 0; pageNo < bank.NoPages; pageNo++)
+	{
+		const FCodeAnalysisPage& page = bank.Pages[pageNo];
+
+		for (int pageAddr = page.FindLabelAtOrBefore(FCodeAnalysisPage::kPageMask); pageAddr != -1; pageAddr = pageAddr > 0 ? page.FindLabelAtOrBefore(pageAddr - 1) : -1)
+		{
+			FLabelInfo* pLabel = page.Labels[pageAddr];
+			const uint32_t key = GetGlobalLabelKey(bank.Id, (pageNo * FCodeAnalysisPage::kPageSize) + pageAddr);
+			if (IsGlobalDataLabel(pLabel))
+				GlobalDataLabels[key] = pLabel;
+			if (IsGlobalFunctionLabel(pLabel))
+				GlobalFunctionLabels[key] = pLabel;
+		}
+	}
+
+	bGlobalInfoDirty = true;
+}
+
+// Rebuild global info for items in address space from scratch
 void GenerateGlobalInfo(FCodeAnalysisState &state)
 {
-	state.GlobalDataItems.clear();
-	state.GlobalFunctions.clear();
+	state.GlobalDataLabels.clear();
+	state.GlobalFunctionLabels.clear();
 
-	// Make global list from what's in all banks
-	for (auto& bank : state.GetBanks())
+	for (const auto& bank : state.GetBanks())
+	{
+		if (bank.PrimaryMappedPage != -1)
+			state.AddBankGlobalLabels(bank);
+	}
+
+	state.bGlobalInfoDirty = true;
+}
+
+static void GenerateGlobalItems(const FCodeAnalysisState& state, const std::map<uint32_t, FLabelInfo*>& labels, std::vector<FCodeAnalysisItem>& items)
+{
+	items.clear();
+	items.reserve(labels.size());
+
+	for (const auto& labelIt : labels)
+	{
+		const int16_t bankId = (int16_t)(labelIt.first >> 16);
+		const uint16_t bankAddr = labelIt.first & 0xffff;
+		items.emplace_back(labelIt.second, FAddressRef(bankId, state.GetBank(bankId)->GetMappedAddress() + bankAddr));
+	}
+}
+
+// Regenerate the global item lists if the labels in them have changed
+void UpdateGlobalInfo(FCodeAnalysisState& state)
+{
+	if (state.bGlobalInfoDirty == false)
+		return;
+
+	GenerateGlobalItems(state, state.GlobalDataLabels, state.GlobalDataItems);
+	GenerateGlobalItems(state, state.GlobalFunctionLabels, state.GlobalFunctions);
+
+	state.bGlobalInfoDirty = false;
+	state.bRebuildFilteredGlobalDataItems = true;
+	state.bRebuildFilteredGlobalFunctions = true;
+}
+
+// Check that the incrementally maintained global labels match a full scan of the mapped banks
+// This scans the whole address space so it's for tests, not every update
+bool CheckGlobalInfo(const FCodeAnalysisState& state)
+{
+	size_t noDataLabels = 0;
+	size_t noFunctionLabels = 0;
+
+	for (const auto& bank : state.GetBanks())
 	{
 		if (bank.PrimaryMappedPage == -1)
 			continue;
@@ -764,41 +1263,33 @@ void GenerateGlobalInfo(FCodeAnalysisState &state)
 		for (int pageNo = 0; pageNo < bank.NoPages; pageNo++)
 		{
 			const FCodeAnalysisPage& page = bank.Pages[pageNo];
-			const uint16_t pageBaseAddr = bank.GetMappedAddress() + (pageNo * FCodeAnalysisPage::kPageSize);
 
 			for (int pageAddr = 0; pageAddr < FCodeAnalysisPage::kPageSize; pageAddr++)
 			{
 				FLabelInfo* pLabel = page.Labels[pageAddr];
-				if (pLabel != nullptr)
+				if (pLabel == nullptr)
+					continue;
+
+				const uint32_t key = FCodeAnalysisState::GetGlobalLabelKey(bank.Id, (pageNo * FCodeAnalysisPage::kPageSize) + pageAddr);
+				if (IsGlobalDataLabel(pLabel))
+				{
+					auto labelIt = state.GlobalDataLabels.find(key);
+					if (labelIt == state.GlobalDataLabels.end() || labelIt->second != pLabel)
+						return false;
+					noDataLabels++;
+				}
+				if (IsGlobalFunctionLabel(pLabel))
 				{
-					if (pLabel->LabelType == ELabelType::Data && pLabel->Global)
-						state.GlobalDataItems.emplace_back(pLabel, FAddressRef(bank.Id, pageBaseAddr + pageAddr));
-					if (pLabel->LabelType == ELabelType::Function)
-						state.GlobalFunctions.emplace_back(pLabel, FAddressRef(bank.Id, pageBaseAddr + pageAddr));
+					auto labelIt = state.GlobalFunctionLabels.find(key);
+					if (labelIt == state.GlobalFunctionLabels.end() || labelIt->second != pLabel)
+						return false;
+					noFunctionLabels++;
 				}
 			}
-
 		}
 	}
 
-	/*for (int addr = 0; addr < (1 << 16); addr++)
-	{
-		FLabelInfo *pLabel = state.GetLabelForAddress(addr);
-		
-		if (pLabel != nullptr)
-		{
-			const int16_t bankId = state.GetBankFromAddress(addr);
-		
-			if (pLabel->LabelType == ELabelType::Data && pLabel->Global)
-				state.GlobalDataItems.emplace_back(pLabel,bankId, addr);
-			if (pLabel->LabelType == ELabelType::Function)
-				state.GlobalFunctions.emplace_back(pLabel, bankId, addr);
-		}
-		
-	}*/
-
-	state.bRebuildFilteredGlobalDataItems = true;
-	state.bRebuildFilteredGlobalFunctions = true;
+	return noDataLabels == state.GlobalDataLabels.size() && noFunctionLabels == state.GlobalFunctionLabels.size();
 }
 
 FCodeAnalysisState::FCodeAnalysisState()
@@ -806,22 +1297,83 @@ FCodeAnalysisState::FCodeAnalysisState()
 	for (int i = 0; i < kNoPagesInAddressSpace; i++)
 	{
 		MappedMem[i] = nullptr;
+		MappedWriteMem[i] = nullptr;
 		MappedBanks[i] = -1;
 		MappedBanksBackup[i] = -1;
 		ReadPageTable[i] = nullptr;
 		WritePageTable[i] = nullptr;
 	}
 
+	DataAccessLog.resize(kDataAccessLogSize);
+}
+
+FCodeAnalysisState::~FCodeAnalysisState()
+{
+	InitCharacterSets(*this);	// frees character sets & maps
+
+	for (FMemoryRegionDescGenerator* pDescGen : RegionDescHandlers)
+		delete pDescGen;
+
+	if (CPUInterface != nullptr && CPUInterface->CPUType == ECPUType::Z80)
+		DeleteMachineStatesZ80(*this);
+	FLabelInfo::FreeAll(*this);
+	FCodeInfo::FreeAll(*this);
+	FCommentBlock::FreeAll(*this);
+	FCommentLine::DeleteAll(*this);
+
+	for (FCodeAnalysisBank& bank : Banks)
+		delete[] bank.Pages;
+}
+
+void FCodeAnalysisState::FreeRemovedItems()
+{
+	if (RemovedCodeInfos.empty() && RemovedLabels.empty() && RemovedCommentBlocks.empty())
+		return;
+
+	auto isRemoved = [this](const FItem* pItem)
+	{
+		return std::find(RemovedCodeInfos.begin(), RemovedCodeInfos.end(), pItem) != RemovedCodeInfos.end()
+			|| std::find(RemovedLabels.begin(), RemovedLabels.end(), pItem) != RemovedLabels.end()
+			|| std::find(RemovedCommentBlocks.begin(), RemovedCommentBlocks.end(), pItem) != RemovedCommentBlocks.end();
+	};
+
+	// removed labels come out of the global item lists, the views' filtered copies are pruned until they're regenerated
+	UpdateGlobalInfo(*this);
+	for (FCodeAnalysisViewState& viewState : ViewState)
+	{
+		if (isRemoved(viewState.GetCursorItem().Item))
+			viewState.SetCursorItem(FCodeAnalysisItem());
+
+		auto isRemovedItem = [&isRemoved](const FCodeAnalysisItem& item) { return isRemoved(item.Item); };
+		viewState.FilteredGlobalDataItems.erase(std::remove_if(viewState.FilteredGlobalDataItems.begin(), viewState.FilteredGlobalDataItems.end(), isRemovedItem), viewState.FilteredGlobalDataItems.end());
+		viewState.FilteredGlobalFunctions.erase(std::remove_if(viewState.FilteredGlobalFunctions.begin(), viewState.FilteredGlobalFunctions.end(), isRemovedItem), viewState.FilteredGlobalFunctions.end());
+	}
+
+	for (FCodeInfo* pCodeInfo : RemovedCodeInfos)
+		FCodeInfo::Free(*this, pCodeInfo);
+	for (FLabelInfo* pLabel : RemovedLabels)
+		FLabelInfo::Free(*this, pLabel);
+	for (FCommentBlock* pCommentBlock : RemovedCommentBlocks)
+		FCommentBlock::Free(*this, pCommentBlock);
+
+	RemovedCodeInfos.clear();
+	RemovedLabels.clear();
+	RemovedCommentBlocks.clear();
 }
 
 // Called each time a new game is loaded up
 void FCodeAnalysisState::Init(ICPUInterface* pCPUInterface)
 {
 	InitImageViewers();
-	InitCharacterSets();
+	InitCharacterSets(*this);
 	
 	ResetLabelNames();
-	ItemList.clear();
+	ItemList.Clear();
+	GlobalDataLabels.clear();
+	GlobalFunctionLabels.clear();
+	bGlobalInfoDirty = true;
+	InvalidateInstructionReferences();
+	NoLoggedDataAccesses = 0;
 
 	// reset registered pages
 	for (FCodeAnalysisPage* pPage : GetRegisteredPages())
@@ -839,16 +1391,14 @@ void FCodeAnalysisState::Init(ICPUInterface* pCPUInterface)
 		}*/
 	}	
 
-	// clear mapped mem
-	for (int i = 0; i < kNoPagesInAddressSpace; i++)
-	{
-		MappedMem[i] = nullptr;
-	}
-	
 	FreeMachineStates(*this);
-	FLabelInfo::FreeAll();
-	FCodeInfo::FreeAll();
-	FCommentBlock::FreeAll();
+	DisassemblyCache.Reset();
+	FLabelInfo::FreeAll(*this);
+	FCodeInfo::FreeAll(*this);
+	FCommentBlock::FreeAll(*this);
+	RemovedCodeInfos.clear();
+	RemovedLabels.clear();
+	RemovedCommentBlocks.clear();
 
 	for (int i = 0; i < FCodeAnalysisState::kNoViewStates; i++)
 	{
@@ -857,10 +1407,12 @@ void FCodeAnalysisState::Init(ICPUInterface* pCPUInterface)
 	}
 
 	// reset banks
+	FCommentLine::FreeAll(*this);
 	for (FCodeAnalysisBank& bank : Banks)
 	{
 		bank.Description.clear();
-		bank.ItemList.clear();
+		bank.ItemList.Clear();
+		bank.ItemListSegments.clear();
 	}
 
 	CPUInterface = pCPUInterface;
@@ -894,6 +1446,9 @@ void FCodeAnalysisState::OnFrameStart()
 
 void FCodeAnalysisState::OnFrameEnd()
 {
+	FlushDataAccessLog();
+	CurrentFrameNo++;	// access frame stamps count emulated frames
+
 	if (Debugger.FrameTick())
 	{
 		GetFocussedViewState().GoToAddress(CPUInterface->GetPC());
@@ -1000,11 +1555,9 @@ void RemoveLabelAtAddress(FCodeAnalysisState &state, FAddressRef address)
 
 	if (pLabelInfo != nullptr)
 	{
-		state.SetLabelForAddress(address, nullptr);
-		// Remove from globals
-		if (pLabelInfo->Global || pLabelInfo->LabelType == ELabelType::Function)
-			GenerateGlobalInfo(state);
+		state.SetLabelForAddress(address, nullptr);	// also removes it from the globals
 
+		state.FreeItemLater(pLabelInfo);	// the item list & cursors can still point at it
 		state.SetCodeAnalysisDirty(address);
 	}
 }
@@ -1053,9 +1606,7 @@ void FormatData(FCodeAnalysisState& state, const FDataFormattingOptions& options
 			pPrefix = "text";
 
 		snprintf(labelName,16, "%s_%s",pPrefix,NumStr(dataAddress));
-		FLabelInfo* pLabel = AddLabel(state, dataAddress, labelName, ELabelType::Data);
-		
-		pLabel->Global = true;
+		AddLabel(state, dataAddress, labelName, ELabelType::Data, true);
 	}
 
 	for (int itemNo = 0; itemNo < options.NoItems; itemNo++)
@@ -1075,7 +1626,14 @@ void FormatData(FCodeAnalysisState& state, const FDataFormattingOptions& options
 		for (int i = 0; i < options.ItemSize;i++)
 		{
 			if (options.ClearCodeInfo)
-				state.SetCodeInfoForAddress(dataAddress, nullptr);
+			{
+				FCodeInfo* pCodeInfo = state.GetCodeInfoForAddress(dataAddress);
+				if (pCodeInfo != nullptr)
+				{
+					state.SetCodeInfoForAddress(dataAddress, nullptr);
+					state.FreeItemLater(pCodeInfo);
+				}
+			}
 			
 			if (options.ClearLabels && dataAddress != options.StartAddress)	// don't remove first label
 				RemoveLabelAtAddress(state, state.AddressRefFromPhysicalAddress(dataAddress));
@@ -1083,6 +1641,8 @@ void FormatData(FCodeAnalysisState& state, const FDataFormattingOptions& options
 			dataAddress++;
 		}
 	}
+
+	state.UpdateCodeBitsForAddressRange(options.StartAddress, options.NoItems * options.ItemSize);
 }
 
 // machine state
@@ -1091,7 +1651,7 @@ FMachineState* AllocateMachineState(FCodeAnalysisState& state)
 	switch (state.CPUInterface->CPUType)
 	{
 	case ECPUType::Z80:
-		return AllocateMachineStateZ80();
+		return AllocateMachineStateZ80(state);
 	case ECPUType::M6502:
 		return nullptr;// TODO: this needs to be implemented
 	default:
@@ -1107,7 +1667,7 @@ void FreeMachineStates(FCodeAnalysisState& state)
 	switch (state.CPUInterface->CPUType)
 	{
 	case ECPUType::Z80:
-		return FreeMachineStatesZ80();
+		return FreeMachineStatesZ80(state);
 	case ECPUType::M6502:
 		return;// TODO: this needs to be implemented
 	}
@@ -5,14 +5,19 @@
 #include <set>
 #include <vector>
 #include <algorithm>
+#include <iterator>
 #include <assert.h>
 
 #include "CodeAnalyserTypes.h"
 #include "CodeAnalysisPage.h"
 #include "Debugger.h"
+#include "DisassemblyCache.h"
 
 class FGraphicsView;
 class FCodeAnalysisState;
+class FMemoryRegionDescGenerator;
+struct FCharacterSet;
+struct FCharacterMap;
 
 enum class ELabelType;
 
@@ -133,6 +138,92 @@ struct FCodeAnalysisItem
 
 };
 
+// Item list made up of segments stored elsewhere, so a segment can be rebuilt without touching the rest of the list
+// Call UpdateSegmentStarts() when segments have changed size
+class FItemList
+{
+public:
+	typedef std::vector<FCodeAnalysisItem>	FSegment;
+
+	class FIterator
+	{
+	public:
+		typedef std::forward_iterator_tag	iterator_category;
+		typedef FCodeAnalysisItem			value_type;
+		typedef std::ptrdiff_t				difference_type;
+		typedef const FCodeAnalysisItem*	pointer;
+		typedef const FCodeAnalysisItem&	reference;
+
+		FIterator(const FItemList* pList, int segmentNo) : pList(pList), SegmentNo(segmentNo) { SkipEmptySegments(); }
+
+		const FCodeAnalysisItem& operator*() const { return (*pList->Segments[SegmentNo])[ItemNo]; }
+		const FCodeAnalysisItem* operator->() const { return &(*pList->Segments[SegmentNo])[ItemNo]; }
+		FIterator& operator++()
+		{
+			if (++ItemNo == (int)pList->Segments[SegmentNo]->size())
+			{
+				ItemNo = 0;
+				SegmentNo++;
+				SkipEmptySegments();
+			}
+			return *this;
+		}
+		bool operator==(const FIterator& other) const { return SegmentNo == other.SegmentNo && ItemNo == other.ItemNo; }
+		bool operator!=(const FIterator& other) const { return !(*this == other); }
+
+	private:
+		void SkipEmptySegments()
+		{
+			while (SegmentNo < (int)pList->Segments.size() && pList->Segments[SegmentNo]->empty())
+				SegmentNo++;
+		}
+
+		const FItemList*	pList;
+		int					SegmentNo = 0;
+		int					ItemNo = 0;
+	};
+
+	void	Clear() { Segments.clear(); SegmentStarts.clear(); NoItems = 0; }
+	void	AddSegment(const FSegment* pSegment)
+	{
+		Segments.push_back(pSegment);
+		SegmentStarts.push_back(NoItems);
+		NoItems += (int)pSegment->size();
+	}
+	void	SetSegment(int segmentNo, const FSegment* pSegment) { Segments[segmentNo] = pSegment; }	// call UpdateSegmentStarts() after
+	void	UpdateSegmentStarts();
+
+	int		size() const { return NoItems; }
+	bool	empty() const { return NoItems == 0; }
+	int		GetNoSegments() const { return (int)Segments.size(); }
+	int		GetSegmentStart(int segmentNo) const { return SegmentStarts[segmentNo]; }
+
+	const FCodeAnalysisItem& operator[](int index) const
+	{
+		// last segment starting at or before the index - empty segments share their start with the next one
+		const int segmentNo = (int)(std::upper_bound(SegmentStarts.begin(), SegmentStarts.end(), index) - SegmentStarts.begin()) - 1;
+		return (*Segments[segmentNo])[index - SegmentStarts[segmentNo]];
+	}
+
+	FIterator	begin() const { return FIterator(this, 0); }
+	FIterator	end() const { return FIterator(this, (int)Segments.size()); }
+
+private:
+	std::vector<const FSegment*>	Segments;
+	std::vector<int>				SegmentStarts;	// index of each segment's first item
+	int								NoItems = 0;
+};
+
+// Items for a page of a bank - pages are rebuilt individually when they're dirty
+struct FItemListSegment
+{
+	FItemList::FSegment			Items;
+	std::vector<FCommentLine*>	CommentLines;	// lines allocated for this page's comment blocks
+	int		ItemIndexForAddress[FCodeAnalysisPage::kPageSize];	// index in Items of first item at or after each page address
+	int		NextItemAddress = 0;	// bank address following the last code/data item - items can overrun into the next page
+	bool	bDirty = true;
+};
+
 struct FAddressCoord
 {
 	FAddressRef		Address;
@@ -217,19 +308,37 @@ struct FCodeAnalysisBank
 	int16_t				Id = -1;
 	int					NoPages = 0;
 	uint32_t			SizeMask = 0;
-	std::vector<int>	MappedPages;	// banks can be mapped to multiple pages
+	uint64_t			MappedPageBits = 0;	// bit for each address space page the bank is mapped from - banks can be mapped to multiple pages
 	int					PrimaryMappedPage = -1;
 	uint8_t*			Memory = nullptr;	// pointer to memory bank occupies
 	FCodeAnalysisPage*	Pages = nullptr;
 	std::string			Name;
 	std::string			Description;	// where we can describe what the bank is used for
 	bool				bReadOnly = false;
-	bool				bIsDirty = false;
-	std::vector<FCodeAnalysisItem>		ItemList;
+	bool				bIsDirty = false;	// whole item list needs rebuilding
+	std::vector<FItemListSegment>	ItemListSegments;	// one per page
+	FItemList			ItemList;	// view over ItemListSegments
+
+	void		SetPageDirty(uint16_t addr)
+	{
+		const int pageNo = (uint16_t)(addr - GetMappedAddress()) >> FCodeAnalysisPage::kPageShift;
+		if (PrimaryMappedPage != -1 && pageNo < (int)ItemListSegments.size())
+			ItemListSegments[pageNo].bDirty = true;
+		else
+			bIsDirty = true;
+	}
 
 	bool		AddressValid(uint16_t addr) const { return addr >= GetMappedAddress() && addr < GetMappedAddress() + (NoPages * FCodeAnalysisPage::kPageSize);	}
 	bool		IsUsed() const { return Pages[0].bUsed; }
-	bool		IsMapped() const { return MappedPages.empty() == false; }
+	bool		IsMapped() const { return MappedPageBits != 0; }
+	int			GetFirstMappedPage() const { return MappedPageBits != 0 ? LowestSetBit(MappedPageBits) : -1; }
+	// page the mapping covering an address space page starts at, -1 if the bank isn't mapped there
+	int			GetMappedStartPage(int pageNo) const
+	{
+		const uint64_t startPageBits = MappedPageBits & (~0ull >> (63 - pageNo));
+		const int startPageNo = startPageBits != 0 ? HighestSetBit(startPageBits) : -1;
+		return startPageNo != -1 && pageNo < startPageNo + NoPages ? startPageNo : -1;
+	}
 	uint16_t	GetMappedAddress() const { return PrimaryMappedPage * FCodeAnalysisPage::kPageSize; }
 	uint16_t	GetSizeBytes() const { return NoPages * FCodeAnalysisPage::kPageSize; }
 };
@@ -243,24 +352,50 @@ public:
 	static const int kPageShift = 10;
 	static const int kPageMask = 1023;
 	static const int kNoPagesInAddressSpace = kAddressSize / FCodeAnalysisPage::kPageSize;
+	static_assert(kNoPagesInAddressSpace <= 64, "page bit masks are 64 bit");
 
 	FCodeAnalysisState();
+	~FCodeAnalysisState();
 	void	Init(ICPUInterface* pCPUInterface);
 	void	OnFrameStart();
 	void	OnFrameEnd();
 
+	// Data access logging - the emulation loop logs accesses which are registered in bulk by FlushDataAccessLog()
+	// The log is flushed at frame end & whenever the memory map or code info changes so results are the same as registering each access
+	void	LogDataRead(uint16_t pc, uint16_t dataAddr)
+	{
+		if (NoLoggedDataAccesses == kDataAccessLogSize)
+			FlushDataAccessLog();
+		DataAccessLog[NoLoggedDataAccesses++] = { pc, dataAddr, false };
+	}
+	void	LogDataWrite(uint16_t pc, uint16_t dataAddr)
+	{
+		if (NoLoggedDataAccesses == kDataAccessLogSize)
+			FlushDataAccessLog();
+		DataAccessLog[NoLoggedDataAccesses++] = { pc, dataAddr, true };
+	}
+	void	FlushDataAccessLog();
+
 	const ICPUInterface* GetCPUInterface() const { return CPUInterface; }
 
 	ICPUInterface* CPUInterface = nullptr;	// Make private
-	int						CurrentFrameNo = 0;
+	int						CurrentFrameNo = 0;	// emulated frame count, advanced by OnFrameEnd()
 
 	// Memory Banks & Pages
 	int16_t		CreateBank(const char* name, int noKb, uint8_t* pMemory, bool bReadOnly);
 	bool		MapBank(int16_t bankId, int startPageNo);
 	bool		UnMapBank(int16_t bankId, int startPageNo);
+	void		SetBankPrimaryMappedPage(int16_t bankId, int pageNo);	// address the bank's items are referenced by
+	// set the memory ReadByte() etc. use for a page, for machines that page memory without MapBank()
+	// nullptr reads/writes through the CPU interface - pass nullptr for write memory if writes need the machine to handle them
+	void		SetPageMemory(int pageNo, uint8_t* pReadMem, uint8_t* pWriteMem) { MappedMem[pageNo] = pReadMem; MappedWriteMem[pageNo] = pWriteMem; }
 	bool		IsBankIdMapped(int16_t bankId) const;
 	bool		IsAddressValid(FAddressRef addr) const;
 
+	// Item list lookups - return the index of the first item at or after the address, -1 if it's not in the list
+	int			GetBankItemListIndex(FAddressRef addr) const;	// index into the bank's ItemList
+	int			GetItemListIndex(FAddressRef addr) const;		// index into ItemList
+
 	bool		MapBankForAnalysis(FCodeAnalysisBank& bank);
 	void		UnMapAnalysisBanks();
 
@@ -277,12 +412,14 @@ public:
 
 	FAddressRef	AddressRefFromPhysicalAddress(uint16_t physAddr) const { return FAddressRef(GetBankFromAddress(physAddr), physAddr); }
 
+	// Memory access goes straight to the memory mapped with MapBank() or SetPageMemory()
+	// Pages with no memory (I/O etc.) fall back to the CPU interface.
 	uint8_t		ReadByte(uint16_t address) const
 	{
-		if (MappedMem[address >> kPageShift] == nullptr)
+		const uint8_t* pMem = MappedMem[address >> kPageShift];
+		if (pMem == nullptr)
 			return CPUInterface->ReadByte(address);
-		else
-			return *(MappedMem[(address >> kPageShift)] + (address & kPageMask));
+		return pMem[address & kPageMask];
 	}
 
 	uint8_t		ReadByte(FAddressRef address) const
@@ -294,25 +431,54 @@ public:
 
 	uint16_t	ReadWord(uint16_t address) const
 	{
-		if (MappedMem[address >> kPageShift] == nullptr)
+		const uint8_t* pMem = MappedMem[address >> kPageShift];
+		if (pMem == nullptr)
 			return CPUInterface->ReadWord(address);
-		else
-			return *(uint16_t*)(MappedMem[address >> kPageShift] + (address & kPageMask));
+		if ((address & kPageMask) == kPageMask)	// high byte is in the next page
+			return ReadByte(address) | (ReadByte(address + 1) << 8);
+		return *(const uint16_t*)(pMem + (address & kPageMask));
 	}
 
 	uint16_t		ReadWord(FAddressRef address) const
 	{
 		const FCodeAnalysisBank* pBank = GetBank(address.BankId);
 		assert(pBank != nullptr);
-		return *(uint16_t*)(&pBank->Memory[address.Address - pBank->GetMappedAddress()]);
+		const uint16_t bankAddr = address.Address - pBank->GetMappedAddress();
+		if (bankAddr == pBank->GetSizeBytes() - 1)	// high byte is past the end of the bank
+			return pBank->Memory[bankAddr] | (ReadByte((uint16_t)(address.Address + 1)) << 8);
+		return *(const uint16_t*)(&pBank->Memory[bankAddr]);
 	}
 
 	void		WriteByte(uint16_t address, uint8_t value) 
 	{ 
-		if (MappedMem[address >> kPageShift] == nullptr)
+		uint8_t* pMem = MappedWriteMem[address >> kPageShift];
+		if (pMem == nullptr)
 			CPUInterface->WriteByte(address, value);
 		else
-			*(MappedMem[(address >> kPageShift)] + (address & kPageMask)) = value;
+			pMem[address & kPageMask] = value;
+		InvalidateDecodedInstruction(address);
+	}
+
+	// call when memory is written to outside of the emulated CPU so executed code gets decoded again
+	void		InvalidateDecodedInstruction(uint16_t address);
+	// for CPU writes that aren't registered as data accesses - an instruction written to is decoded again when it's next executed
+	void		InvalidateDecodedInstructionOnWrite(uint16_t address)
+	{
+		if (IsCodeAddress(address))
+			InvalidateDecodedInstruction(address);
+	}
+	// executed instructions re-register their label references - for when labels or references change
+	void		InvalidateInstructionReferences() { ReferenceGeneration++; }
+	// Changes when labels or references change, or a bank is mapped or unmapped where the instruction's jump or pointer address is.
+	// The counters only go up so the sum changes if any of them do.
+	uint32_t	GetReferenceGeneration(const FDecodedInstruction& decoded) const
+	{
+		uint32_t generation = ReferenceGeneration;
+		if (decoded.bJump)
+			generation += PageMappingGeneration[decoded.JumpAddress >> kPageShift];
+		if (decoded.bPointer)
+			generation += PageMappingGeneration[decoded.PointerAddress >> kPageShift];
+		return generation;
 	}
 	
 	FCodeAnalysisPage* GetPage(int16_t id) { return RegisteredPages[id]; }
@@ -321,7 +487,7 @@ public:
 	{
 		FCodeAnalysisBank* pBank = GetBank(addrRef.BankId);
 		if (pBank != nullptr)
-			pBank->bIsDirty = true;
+			pBank->SetPageDirty(addrRef.Address);
 		bCodeAnalysisDataDirty = true;
 	}
 
@@ -354,8 +520,9 @@ public:
 	}
 	
 	bool IsCodeAnalysisDataDirty() const { return bCodeAnalysisDataDirty; }
-	void ClearRemappings() { bMemoryRemapped = false; }
+	void ClearRemappings() { bMemoryRemapped = false; RemappedPageBits = 0; }
 	bool HasMemoryBeenRemapped() const { return bMemoryRemapped; }
+	uint64_t GetRemappedPages() const { return RemappedPageBits; }	// bit for each address space page mapped or unmapped since ClearRemappings()
 	//const std::vector<int16_t>& GetDirtyBanks() const { return RemappedBanks; }
 
 	void	ResetLabelNames() { LabelUsage.clear(); }
@@ -365,8 +532,9 @@ public:
 public:
 
 	bool					bRegisterDataAccesses = true;
+	bool					bAllowParallelAnalysis = true;	// whole memory passes like ReAnalyseCode() can split pages over the worker pool
 
-	std::vector<FCodeAnalysisItem>	ItemList;
+	FItemList						ItemList;	// items of the mapped banks, in address order - see UpdateItemList()
 
 	std::vector<FCodeAnalysisItem>	GlobalDataItems;
 	bool						bRebuildFilteredGlobalDataItems = true;	// should this be in the view 
@@ -374,6 +542,11 @@ public:
 	std::vector<FCodeAnalysisItem>	GlobalFunctions;
 	bool						bRebuildFilteredGlobalFunctions = true;
 
+	// labels for the global lists, keyed on GetGlobalLabelKey() so they're in bank then address order
+	std::map<uint32_t, FLabelInfo*>	GlobalDataLabels;
+	std::map<uint32_t, FLabelInfo*>	GlobalFunctionLabels;
+	bool						bGlobalInfoDirty = true;	// global item lists need regenerating - see UpdateGlobalInfo()
+
 	static const int kNoViewStates = 4;
 	FCodeAnalysisViewState	ViewState[kNoViewStates];	// new multiple view states
 	int						FocussedWindowId = 0;
@@ -391,6 +564,31 @@ public:
 	bool					bAllowEditing = false;
 
 	FCodeAnalysisConfig Config;
+
+	// Data owned by this analysis - nothing is shared between analysis states so several can run at once
+	std::vector<FCharacterSet*>					CharacterSets;
+	std::vector<FCharacterMap*>					CharacterMaps;
+	std::vector<FMemoryRegionDescGenerator*>	RegionDescHandlers;
+
+	// allocated items, see FCodeInfo::Allocate() etc.
+	FSlabArena<FLabelInfo>		LabelArena;
+	FSlabArena<FCodeInfo>		CodeInfoArena;
+	FSlabArena<FCommentBlock>	CommentBlockArena;
+
+	// Removed items are freed once the item lists have been rebuilt, until then item lists & view cursors can still point at them
+	void	FreeItemLater(FCodeInfo* pCodeInfo) { RemovedCodeInfos.push_back(pCodeInfo); }
+	void	FreeItemLater(FLabelInfo* pLabel) { RemovedLabels.push_back(pLabel); }
+	void	FreeItemLater(FCommentBlock* pCommentBlock) { RemovedCommentBlocks.push_back(pCommentBlock); }
+	void	FreeRemovedItems();	// call after rebuilding the item lists
+	std::vector<FCodeInfo*>		RemovedCodeInfos;
+	std::vector<FLabelInfo*>	RemovedLabels;
+	std::vector<FCommentBlock*>	RemovedCommentBlocks;
+	std::vector<FCommentLine*>	AllocatedCommentLines;
+	std::vector<FCommentLine*>	FreeCommentLines;
+
+	FDisassemblyCache			DisassemblyCache;	// see GetDisassemblyText()
+	std::vector<FMachineState*>	AllocatedMachineStates;
+	std::vector<FMachineState*>	FreeMachineStateList;
 public:
 	// Access functions for code analysis
 
@@ -424,58 +622,52 @@ public:
 	FLabelInfo* GetLabelForPhysicalAddress(uint16_t addr) { return GetReadPage(addr)->Labels[addr & kPageMask]; }
 	FLabelInfo* GetLabelForAddress(FAddressRef addrRef)
 	{
-		const FCodeAnalysisBank* pBank = GetBank(addrRef.BankId);
-		if (pBank != nullptr)
-		{
-			const uint16_t bankAddr = addrRef.Address - (pBank->PrimaryMappedPage * FCodeAnalysisPage::kPageSize);
-			return pBank->Pages[bankAddr >> FCodeAnalysisPage::kPageShift].Labels[bankAddr & FCodeAnalysisPage::kPageMask];
-		}
-		else
-		{
-			return nullptr;
-		}
+		const FCodeAnalysisPage* pPage = GetBankPageForAddress(addrRef);
+		return pPage != nullptr ? pPage->Labels[addrRef.Address & kPageMask] : nullptr;
 	}
 	void SetLabelForPhysicalAddress(uint16_t addr, FLabelInfo* pLabel)
 	{
 		if(pLabel != nullptr)	// ensure no name clashes
 			EnsureUniqueLabelName(pLabel->Name);
-		GetReadPage(addr)->Labels[addr & kPageMask] = pLabel; 
+		GetReadPage(addr)->SetLabel(addr & kPageMask, pLabel);
+		UpdateGlobalLabel(AddressRefFromPhysicalAddress(addr));
+		InvalidateInstructionReferences();
 	}
+	// Find nearest label at or before an address, searching back through the banks mapped below it
+	// labelTypeMask has a bit set for each ELabelType to look for
+	FLabelInfo* FindLabelAtOrBeforeAddress(FAddressRef addrRef, uint16_t& outLabelAddress, uint32_t labelTypeMask = ~0u) const;
 	void SetLabelForAddress(FAddressRef addrRef, FLabelInfo* pLabel)
 	{
 		if (pLabel != nullptr)	// ensure no name clashes
 			EnsureUniqueLabelName(pLabel->Name);
 
-		FCodeAnalysisBank* pBank = GetBank(addrRef.BankId);
-		if (pBank != nullptr)
+		FCodeAnalysisPage* pPage = GetBankPageForAddress(addrRef);
+		if (pPage != nullptr)
 		{
-			const uint16_t bankAddr = addrRef.Address - (pBank->PrimaryMappedPage * FCodeAnalysisPage::kPageSize);
-			pBank->Pages[bankAddr >> FCodeAnalysisPage::kPageShift].Labels[bankAddr & FCodeAnalysisPage::kPageMask] = pLabel;
+			pPage->SetLabel(addrRef.Address & kPageMask, pLabel);
+			UpdateGlobalLabel(addrRef);
+			InvalidateInstructionReferences();
 		}
 	}
 
+	// Global info - the label setters keep it up to date, call UpdateGlobalLabel() after changing a label's type
+	void	SetLabelGlobal(FAddressRef addrRef, bool bGlobal);
+	void	UpdateGlobalLabel(FAddressRef addrRef);
+	void	UpdateGlobalLabelForPage(const FCodeAnalysisPage* pPage, uint16_t pageAddr);
+	void	AddBankGlobalLabels(const FCodeAnalysisBank& bank);
+	static uint32_t	GetGlobalLabelKey(int16_t bankId, uint16_t bankAddr) { return ((uint32_t)bankId << 16) | bankAddr; }
+
 	//FCommentBlock* GetCommentBlockForAddress(uint16_t addr) const { return GetReadPage(addr)->CommentBlocks[addr & kPageMask]; }
 	FCommentBlock* GetCommentBlockForAddress(FAddressRef addrRef)
 	{
-		const FCodeAnalysisBank* pBank = GetBank(addrRef.BankId);
-		if (pBank != nullptr)
-		{
-			const uint16_t bankAddr = addrRef.Address - (pBank->PrimaryMappedPage * FCodeAnalysisPage::kPageSize);
-			return pBank->Pages[bankAddr >> FCodeAnalysisPage::kPageShift].CommentBlocks[bankAddr & FCodeAnalysisPage::kPageMask];
-		}
-		else
-		{
-			return nullptr;
-		}
+		const FCodeAnalysisPage* pPage = GetBankPageForAddress(addrRef);
+		return pPage != nullptr ? pPage->CommentBlocks[addrRef.Address & kPageMask] : nullptr;
 	}
 	void SetCommentBlockForAddress(FAddressRef addrRef, FCommentBlock* pCommentBlock)
 	{
-		FCodeAnalysisBank* pBank = GetBank(addrRef.BankId);
-		if (pBank != nullptr)
-		{
-			const uint16_t bankAddr = addrRef.Address - (pBank->PrimaryMappedPage * FCodeAnalysisPage::kPageSize);
-			pBank->Pages[bankAddr >> FCodeAnalysisPage::kPageShift].CommentBlocks[bankAddr & FCodeAnalysisPage::kPageMask] = pCommentBlock;
-		}
+		FCodeAnalysisPage* pPage = GetBankPageForAddress(addrRef);
+		if (pPage != nullptr)
+			pPage->CommentBlocks[addrRef.Address & kPageMask] = pCommentBlock;
 		//GetReadPage(addr)->CommentBlocks[addr & kPageMask] = pCommentBlock;
 	}
 
@@ -483,52 +675,88 @@ public:
 	FCodeInfo* GetCodeInfoForAddress(uint16_t addr) { return GetReadPage(addr)->CodeInfo[addr & kPageMask]; }
 	FCodeInfo* GetCodeInfoForAddress(FAddressRef addrRef)
 	{
-		const FCodeAnalysisBank* pBank = GetBank(addrRef.BankId);
-		if (pBank != nullptr)
-		{
-			const uint16_t bankAddr = addrRef.Address - (pBank->PrimaryMappedPage * FCodeAnalysisPage::kPageSize);
-			return pBank->Pages[bankAddr >> FCodeAnalysisPage::kPageShift].CodeInfo[bankAddr & FCodeAnalysisPage::kPageMask];
-		}
-		else
-		{
-			return nullptr;
-		}
+		const FCodeAnalysisPage* pPage = GetBankPageForAddress(addrRef);
+		return pPage != nullptr ? pPage->CodeInfo[addrRef.Address & kPageMask] : nullptr;
 	}
 
 	void SetCodeInfoForAddress(uint16_t addr, FCodeInfo* pCodeInfo) { GetReadPage(addr)->CodeInfo[addr & kPageMask] = pCodeInfo; }
 
+	// 'is code' bitmap for the current memory view - see FCodeAnalysisPage::IsCode()
+	bool IsCodeAddress(uint16_t addr) const { return GetReadPage(addr)->IsCode(addr & kPageMask); }
+	// call after changing the code or operand info for a range of addresses
+	void UpdateCodeBitsForAddressRange(uint16_t addr, int noBytes)
+	{
+		for (int i = 0; i < noBytes; i++)
+		{
+			const uint16_t byteAddr = addr + i;
+			GetReadPage(byteAddr)->UpdateCodeBit(byteAddr & kPageMask);
+		}
+	}
+
 	const FDataInfo* GetReadDataInfoForAddress(uint16_t addr) const { return &GetReadPage(addr)->DataInfo[addr & kPageMask]; }
 	FDataInfo* GetReadDataInfoForAddress(uint16_t addr) { return &GetReadPage(addr)->DataInfo[addr & kPageMask]; }
 	FDataInfo* GetReadDataInfoForAddress(FAddressRef addrRef)
 	{
-		const FCodeAnalysisBank* pBank = GetBank(addrRef.BankId);
-		if (pBank != nullptr)
-		{
-			const uint16_t bankAddr = addrRef.Address - pBank->GetMappedAddress();
-			return &pBank->Pages[bankAddr >> FCodeAnalysisPage::kPageShift].DataInfo[bankAddr & FCodeAnalysisPage::kPageMask];
-		}
-		else
-		{
-			return nullptr;
-		}
+		FCodeAnalysisPage* pPage = GetBankPageForAddress(addrRef);
+		return pPage != nullptr ? &pPage->DataInfo[addrRef.Address & kPageMask] : nullptr;
 	}
 	const FDataInfo* GetWriteDataInfoForAddress(uint16_t addr) const { return  &GetWritePage(addr)->DataInfo[addr & kPageMask]; }
 	FDataInfo* GetWriteDataInfoForAddress(uint16_t addr) { return &GetWritePage(addr)->DataInfo[addr & kPageMask]; }
 	FDataInfo* GetWriteDataInfoForAddress(FAddressRef addrRef)
 	{
-		const FCodeAnalysisBank* pBank = GetBank(addrRef.BankId);
-		if (pBank != nullptr)
-		{
-			const uint16_t bankAddr = addrRef.Address - pBank->GetMappedAddress();
-			return &pBank->Pages[bankAddr >> FCodeAnalysisPage::kPageShift].DataInfo[bankAddr & FCodeAnalysisPage::kPageMask];
-		}
-		else
-		{
-			return nullptr;
-		}
+		FCodeAnalysisPage* pPage = GetBankPageForAddress(addrRef);
+		return pPage != nullptr ? &pPage->DataInfo[addrRef.Address & kPageMask] : nullptr;
+	}
+
+	// Data access info - reads are registered with the read page & writes with the write page
+	// Looked up in a flat table of the bank pages covering each address space page, see UpdateBankPageTable()
+	// returns nullptr if the bank doesn't cover the address
+	FCodeAnalysisPage* GetBankPageForAddress(FAddressRef addrRef)
+	{
+		const size_t index = ((size_t)(uint16_t)addrRef.BankId * kNoPagesInAddressSpace) + (addrRef.Address >> kPageShift);	// invalid bank id is out of range
+		return index < BankPageTable.size() ? BankPageTable[index] : nullptr;
 	}
-	FAddressRef GetLastWriterForAddress(uint16_t addr) const { return GetWritePage(addr)->DataInfo[addr & kPageMask].LastWriter; }
-	void SetLastWriterForAddress(uint16_t addr, FAddressRef lastWriter) { GetWritePage(addr)->DataInfo[addr & kPageMask].LastWriter = lastWriter; }
+	const FCodeAnalysisPage* GetBankPageForAddress(FAddressRef addrRef) const { return ((FCodeAnalysisState*)this)->GetBankPageForAddress(addrRef); }
+
+	FAddressRef GetLastWriterForAddress(uint16_t addr) const { return GetWritePage(addr)->LastWriter[addr & kPageMask]; }
+	FAddressRef GetLastWriterForAddress(FAddressRef addrRef) const
+	{
+		const FCodeAnalysisPage* pPage = GetBankPageForAddress(addrRef);
+		return pPage != nullptr ? pPage->LastWriter[addrRef.Address & kPageMask] : FAddressRef();
+	}
+	void SetLastWriterForAddress(uint16_t addr, FAddressRef lastWriter) { GetWritePage(addr)->LastWriter[addr & kPageMask] = lastWriter; }
+	int GetLastFrameReadForAddress(uint16_t addr) const { return GetReadPage(addr)->LastFrameRead[addr & kPageMask]; }
+	int GetLastFrameWrittenForAddress(uint16_t addr) const { return GetWritePage(addr)->LastFrameWritten[addr & kPageMask]; }
+	int GetLastFrameReadForAddress(FAddressRef addrRef) const
+	{
+		const FCodeAnalysisPage* pPage = GetBankPageForAddress(addrRef);
+		return pPage != nullptr ? pPage->LastFrameRead[addrRef.Address & kPageMask] : -1;
+	}
+	int GetLastFrameWrittenForAddress(FAddressRef addrRef) const
+	{
+		const FCodeAnalysisPage* pPage = GetBankPageForAddress(addrRef);
+		return pPage != nullptr ? pPage->LastFrameWritten[addrRef.Address & kPageMask] : -1;
+	}
+	int GetLastFrameExecutedForAddress(FAddressRef addrRef) const
+	{
+		const FCodeAnalysisPage* pPage = GetBankPageForAddress(addrRef);
+		return pPage != nullptr ? pPage->LastFrameExecuted[addrRef.Address & kPageMask] : -1;
+	}
+
+	const FItemReferenceTracker& GetDataReadsForAddress(uint16_t addr) const { return GetReadPage(addr)->GetDataReads(addr & kPageMask); }
+	const FItemReferenceTracker& GetDataWritesForAddress(uint16_t addr) const { return GetWritePage(addr)->GetDataWrites(addr & kPageMask); }
+	const FItemReferenceTracker& GetDataReadsForAddress(FAddressRef addrRef) const
+	{
+		const FCodeAnalysisPage* pPage = GetBankPageForAddress(addrRef);
+		return pPage != nullptr ? pPage->GetDataReads(addrRef.Address & kPageMask) : FCodeAnalysisPage::kNoReferences;
+	}
+	const FItemReferenceTracker& GetDataWritesForAddress(FAddressRef addrRef) const
+	{
+		const FCodeAnalysisPage* pPage = GetBankPageForAddress(addrRef);
+		return pPage != nullptr ? pPage->GetDataWrites(addrRef.Address & kPageMask) : FCodeAnalysisPage::kNoReferences;
+	}
+	FItemReferenceTracker& GetOrCreateDataReadsForAddress(uint16_t addr) { return GetReadPage(addr)->GetOrCreateDataReads(addr & kPageMask); }
+	FItemReferenceTracker& GetOrCreateDataWritesForAddress(uint16_t addr) { return GetWritePage(addr)->GetOrCreateDataWrites(addr & kPageMask); }
 
 	FMachineState* GetMachineState(uint16_t addr) { return GetReadPage(addr)->MachineState[addr & kPageMask];}
 	void SetMachineStateForAddress(uint16_t addr, FMachineState* pMachineState) { GetReadPage(addr)->MachineState[addr & kPageMask] = pMachineState; }
@@ -562,6 +790,8 @@ private:
 		SetCodeAnalysisReadPage(pageNo, pReadPage);
 		SetCodeAnalysisWritePage(pageNo, pWritePage);
 	}
+	void					UpdateBankPageTable(const FCodeAnalysisBank& bank);
+	void					UpdateGlobalLabelInBank(const FCodeAnalysisBank& bank, uint16_t bankAddr);
 
 	// private data members
 
@@ -569,10 +799,14 @@ private:
 	FCodeAnalysisPage*				WritePageTable[kNoPagesInAddressSpace];
 
 	std::vector<FCodeAnalysisBank>	Banks;
+	std::vector<FCodeAnalysisPage*>	BankPageTable;	// kNoPagesInAddressSpace entries per bank - the bank page at each address space page
 	int16_t							MappedBanks[kNoPagesInAddressSpace];	// banks mapped into address space
 	int16_t							MappedBanksBackup[kNoPagesInAddressSpace];	// banks mapped into address space
 
-	uint8_t*						MappedMem[kNoPagesInAddressSpace];	// mapped analysis memory
+	uint8_t*						MappedMem[kNoPagesInAddressSpace];	// memory for each page, see ReadByte()
+	uint8_t*						MappedWriteMem[kNoPagesInAddressSpace];	// nullptr for read only pages
+	uint8_t*						MappedMemBackup[kNoPagesInAddressSpace];
+	uint8_t*						MappedWriteMemBackup[kNoPagesInAddressSpace];
 				
 	std::vector<FCodeAnalysisPage*>	RegisteredPages;
 	std::vector<std::string>	PageNames;
@@ -581,6 +815,20 @@ private:
 
 	bool						bCodeAnalysisDataDirty = false;
 	bool						bMemoryRemapped = true;
+	uint64_t					RemappedPageBits = 0;
+	uint32_t					ReferenceGeneration = 1;	// see FDecodedInstruction
+	uint32_t					PageMappingGeneration[kNoPagesInAddressSpace] = {};	// bumped when the bank mapped to a page changes
+
+	// logged data accesses waiting to be registered
+	struct FDataAccessRecord
+	{
+		uint16_t	PC;
+		uint16_t	Address;
+		bool		bWrite;
+	};
+	static const int				kDataAccessLogSize = 64 * 1024;	// a frame is ~70K T-states so this is a frame's worth
+	std::vector<FDataAccessRecord>	DataAccessLog;
+	int								NoLoggedDataAccesses = 0;
 
 };
 
@@ -590,10 +838,13 @@ void RunStaticCodeAnalysis(FCodeAnalysisState &state, uint16_t pc);
 bool RegisterCodeExecuted(FCodeAnalysisState &state, uint16_t pc, uint16_t oldpc);
 void ReAnalyseCode(FCodeAnalysisState &state);
 uint16_t WriteCodeInfoForAddress(FCodeAnalysisState& state, uint16_t pc);
-void GenerateGlobalInfo(FCodeAnalysisState &state);
+void GenerateGlobalInfo(FCodeAnalysisState &state);	// full rebuild - for after loading
+void UpdateGlobalInfo(FCodeAnalysisState& state);
+bool CheckGlobalInfo(const FCodeAnalysisState& state);
 void RegisterDataRead(FCodeAnalysisState& state, uint16_t pc, uint16_t dataAddr);
 void RegisterDataWrite(FCodeAnalysisState &state, uint16_t pc, uint16_t dataAddr, uint8_t value);
 void UpdateCodeInfoForAddress(FCodeAnalysisState &state, uint16_t pc);
+const std::string& GetDisassemblyText(FCodeAnalysisState& state, uint16_t pc, const FCodeInfo* pCodeInfo);	// valid until the next call
 void ResetReferenceInfo(FCodeAnalysisState &state);
 
 std::string GetItemText(FCodeAnalysisState& state, FAddressRef address);
@@ -602,6 +853,7 @@ std::string GetItemText(FCodeAnalysisState& state, FAddressRef address);
 void Undo(FCodeAnalysisState &state);
 
 FLabelInfo* AddLabel(FCodeAnalysisState& state, uint16_t address, const char* name, ELabelType type);
+FLabelInfo* AddLabel(FCodeAnalysisState& state, uint16_t address, const char* name, ELabelType type, bool bGlobal);
 FCommentBlock* AddCommentBlock(FCodeAnalysisState& state, FAddressRef address);
 FLabelInfo* AddLabelAtAddress(FCodeAnalysisState &state, FAddressRef address);
 void RemoveLabelAtAddress(FCodeAnalysisState &state, FAddressRef address);
@@ -13,9 +13,9 @@ using json = nlohmann::json;
 
 void WritePageToJson(const FCodeAnalysisPage& page, json& jsonDoc);
 void ReadPageFromJson(FCodeAnalysisState& state, FCodeAnalysisPage& page, const json& jsonDoc);
-FCommentBlock* CreateCommentBlockFromJson(const json& commentBlockJson);
-FCodeInfo* CreateCodeInfoFromJson(const json& codeInfoJson);
-FLabelInfo* CreateLabelInfoFromJson(const json& labelInfoJson);
+FCommentBlock* CreateCommentBlockFromJson(FCodeAnalysisState& state, const json& commentBlockJson);
+FCodeInfo* CreateCodeInfoFromJson(FCodeAnalysisState& state, const json& codeInfoJson);
+FLabelInfo* CreateLabelInfoFromJson(FCodeAnalysisState& state, const json& labelInfoJson);
 void LoadDataInfoFromJson(FCodeAnalysisState& state, FDataInfo* pDataInfo, const json& dataInfoJson);
 
 bool ExportAnalysisJson(FCodeAnalysisState& state, const char* pJsonFileName, bool bROMS)
@@ -55,9 +55,9 @@ bool ExportAnalysisJson(FCodeAnalysisState& state, const char* pJsonFileName, bo
 	LOGINFO("%d pages written", pagesWritten);
 
 	// Write character sets
-	for (int i = 0; i < GetNoCharacterSets(); i++)
+	for (int i = 0; i < GetNoCharacterSets(state); i++)
 	{
-		const FCharacterSet* pCharSet = GetCharacterSetFromIndex(i);
+		const FCharacterSet* pCharSet = GetCharacterSetFromIndex(state, i);
 		json jsonCharacterSet;
 
 		jsonCharacterSet["AddressRef"] = pCharSet->Params.Address.Val;
@@ -70,9 +70,9 @@ bool ExportAnalysisJson(FCodeAnalysisState& state, const char* pJsonFileName, bo
 	}
 
 	// Write character maps
-	for (int i = 0; i < GetNoCharacterMaps(); i++)
+	for (int i = 0; i < GetNoCharacterMaps(state); i++)
 	{
-		const FCharacterMap* pCharMap = GetCharacterMapFromIndex(i);
+		const FCharacterMap* pCharMap = GetCharacterMapFromIndex(state, i);
 		json jsonCharacterMap;
 
 		jsonCharacterMap["AddressRef"] = pCharMap->Params.Address.Val;
@@ -153,7 +153,7 @@ bool ImportAnalysisJson(FCodeAnalysisState& state, const char* pJsonFileName)
 		for (const auto& commentBlockJson : jsonGameData["CommentBlocks"])
 		{
 			const uint16_t addr = commentBlockJson["Address"];
-			FCommentBlock* pCommentBlock = CreateCommentBlockFromJson(commentBlockJson);
+			FCommentBlock* pCommentBlock = CreateCommentBlockFromJson(state, commentBlockJson);
 			state.SetCommentBlockForAddress(state.AddressRefFromPhysicalAddress(addr), pCommentBlock);
 		}
 	}
@@ -163,7 +163,7 @@ bool ImportAnalysisJson(FCodeAnalysisState& state, const char* pJsonFileName)
 		for (const auto codeInfoJson : jsonGameData["CodeInfo"])
 		{
 			const uint16_t addr = codeInfoJson["Address"];
-			FCodeInfo* pCodeInfo = CreateCodeInfoFromJson(codeInfoJson);
+			FCodeInfo* pCodeInfo = CreateCodeInfoFromJson(state, codeInfoJson);
 			state.SetCodeInfoForAddress(addr, pCodeInfo);
 
 			// set operand data items
@@ -174,6 +174,7 @@ bool ImportAnalysisJson(FCodeAnalysisState& state, const char* pJsonFileName)
 				pDataInfo->ByteSize = 1;
 				pDataInfo->InstructionAddress = state.AddressRefFromPhysicalAddress(addr);
 			}
+			state.UpdateCodeBitsForAddressRange(addr, pCodeInfo->ByteSize);
 		}
 	}
 
@@ -182,7 +183,7 @@ bool ImportAnalysisJson(FCodeAnalysisState& state, const char* pJsonFileName)
 		for (const auto labelInfoJson : jsonGameData["LabelInfo"])
 		{
 			const uint16_t addr = labelInfoJson["Address"];
-			FLabelInfo* pLabelInfo = CreateLabelInfoFromJson(labelInfoJson);
+			FLabelInfo* pLabelInfo = CreateLabelInfoFromJson(state, labelInfoJson);
 			state.SetLabelForPhysicalAddress(addr, pLabelInfo);
 		}
 	}
@@ -257,6 +258,8 @@ bool ImportAnalysisJson(FCodeAnalysisState& state, const char* pJsonFileName)
 		}
 	}
 
+	GenerateGlobalInfo(state);	// pages were read directly
+	state.InvalidateInstructionReferences();
 	return true;
 }
 
@@ -276,7 +279,7 @@ bool WriteDataInfoToJson(uint16_t addr, const FDataInfo* pDataInfo, json& jsonDo
 	if (pDataInfo->Flags != 0)
 		dataInfoJson["Flags"] = pDataInfo->Flags;
 	if (pDataInfo->Comment.empty() == false)
-		dataInfoJson["Comment"] = pDataInfo->Comment;
+		dataInfoJson["Comment"] = pDataInfo->Comment.Get();
 
 	// These have moved to a binary file
 	//for (const auto& read : pDataInfo->Reads.GetReferences())
@@ -317,7 +320,7 @@ void WriteCodeInfoToJson(uint16_t addr, const FCodeInfo* pCodeInfoItem, json& js
 	if (pCodeInfoItem->Flags != 0)
 		codeInfoJson["Flags"] = pCodeInfoItem->Flags;
 	if (pCodeInfoItem->Comment.empty() == false)
-		codeInfoJson["Comment"] = pCodeInfoItem->Comment;
+		codeInfoJson["Comment"] = pCodeInfoItem->Comment.Get();
 
 	jsonDoc["CodeInfo"].push_back(codeInfoJson);
 }
@@ -331,7 +334,7 @@ void WriteLabelInfoToJson(uint16_t addr, const FLabelInfo* pLabelInfo, json& jso
 		labelInfoJson["Global"] = pLabelInfo->Global;
 	labelInfoJson["LabelType"] = pLabelInfo->LabelType;
 	if (pLabelInfo->Comment.empty() == false)
-		labelInfoJson["Comment"] = pLabelInfo->Comment;
+		labelInfoJson["Comment"] = pLabelInfo->Comment.Get();
 
 	// These have moved to a binary file
 	//for (const auto& reference : pLabelInfo->References.GetReferences())
@@ -347,7 +350,7 @@ void WriteCommentBlockToJson(uint16_t addr, const FCommentBlock* pCommentBlock,
 
 	json commentBlockJson;
 	commentBlockJson["Address"] = addressOverride == -1 ? addr : addressOverride;
-	commentBlockJson["Comment"] = pCommentBlock->Comment;
+	commentBlockJson["Comment"] = pCommentBlock->Comment.Get();
 
 	jsonDoc["CommentBlocks"].push_back(commentBlockJson);
 }
@@ -392,17 +395,17 @@ void WriteAddressRangeToJson(FCodeAnalysisState& state, int startAddress, int en
 }
 #endif
 
-FCommentBlock* CreateCommentBlockFromJson(const json& commentBlockJson)
+FCommentBlock* CreateCommentBlockFromJson(FCodeAnalysisState& state, const json& commentBlockJson)
 {
-	FCommentBlock* pCommentBlock = FCommentBlock::Allocate();
+	FCommentBlock* pCommentBlock = FCommentBlock::Allocate(state);
 	//pCommentBlock->Address = commentBlockJson["Address"];
-	pCommentBlock->Comment = commentBlockJson["Comment"];
+	pCommentBlock->Comment = commentBlockJson["Comment"].get<std::string>();
 	return pCommentBlock;
 }
 
-FCodeInfo* CreateCodeInfoFromJson(const json& codeInfoJson)
+FCodeInfo* CreateCodeInfoFromJson(FCodeAnalysisState& state, const json& codeInfoJson)
 {
-	FCodeInfo* pCodeInfo = FCodeInfo::Allocate();
+	FCodeInfo* pCodeInfo = FCodeInfo::Allocate(state);
 	pCodeInfo->ByteSize = codeInfoJson["ByteSize"];
 
 	if (codeInfoJson.contains("SMC"))
@@ -415,14 +418,14 @@ FCodeInfo* CreateCodeInfoFromJson(const json& codeInfoJson)
 		pCodeInfo->Flags = codeInfoJson["Flags"];
 
 	if (codeInfoJson.contains("Comment"))
-		pCodeInfo->Comment = codeInfoJson["Comment"];
+		pCodeInfo->Comment = codeInfoJson["Comment"].get<std::string>();
 
 	return pCodeInfo;
 }
 
-FLabelInfo* CreateLabelInfoFromJson(const json& labelInfoJson)
+FLabelInfo* CreateLabelInfoFromJson(FCodeAnalysisState& state, const json& labelInfoJson)
 {
-	FLabelInfo* pLabelInfo = FLabelInfo::Allocate();
+	FLabelInfo* pLabelInfo = FLabelInfo::Allocate(state);
 
 	pLabelInfo->Name = labelInfoJson["Name"];
 	if (labelInfoJson.contains("Global"))
@@ -431,7 +434,7 @@ FLabelInfo* CreateLabelInfoFromJson(const json& labelInfoJson)
 	if (labelInfoJson.contains("LabelType"))
 		pLabelInfo->LabelType = (ELabelType)(int)labelInfoJson["LabelType"];
 	if (labelInfoJson.contains("Comment"))
-		pLabelInfo->Comment = labelInfoJson["Comment"];
+		pLabelInfo->Comment = labelInfoJson["Comment"].get<std::string>();
 
 	// Moved to binary file
 	/*if (labelInfoJson.contains("References"))
@@ -460,7 +463,7 @@ void LoadDataInfoFromJson(FCodeAnalysisState& state, FDataInfo* pDataInfo, const
 	if (dataInfoJson.contains("Flags"))
 		pDataInfo->Flags = dataInfoJson["Flags"];
 	if (dataInfoJson.contains("Comment"))
-		pDataInfo->Comment = dataInfoJson["Comment"];
+		pDataInfo->Comment = dataInfoJson["Comment"].get<std::string>();
 
 	// Moved to binary file
 	/*
@@ -544,7 +547,7 @@ void ReadPageFromJson(FCodeAnalysisState &state, FCodeAnalysisPage& page, const
 		for (const auto commentBlockJson : jsonDoc["CommentBlocks"])
 		{
 			const uint16_t pageAddr = commentBlockJson["Address"];
-			FCommentBlock* pCommentBlock = CreateCommentBlockFromJson(commentBlockJson);
+			FCommentBlock* pCommentBlock = CreateCommentBlockFromJson(state, commentBlockJson);
 			page.CommentBlocks[pageAddr] = pCommentBlock;
 		}
 	}
@@ -554,8 +557,8 @@ void ReadPageFromJson(FCodeAnalysisState &state, FCodeAnalysisPage& page, const
 		for (const auto labelInfoJson : jsonDoc["LabelInfo"])
 		{
 			const uint16_t pageAddr = labelInfoJson["Address"];
-			FLabelInfo* pLabelInfo = CreateLabelInfoFromJson(labelInfoJson);
-			page.Labels[pageAddr] = pLabelInfo;
+			FLabelInfo* pLabelInfo = CreateLabelInfoFromJson(state, labelInfoJson);
+			page.SetLabel(pageAddr, pLabelInfo);
 		}
 	}
 
@@ -564,7 +567,7 @@ void ReadPageFromJson(FCodeAnalysisState &state, FCodeAnalysisPage& page, const
 		for (const auto codeInfoJson : jsonDoc["CodeInfo"])
 		{
 			const uint16_t pageAddr = codeInfoJson["Address"];
-			FCodeInfo* pCodeInfo = CreateCodeInfoFromJson(codeInfoJson);
+			FCodeInfo* pCodeInfo = CreateCodeInfoFromJson(state, codeInfoJson);
 			page.CodeInfo[pageAddr] = pCodeInfo;
 		}
 	}
@@ -578,4 +581,6 @@ void ReadPageFromJson(FCodeAnalysisState &state, FCodeAnalysisPage& page, const
 			LoadDataInfoFromJson(state, pDataInfo, dataInfoJson);
 		}
 	}
+
+	page.RebuildCodeBits();
 }
\ No newline at end of file
@@ -3,85 +3,156 @@
 
 #include "Util/MemoryBuffer.h"
 #include "Util/GraphicsView.h"
+#include "Util/Misc.h"
 #include <cassert>
 #include <string.h>
 
 //#include "json.hpp"
-std::vector<FCodeInfo*>		FCodeInfo::AllocatedList;
-std::vector<FLabelInfo*>	FLabelInfo::AllocatedList;
-std::vector<FCommentBlock*>	FCommentBlock::AllocatedList;
-
-std::vector<FCommentLine*>	FCommentLine::AllocatedList;
-std::vector<FCommentLine*>	FCommentLine::FreeList;
 
 FImageData::~FImageData() 
 { 
 	delete GraphicsView; 
 }
 
-FCodeInfo* FCodeInfo::Allocate()
+std::string& FItemComment::Edit()
 {
-	FCodeInfo* pCodeInfo = new FCodeInfo;
-	AllocatedList.push_back(pCodeInfo);
-	return pCodeInfo;
+	if (pText == nullptr)
+		pText = std::make_unique<std::string>();
+	return *pText;
 }
 
-void FCodeInfo::FreeAll()
+void FItemComment::Set(const std::string& text)
 {
-	for (auto it : AllocatedList)
-		delete it;
+	if (text.empty())
+		pText.reset();
+	else
+		Edit() = text;
+}
 
-	AllocatedList.clear();
+FItemReferenceTracker& FItemReferenceTracker::operator=(const FItemReferenceTracker& other)
+{
+	if (this == &other)
+		return *this;
+
+	for (int i = 0; i < other.NoInlineReferences; i++)
+		InlineReferences[i] = other.InlineReferences[i];
+	NoInlineReferences = other.NoInlineReferences;
+	NoOverflowedAccesses = other.NoOverflowedAccesses;
+	pLargeSet.reset(other.pLargeSet != nullptr ? new FLargeSet(*other.pLargeSet) : nullptr);
+	return *this;
 }
 
-FLabelInfo* FLabelInfo::Allocate()
+void FItemReferenceTracker::RegisterLargeSetAccess(const FAddressRef& addrRef)
 {
-	FLabelInfo* pLabelInfo = new FLabelInfo;
-	AllocatedList.push_back(pLabelInfo);
-	return pLabelInfo;
+	if (pLargeSet->ReferenceSet.count(addrRef.Val) != 0)
+		return;
+
+	if ((int)pLargeSet->References.size() >= kMaxReferences)
+	{
+		NoOverflowedAccesses++;
+		return;
+	}
+
+	pLargeSet->ReferenceSet.insert(addrRef.Val);
+	pLargeSet->References.push_back(addrRef);
 }
 
-void FLabelInfo::FreeAll()
+// Move the inline references to a large set, keeping their order
+void FItemReferenceTracker::SpillToLargeSet(const FAddressRef& addrRef)
 {
-	for (auto it : AllocatedList)
-		delete it;
+	pLargeSet = std::make_unique<FLargeSet>();
+	pLargeSet->References.reserve(kNoInlineReferences * 4);
+	for (int i = 0; i < NoInlineReferences; i++)
+	{
+		pLargeSet->References.push_back(InlineReferences[i]);
+		pLargeSet->ReferenceSet.insert(InlineReferences[i].Val);
+	}
+	NoInlineReferences = 0;
 
-	AllocatedList.clear();
+	RegisterLargeSetAccess(addrRef);
 }
 
-FCommentBlock* FCommentBlock::Allocate()
+// Items live in slab arenas owned by the analysis state that allocated them so each state frees only its own
+// Freed items are recycled by the arena, FreeAll() destroys all of them but keeps the arena's memory for the next analysis
+
+FCodeInfo* FCodeInfo::Allocate(FCodeAnalysisState& state)
 {
-	FCommentBlock* pCommentBlock = new FCommentBlock;
-	AllocatedList.push_back(pCommentBlock);
-	return pCommentBlock;
+	return state.CodeInfoArena.Allocate();
 }
 
-void FCommentBlock::FreeAll()
+void FCodeInfo::Free(FCodeAnalysisState& state, FCodeInfo* pCodeInfo)
 {
-	for (auto it : AllocatedList)
-		delete it;
+	state.CodeInfoArena.Free(pCodeInfo);
+}
 
-	AllocatedList.clear();
+void FCodeInfo::FreeAll(FCodeAnalysisState& state)
+{
+	state.CodeInfoArena.Reset();
+}
+
+FLabelInfo* FLabelInfo::Allocate(FCodeAnalysisState& state)
+{
+	return state.LabelArena.Allocate();
+}
+
+void FLabelInfo::Free(FCodeAnalysisState& state, FLabelInfo* pLabelInfo)
+{
+	state.LabelArena.Free(pLabelInfo);
 }
 
-FCommentLine* FCommentLine::Allocate()
+void FLabelInfo::FreeAll(FCodeAnalysisState& state)
 {
-	if (FreeList.size() == 0)
-		FreeList.push_back(new FCommentLine);
+	state.LabelArena.Reset();
+}
+
+FCommentBlock* FCommentBlock::Allocate(FCodeAnalysisState& state)
+{
+	return state.CommentBlockArena.Allocate();
+}
+
+void FCommentBlock::Free(FCodeAnalysisState& state, FCommentBlock* pCommentBlock)
+{
+	state.CommentBlockArena.Free(pCommentBlock);
+}
+
+void FCommentBlock::FreeAll(FCodeAnalysisState& state)
+{
+	state.CommentBlockArena.Reset();
+}
+
+// Comment lines are recycled - AllocatedCommentLines holds every line created, FreeCommentLines the ones not in use
+FCommentLine* FCommentLine::Allocate(FCodeAnalysisState& state)
+{
+	if (state.FreeCommentLines.size() == 0)
+	{
+		FCommentLine* pNewLine = new FCommentLine;
+		state.AllocatedCommentLines.push_back(pNewLine);
+		return pNewLine;
+	}
 	
-	FCommentLine* pLine = FreeList.back();
-	AllocatedList.push_back(pLine);
-	FreeList.pop_back();
+	FCommentLine* pLine = state.FreeCommentLines.back();
+	state.FreeCommentLines.pop_back();
 
 	return pLine;
 }
 
-void FCommentLine::FreeAll()
+void FCommentLine::Free(FCodeAnalysisState& state, FCommentLine* pLine)
 {
-	for (auto it : AllocatedList)
-		FreeList.push_back(it);
+	state.FreeCommentLines.push_back(pLine);
+}
+
+void FCommentLine::FreeAll(FCodeAnalysisState& state)
+{
+	state.FreeCommentLines = state.AllocatedCommentLines;
+}
+
+void FCommentLine::DeleteAll(FCodeAnalysisState& state)
+{
+	for (auto it : state.AllocatedCommentLines)
+		delete it;
 
-	AllocatedList.clear();
+	state.AllocatedCommentLines.clear();
+	state.FreeCommentLines.clear();
 }
 
 
@@ -91,6 +162,7 @@ void FCodeAnalysisPage::Initialise()
 	
 	memset(Labels, 0, sizeof(Labels));
 	memset(CodeInfo, 0, sizeof(CodeInfo));
+	memset(CodeBits, 0, sizeof(CodeBits));
 	memset(CommentBlocks, 0, sizeof(CommentBlocks));
 
 	for (int addr = 0; addr < FCodeAnalysisPage::kPageSize; addr++)
@@ -99,15 +171,41 @@ void FCodeAnalysisPage::Initialise()
 		FDataInfo& dataInfo = DataInfo[addr];
 		dataInfo.ByteSize = 1;
 		dataInfo.DataType = EDataType::Byte;
+
+		ReadCount[addr] = 0;
+		LastFrameRead[addr] = -1;
+		WriteCount[addr] = 0;
+		LastFrameWritten[addr] = -1;
+		LastFrameExecuted[addr] = -1;
+		LastWriter[addr] = FAddressRef();
 	}
+
+	DataReads.clear();
+	DataWrites.clear();
 }
 
 
+// Scans the label bitmap back from pageAddr a word at a time
+int FCodeAnalysisPage::FindLabelAtOrBefore(uint16_t pageAddr) const
+{
+	int wordNo = pageAddr >> 6;
+	uint64_t bits = LabelBits[wordNo] & ((2ull << (pageAddr & 63)) - 1);	// mask off bits after pageAddr
+
+	while (bits == 0)
+	{
+		if (--wordNo < 0)
+			return -1;
+		bits = LabelBits[wordNo];
+	}
+
+	return (wordNo << 6) + HighestSetBit(bits);
+}
+
 void FCodeAnalysisPage::Reset(void)
 {
 	for (int addr = 0; addr < FCodeAnalysisPage::kPageSize; addr++)
 	{
-		Labels[addr] = nullptr;
+		SetLabel(addr, nullptr);
 		CommentBlocks[addr] = nullptr;
 		CodeInfo[addr] = nullptr;
 		DataInfo[addr].Reset();
@@ -117,6 +215,12 @@ void FCodeAnalysisPage::Reset(void)
 	Initialise();
 }
 
+void FCodeAnalysisPage::RebuildCodeBits()
+{
+	for (int addr = 0; addr < FCodeAnalysisPage::kPageSize; addr++)
+		UpdateCodeBit(addr);
+}
+
 static const uint32_t kMagic = 0xc0de;
 static const uint32_t kVersionNo = 2;
 
@@ -293,17 +397,18 @@ bool FCodeAnalysisPage::ReadFromBuffer(FMemoryBuffer& buffer)
 }
 #endif
 
-void FCodeAnalysisPage::SetLabelAtAddress(const char* pLabelName, ELabelType type, uint16_t addr)
+void FCodeAnalysisPage::SetLabelAtAddress(FCodeAnalysisState& state, const char* pLabelName, ELabelType type, uint16_t addr)
 {
 	FLabelInfo* pLabel = Labels[addr];
 	if (pLabel == nullptr)
 	{
-		pLabel = FLabelInfo::Allocate();
-		Labels[addr] = pLabel;
+		pLabel = FLabelInfo::Allocate(state);
+		SetLabel(addr, pLabel);
 	}
 
 	pLabel->Name = pLabelName;
 	pLabel->LabelType = type;
+	state.UpdateGlobalLabelForPage(this, addr);
 }
 
 
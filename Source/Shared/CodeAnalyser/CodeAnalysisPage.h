@@ -3,13 +3,18 @@
 #include <cstdint>
 #include <string>
 //#include <map>
+#include <memory>
+#include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
 #include <Util/Misc.h>
+#include <Util/SlabArena.h>
 
 #include "CodeAnalyserTypes.h"
 
 class FMemoryBuffer;
+class FCodeAnalysisState;
 
 // don't change order or you'll mess up the load/save
 enum class ELabelType
@@ -46,10 +51,42 @@ enum class EOperandType
 
 
 
+// Comment text for an item
+// Most items - especially the per-byte data items - never have a comment so the string is only allocated when there's text.
+class FItemComment
+{
+public:
+	FItemComment() = default;
+	FItemComment(const FItemComment& other) { Set(other.Get()); }
+	FItemComment(FItemComment&& other) = default;
+	FItemComment& operator=(const FItemComment& other) { if (this != &other) Set(other.Get()); return *this; }
+	FItemComment& operator=(FItemComment&& other) = default;
+	FItemComment& operator=(const std::string& text) { Set(text); return *this; }
+	FItemComment& operator=(const char* pText) { Set(pText); return *this; }
+	FItemComment& operator+=(const std::string& text) { if (text.empty() == false) Edit() += text; return *this; }
+
+	operator const std::string&() const { return Get(); }
+	const std::string&	Get() const { return pText != nullptr ? *pText : kNoComment; }
+	std::string&		Edit();	// for code that needs the string itself e.g. text input, creates it if needed
+
+	bool		empty() const { return pText == nullptr || pText->empty(); }
+	size_t		size() const { return pText != nullptr ? pText->size() : 0; }
+	const char* c_str() const { return Get().c_str(); }
+	char		back() const { return Get().back(); }
+	std::string	substr(size_t pos = 0, size_t count = std::string::npos) const { return Get().substr(pos, count); }
+	void		clear() { pText.reset(); }
+
+private:
+	void	Set(const std::string& text);
+
+	std::unique_ptr<std::string>	pText;
+	inline static const std::string	kNoComment;
+};
+
 struct FItem
 {
 	EItemType		Type = EItemType::Unknown;
-	std::string		Comment;
+	FItemComment	Comment;
 	uint16_t		ByteSize = 0;
 };
 
@@ -65,56 +102,120 @@ struct FItem
 	//int16_t		InstructionPageId = 0;
 };*/
 
+// Set of instruction addresses that have accessed an item, in the order they were first registered
+// Small sets are stored inline & searched linearly, larger sets spill to a vector with a hash set for the duplicate check.
+// Sets are capped at kMaxReferences - accesses from further instructions are counted but not stored.
 class FItemReferenceTracker
 {
 public:
-	void Reset() { References.clear(); }
+	static constexpr int kNoInlineReferences = 4;
+	static constexpr int kMaxReferences = 1024;
+
+	// iterable view over the stored references, returned by GetReferences()
+	// pointer pair rather than std::span as the shared code also builds as C++17
+	struct FReferenceRange
+	{
+		const FAddressRef* begin() const { return pBegin; }
+		const FAddressRef* end() const { return pEnd; }
+		size_t size() const { return pEnd - pBegin; }
+		bool empty() const { return pBegin == pEnd; }
+
+		const FAddressRef*	pBegin;
+		const FAddressRef*	pEnd;
+	};
+
+	FItemReferenceTracker() = default;
+	FItemReferenceTracker(const FItemReferenceTracker& other) { *this = other; }
+	FItemReferenceTracker& operator=(const FItemReferenceTracker& other);
+	FItemReferenceTracker(FItemReferenceTracker&& other) noexcept = default;
+	FItemReferenceTracker& operator=(FItemReferenceTracker&& other) noexcept = default;
+
+	void Reset() { NoInlineReferences = 0; NoOverflowedAccesses = 0; pLargeSet.reset(); }
 	
 	void	RegisterAccess(const FAddressRef& addrRef)
 	{
-		const auto size = References.size();
-		for (int i = 0; i < size; i++)
+		if (pLargeSet != nullptr)
+		{
+			RegisterLargeSetAccess(addrRef);
+			return;
+		}
+
+		for (int i = 0; i < NoInlineReferences; i++)
 		{
-			if (References[i] == addrRef)
+			if (InlineReferences[i] == addrRef)
 				return;
 		}
 
-		References.emplace_back(addrRef);
+		if (NoInlineReferences < kNoInlineReferences)
+			InlineReferences[NoInlineReferences++] = addrRef;
+		else
+			SpillToLargeSet(addrRef);
+	}
+
+	bool IsEmpty() const { return NoInlineReferences == 0 && pLargeSet == nullptr; }
+	int GetNoReferences() const { return pLargeSet != nullptr ? (int)pLargeSet->References.size() : NoInlineReferences; }
+	FReferenceRange GetReferences() const
+	{
+		if (pLargeSet != nullptr)
+			return { pLargeSet->References.data(), pLargeSet->References.data() + pLargeSet->References.size() };
+		return { InlineReferences, InlineReferences + NoInlineReferences };
 	}
+	int GetNoOverflowedAccesses() const { return NoOverflowedAccesses; }	// accesses not stored because the set was full
 
-	bool IsEmpty() const { return References.empty(); }
-	const std::vector<FAddressRef>& GetReferences() const { return References; }
 private:
-	std::vector<FAddressRef>	References;
+	struct FLargeSet
+	{
+		std::vector<FAddressRef>		References;	// in registration order
+		std::unordered_set<uint32_t>	ReferenceSet;	// FAddressRef::Val of each reference
+	};
+
+	void	RegisterLargeSetAccess(const FAddressRef& addrRef);
+	void	SpillToLargeSet(const FAddressRef& addrRef);
+
+	FAddressRef					InlineReferences[kNoInlineReferences];
+	int							NoInlineReferences = 0;
+	int							NoOverflowedAccesses = 0;
+	std::unique_ptr<FLargeSet>	pLargeSet;
 };
 
 struct FLabelInfo : FItem
 {
-	static FLabelInfo* Allocate();
-	static void FreeAll();
+	static FLabelInfo* Allocate(FCodeAnalysisState& state);
+	static void Free(FCodeAnalysisState& state, FLabelInfo* pLabelInfo);
+	static void FreeAll(FCodeAnalysisState& state);
 
 	std::string				Name;
-	bool					Global = false;
+	bool					Global = false;	// change with FCodeAnalysisState::SetLabelGlobal() once the label is set so the global labels are updated
 	ELabelType				LabelType = ELabelType::Data;
 	FItemReferenceTracker	References;
 	//std::map<uint16_t, int>	References;
 private:
+	template <class, int> friend class FSlabArena;
 	FLabelInfo() { Type = EItemType::Label; }
 	~FLabelInfo() = default;
+};
 
-	static std::vector<FLabelInfo*>	AllocatedList;
+// Instruction decoded on its first execution so it doesn't have to be decoded every time it runs - see AnalyseAtPC()
+// Not saved - it's invalidated when the instruction's bytes are written to
+struct FDecodedInstruction
+{
+	uint16_t	JumpAddress = 0;	// physical addresses
+	uint16_t	PointerAddress = 0;
+	uint32_t	ReferenceGeneration = 0;	// FCodeAnalysisState::GetReferenceGeneration() when label references were last registered
+	bool		bValid = false;
+	bool		bJump = false;
+	bool		bPointer = false;
 };
 
 struct FCodeInfo : FItem
 {
-	static FCodeInfo* Allocate();
-	static void FreeAll();
+	static FCodeInfo* Allocate(FCodeAnalysisState& state);
+	static void Free(FCodeAnalysisState& state, FCodeInfo* pCodeInfo);
+	static void FreeAll(FCodeAnalysisState& state);
 
-	EOperandType	OperandType = EOperandType::Unknown;
-	std::string		Text;				// Disassembly text
+	EOperandType	OperandType = EOperandType::Unknown;	// disassembly text is generated on demand, see GetDisassemblyText()
 	FAddressRef		JumpAddress;	// optional jump address
 	FAddressRef		PointerAddress;	// optional pointer address
-	int				FrameLastExecuted = -1;
 	int				ExecutionCount = 0;
 
 	union
@@ -131,11 +232,12 @@ struct FCodeInfo : FItem
 
 	bool	bNOPped = false;
 	uint8_t	OpcodeBkp[4] = { 0 };
+
+	FDecodedInstruction	Decoded;
 private:
+	template <class, int> friend class FSlabArena;
 	FCodeInfo() :FItem(){Type = EItemType::Code;	}
 	~FCodeInfo() = default;
-
-	static std::vector<FCodeInfo*>	AllocatedList;
 };
 
 
@@ -187,12 +289,6 @@ struct FDataInfo : FItem
 		DataType = EDataType::Byte;
 		OperandType = EOperandType::Unknown;
 		Comment.clear();
-		ReadCount = 0;
-		LastFrameRead = -1;
-		Reads.Reset();
-		WriteCount = 0;
-		LastFrameWritten = -1;
-		Writes.Reset();
 	}
 
 	EDataType	DataType = EDataType::Byte;
@@ -223,40 +319,32 @@ struct FDataInfo : FItem
 	};
 	uint8_t		EmptyCharNo = 0;
 
-	// Reads
-	int						ReadCount = 0;
-	int						LastFrameRead = -1;
-	FItemReferenceTracker	Reads;	// address and counts of data access instructions
-
-	// Writes
-	int						WriteCount = 0;
-	int						LastFrameWritten = -1;
-	FItemReferenceTracker	Writes;	// address and counts of data access instructions
-	FAddressRef				LastWriter;
+	// Access counts, frame numbers & references are kept by the page, see FCodeAnalysisPage.
+	// The item fields stay inline as item lists, commands & the UI hold FItem/FDataInfo pointers - the comment is only allocated when set, see FItemComment.
 };
 
 struct FCommentBlock : FItem
 {
-	static FCommentBlock* Allocate();
-	static void FreeAll();
+	static FCommentBlock* Allocate(FCodeAnalysisState& state);
+	static void Free(FCodeAnalysisState& state, FCommentBlock* pCommentBlock);
+	static void FreeAll(FCodeAnalysisState& state);
 
 private:
+	template <class, int> friend class FSlabArena;
 	FCommentBlock() : FItem() { Type = EItemType::CommentBlock; }
 	~FCommentBlock() = default;
-	static std::vector<FCommentBlock*>	AllocatedList;
 };
 
 struct FCommentLine : FItem
 {
 
-	static FCommentLine* Allocate();
-	static void FreeAll();
+	static FCommentLine* Allocate(FCodeAnalysisState& state);
+	static void Free(FCodeAnalysisState& state, FCommentLine* pLine);
+	static void FreeAll(FCodeAnalysisState& state);
+	static void DeleteAll(FCodeAnalysisState& state);	// FreeAll() recycles lines, this frees them
 private:
 	FCommentLine() : FItem() { Type = EItemType::CommentLine; }
 	~FCommentLine() = default;
-
-	static std::vector<FCommentLine*>	AllocatedList;
-	static std::vector<FCommentLine*>	FreeList;
 };
 
 // abstract machine state class - device specific
@@ -272,17 +360,88 @@ struct FCodeAnalysisPage
 	//void WriteToBuffer(FMemoryBuffer& buffer);
 	//bool ReadFromBuffer(FMemoryBuffer& buffer);
 
-	void SetLabelAtAddress(const char* pLabelName, ELabelType type, uint16_t addr);
+	void SetLabelAtAddress(FCodeAnalysisState& state, const char* pLabelName, ELabelType type, uint16_t addr);
+
+	void	SetLabel(uint16_t pageAddr, FLabelInfo* pLabel)
+	{
+		Labels[pageAddr] = pLabel;
+		const uint64_t bit = 1ull << (pageAddr & 63);
+		if (pLabel != nullptr)
+			LabelBits[pageAddr >> 6] |= bit;
+		else
+			LabelBits[pageAddr >> 6] &= ~bit;
+	}
+	int		FindLabelAtOrBefore(uint16_t pageAddr) const;	// returns page address of nearest label, -1 if there isn't one
+
+	// 'is code' bitmap - bit set for each address that's part of an instruction, opcode or operand
+	// Writes check this before looking at the data info for self modifying code.
+	// Bits can be left set on bytes that have been reformatted as data, so it's a superset of the code.
+	bool	IsCode(uint16_t pageAddr) const { return (CodeBits[pageAddr >> 6] >> (pageAddr & 63)) & 1; }
+	void	SetIsCode(uint16_t pageAddr, bool bCode)
+	{
+		const uint64_t bit = 1ull << (pageAddr & 63);
+		if (bCode)
+			CodeBits[pageAddr >> 6] |= bit;
+		else
+			CodeBits[pageAddr >> 6] &= ~bit;
+	}
+	void	UpdateCodeBit(uint16_t pageAddr) { SetIsCode(pageAddr, CodeInfo[pageAddr] != nullptr || DataInfo[pageAddr].DataType == EDataType::InstructionOperand); }
+	void	RebuildCodeBits();
+	const uint64_t*	GetCodeBits() const { return CodeBits; }	// kPageSize bits
+
 	static const int kPageSize = 1024;	// 1Kb page
 	static const int kPageShift = 10;	// 1Kb page
 	static const int kPageMask = kPageSize - 1;
 
 	bool			bUsed = false;	// has this page been used?
 	int16_t			PageId = -1;
-	FLabelInfo*		Labels[kPageSize];
+	FLabelInfo*		Labels[kPageSize];	// write with SetLabel() so the label bitmap is kept up to date
 	FCodeInfo*		CodeInfo[kPageSize];
 	FDataInfo		DataInfo[kPageSize];
 	FCommentBlock*	CommentBlocks[kPageSize];
 
 	FMachineState*	MachineState[kPageSize];
+
+	// Data access info for each byte in the page
+	// Counts & frame numbers are dense arrays as they're updated on every access & scanned by the memory views - see GetPageHeatmapColours().
+	// Most bytes are never accessed so reference lists are kept in sparse tables keyed by page address.
+	int32_t			ReadCount[kPageSize];
+	int32_t			LastFrameRead[kPageSize];
+	int32_t			WriteCount[kPageSize];
+	int32_t			LastFrameWritten[kPageSize];
+	int32_t			LastFrameExecuted[kPageSize];	// set at the first byte of each executed instruction
+	FAddressRef		LastWriter[kPageSize];
+
+	const FItemReferenceTracker& GetDataReads(uint16_t pageAddr) const { return FindDataReferences(DataReads, pageAddr); }
+	const FItemReferenceTracker& GetDataWrites(uint16_t pageAddr) const { return FindDataReferences(DataWrites, pageAddr); }
+	// only call these when there's an access to register - an entry is created for the address
+	FItemReferenceTracker& GetOrCreateDataReads(uint16_t pageAddr) { return FindOrAddDataReferences(DataReads, pageAddr); }
+	FItemReferenceTracker& GetOrCreateDataWrites(uint16_t pageAddr) { return FindOrAddDataReferences(DataWrites, pageAddr); }
+	void	ResetDataReads(uint16_t pageAddr) { DataReads.erase(pageAddr); }
+	void	ResetDataWrites(uint16_t pageAddr) { DataWrites.erase(pageAddr); }
+	void	ResetDataReferences(uint16_t pageAddr) { ResetDataReads(pageAddr); ResetDataWrites(pageAddr); }
+	size_t	GetNoDataReferenceEntries() const { return DataReads.size() + DataWrites.size(); }
+
+	inline static const FItemReferenceTracker	kNoReferences;	// returned for bytes that have never been accessed
+
+private:
+	typedef std::unordered_map<uint16_t, FItemReferenceTracker>	FDataReferenceTable;
+
+	static const FItemReferenceTracker& FindDataReferences(const FDataReferenceTable& table, uint16_t pageAddr)
+	{
+		const auto it = table.find(pageAddr);
+		return it != table.end() ? it->second : kNoReferences;
+	}
+
+	static FItemReferenceTracker& FindOrAddDataReferences(FDataReferenceTable& table, uint16_t pageAddr)
+	{
+		const auto it = table.find(pageAddr);	// most accesses are to bytes that already have an entry
+		return it != table.end() ? it->second : table.emplace(pageAddr, FItemReferenceTracker()).first->second;
+	}
+
+	FDataReferenceTable	DataReads;
+	FDataReferenceTable	DataWrites;
+
+	uint64_t	LabelBits[kPageSize / 64] = {};	// bit set for each address with a label, for nearest label searches
+	uint64_t	CodeBits[kPageSize / 64] = {};	// see IsCode()
 };
\ No newline at end of file
@@ -39,29 +39,32 @@ void WritePageState(const FCodeAnalysisPage& page, FILE* fp)
 		if (pCodeInfoItem == nullptr || pCodeInfoItem->bSelfModifyingCode == true)
 		{
 			const FDataInfo* pDataInfo = &page.DataInfo[pageAddr];
+			const FItemReferenceTracker& reads = page.GetDataReads(pageAddr);
+			const FItemReferenceTracker& writes = page.GetDataWrites(pageAddr);
+			const FAddressRef& lastWriter = page.LastWriter[pageAddr];
 
 			// check if we need to write
-			if (pDataInfo->Reads.GetReferences().empty() == false ||
-				pDataInfo->Writes.GetReferences().empty() == false ||
-				pDataInfo->LastWriter.IsValid())
+			if (reads.GetReferences().empty() == false ||
+				writes.GetReferences().empty() == false ||
+				lastWriter.IsValid())
 			{
 				const uint16_t itemId = pageAddr | kDataId;
 				fwrite(&itemId, sizeof(itemId), 1, fp);
 
 				// Reads
-				tempU16 = (uint16_t)pDataInfo->Reads.GetReferences().size();
+				tempU16 = (uint16_t)reads.GetReferences().size();
 				fwrite(&tempU16, sizeof(tempU16), 1, fp);
-				for (const auto& read : pDataInfo->Reads.GetReferences())
+				for (const auto& read : reads.GetReferences())
 					fwrite(&read.Val, sizeof(read.Val), 1, fp);
 
 				// Writes
-				tempU16 = (uint16_t)pDataInfo->Writes.GetReferences().size();
+				tempU16 = (uint16_t)writes.GetReferences().size();
 				fwrite(&tempU16, sizeof(tempU16), 1, fp);
-				for (const auto& write : pDataInfo->Writes.GetReferences())
+				for (const auto& write : writes.GetReferences())
 					fwrite(&write.Val, sizeof(write.Val), 1, fp);
 
 				// Last Writer
-				fwrite(&pDataInfo->LastWriter.Val, sizeof(pDataInfo->LastWriter), 1, fp);
+				fwrite(&lastWriter.Val, sizeof(lastWriter), 1, fp);
 			}
 
 			pageAddr += pDataInfo->ByteSize;
@@ -105,31 +108,30 @@ void ReadPageState(FCodeAnalysisPage& page, FILE* fp)
 		}
 		else if (itemId & kDataId)
 		{
-			FDataInfo& dataItem = page.DataInfo[pageAddr];
 			uint16_t count;
 
-			// Reads
+			// Reads - the sparse tables only get entries for addresses with references
 			fread(&count, sizeof(count), 1, fp);
-			dataItem.Reads.Reset();
+			page.ResetDataReads(pageAddr);
 			for (int i = 0; i < count; i++)
 			{
 				FAddressRef ref;
 				fread(&ref.Val, sizeof(ref.Val), 1, fp);
-				dataItem.Reads.RegisterAccess(ref);
+				page.GetOrCreateDataReads(pageAddr).RegisterAccess(ref);
 			}
 
 			// Writes
 			fread(&count, sizeof(count), 1, fp);
-			dataItem.Writes.Reset();
+			page.ResetDataWrites(pageAddr);
 			for (int i = 0; i < count; i++)
 			{
 				FAddressRef ref;
 				fread(&ref.Val, sizeof(ref.Val), 1, fp);
-				dataItem.Writes.RegisterAccess(ref);
+				page.GetOrCreateDataWrites(pageAddr).RegisterAccess(ref);
 			}
 
 			// Last Writer
-			fread(&dataItem.LastWriter.Val, sizeof(dataItem.LastWriter.Val), 1, fp);
+			fread(&page.LastWriter[pageAddr].Val, sizeof(page.LastWriter[pageAddr].Val), 1, fp);
 		}
 
 		fread(&itemId, sizeof(itemId), 1, fp);
@@ -389,6 +389,35 @@ void	FDebugger::SaveToFile(FILE* fp)
 }
 
 
+void FDebugger::ProcessCommands()
+{
+	EDebugCommand command;
+	while (CommandQueue.Pop(command))
+	{
+		switch (command)
+		{
+		case EDebugCommand::Break:
+			Break();
+			break;
+		case EDebugCommand::Continue:
+			Continue();
+			break;
+		case EDebugCommand::StepInto:
+			StepInto();
+			break;
+		case EDebugCommand::StepOver:
+			StepOver();
+			break;
+		case EDebugCommand::StepFrame:
+			StepFrame();
+			break;
+		case EDebugCommand::StepScreenWrite:
+			StepScreenWrite();
+			break;
+		}
+	}
+}
+
 void FDebugger::Break()
 { 
     StepMode = EDebugStepMode::None;
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <CodeAnalyser/CodeAnalyserTypes.h>
+#include <Util/SPSCQueue.h>
 
 #include <chips/z80.h>
 #include <chips/m6502.h>
@@ -30,6 +31,17 @@ enum class EDebugStepMode
 	NMI,
 };
 
+// Commands that can be queued from the UI
+enum class EDebugCommand : uint8_t
+{
+	Break,
+	Continue,
+	StepInto,
+	StepOver,
+	StepFrame,
+	StepScreenWrite,
+};
+
 // only add to end otherwise you'll break the file format
 enum class EBreakpointType
 {
@@ -123,6 +135,10 @@ public:
 	void	StepIOWrite();
 	void	SetPC(FAddressRef newPC) { PC = newPC; }
 
+	// Commands - queued by the UI & executed on the emulation thread with ProcessCommands()
+	bool	QueueCommand(EDebugCommand command) { return CommandQueue.Push(command); }
+	void	ProcessCommands();
+
 	// Breakpoints
 	bool	AddExecBreakpoint(FAddressRef addr);
 	bool	AddDataBreakpoint(FAddressRef addr, uint16_t size);
@@ -186,6 +202,7 @@ private:
 	bool			bDebuggerStopped = false;
 	EDebugStepMode	StepMode = EDebugStepMode::None;
 	FAddressRef		StepOverPC;
+	FSPSCQueue<EDebugCommand, 64>	CommandQueue;
 
 	std::vector<FBreakpoint>	Breakpoints;
 	uint32_t					BreakpointMask = 0;
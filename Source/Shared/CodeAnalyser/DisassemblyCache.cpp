@@ -0,0 +1,77 @@
+#include "DisassemblyCache.h"
+#include "CodeAnalysisPage.h"
+
+#include <cassert>
+
+// Key layout:
+// bits 0-15	instruction address - relative jumps are output as absolute addresses
+// bits 16-47	opcode bytes (up to 4)
+// bits 48-50	number of opcode bytes
+// bits 51-54	operand type
+// bits 55-58	number display mode
+uint64_t FDisassemblyCache::MakeKey(uint16_t pc, const uint8_t* pBytes, int noBytes, EOperandType operandType, ENumberDisplayMode displayMode)
+{
+	assert(noBytes <= 4);
+
+	uint64_t key = pc;
+	for (int i = 0; i < noBytes; i++)
+		key |= (uint64_t)pBytes[i] << (16 + (i * 8));
+	key |= (uint64_t)noBytes << 48;
+	key |= (uint64_t)((int)operandType & 0xf) << 51;
+	key |= (uint64_t)(((int)displayMode + 1) & 0xf) << 55;	// None is -1
+	return key;
+}
+
+const std::string* FDisassemblyCache::Find(uint64_t key)
+{
+	auto lookupIt = EntryLookup.find(key);
+	if (lookupIt == EntryLookup.end())
+	{
+		NoMisses++;
+		return nullptr;
+	}
+
+	NoHits++;
+	Entries.splice(Entries.begin(), Entries, lookupIt->second);	// move to front, iterators stay valid
+	return &lookupIt->second->Text;
+}
+
+const std::string& FDisassemblyCache::Add(uint64_t key, std::string&& text)
+{
+	auto lookupIt = EntryLookup.find(key);
+	if (lookupIt != EntryLookup.end())
+	{
+		lookupIt->second->Text = std::move(text);
+		Entries.splice(Entries.begin(), Entries, lookupIt->second);
+		return lookupIt->second->Text;
+	}
+
+	// evict least recently used
+	while (Entries.empty() == false && Entries.size() >= MaxEntries)
+	{
+		EntryLookup.erase(Entries.back().Key);
+		Entries.pop_back();
+	}
+
+	Entries.push_front(FEntry{ key, std::move(text) });
+	EntryLookup[key] = Entries.begin();
+	return Entries.front().Text;
+}
+
+void FDisassemblyCache::Reset()
+{
+	Entries.clear();
+	EntryLookup.clear();
+	NoHits = 0;
+	NoMisses = 0;
+}
+
+void FDisassemblyCache::SetMaxEntries(size_t maxEntries)
+{
+	MaxEntries = maxEntries > 0 ? maxEntries : 1;
+	while (Entries.size() > MaxEntries)
+	{
+		EntryLookup.erase(Entries.back().Key);
+		Entries.pop_back();
+	}
+}
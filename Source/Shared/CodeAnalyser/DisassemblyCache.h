@@ -0,0 +1,45 @@
+#pragma once
+
+#include <cstdint>
+#include <list>
+#include <string>
+#include <unordered_map>
+
+#include <Util/Misc.h>
+
+enum class EOperandType;
+
+// Bounded least recently used cache of instruction disassembly text
+// Entries are keyed on everything the text depends on (see MakeKey()) so they never need invalidating,
+// changed opcode bytes or display settings just produce a new key & old entries age out.
+class FDisassemblyCache
+{
+public:
+	static const size_t kDefaultMaxEntries = 4096;
+
+	static uint64_t	MakeKey(uint16_t pc, const uint8_t* pBytes, int noBytes, EOperandType operandType, ENumberDisplayMode displayMode);
+
+	// returned text is valid until the next Add() or Reset()
+	const std::string*	Find(uint64_t key);
+	const std::string&	Add(uint64_t key, std::string&& text);
+	void				Reset();
+
+	void	SetMaxEntries(size_t maxEntries);
+	size_t	GetMaxEntries() const { return MaxEntries; }
+	size_t	GetNoEntries() const { return Entries.size(); }
+	int		GetNoHits() const { return NoHits; }
+	int		GetNoMisses() const { return NoMisses; }
+
+private:
+	struct FEntry
+	{
+		uint64_t	Key;
+		std::string	Text;
+	};
+
+	std::list<FEntry>	Entries;	// most recently used first
+	std::unordered_map<uint64_t, std::list<FEntry>::iterator>	EntryLookup;
+	size_t	MaxEntries = kDefaultMaxEntries;
+	int		NoHits = 0;
+	int		NoMisses = 0;
+};
@@ -0,0 +1,375 @@
+// Micro-benchmarks for the code analyser primitives called from the emulation hot path
+// Runs on synthetic banks so no ROM or snapshot is needed - use it to check data structure changes against numbers
+// Usage: CodeAnalyserBench [-scale <n>] [-out <file.json>]
+// -scale multiplies the number of operations run for each benchmark
+
+#include "CodeAnalyser/CodeAnalyser.h"
+#include "CodeAnalyser/UI/CodeAnalyserUI.h"
+#include "CodeAnalyser/UI/MemoryHeatmap.h"
+
+#include <imgui.h>
+#include <chips/z80.h>
+#include "json.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <string>
+#include <vector>
+
+using json = nlohmann::json;
+
+// memory layout - like a 48K Spectrum
+static const uint16_t kDataStart = 0x4000;	// data accesses go here
+static const uint16_t kDataSize = 0x4000;
+static const uint16_t kCodeStart = 0x8000;	// synthetic code goes here
+static const uint16_t kCodeSize = 0x4000;
+static const int kBankSizeKb = 16;
+
+// stops the optimiser throwing away lookups
+static volatile uintptr_t g_BenchSink = 0;
+
+// CPU interface over a flat 64K memory
+class FBenchCPUInterface : public ICPUInterface
+{
+public:
+	FBenchCPUInterface()
+	{
+		CPUType = ECPUType::Z80;
+		memset(Memory, 0, sizeof(Memory));
+		memset(&CPU, 0, sizeof(CPU));
+	}
+
+	uint8_t		ReadByte(uint16_t address) const override { return Memory[address]; }
+	uint16_t	ReadWord(uint16_t address) const override { return Memory[address] | (Memory[(uint16_t)(address + 1)] << 8); }
+	const uint8_t* GetMemPtr(uint16_t address) const override { return &Memory[address]; }
+	void		WriteByte(uint16_t address, uint8_t value) override { Memory[address] = value; }
+	FAddressRef	GetPC(void) override { return pCodeAnalysis->AddressRefFromPhysicalAddress(CPU.pc); }
+	uint16_t	GetSP(void) override { return CPU.sp; }
+	void*		GetCPUEmulator(void) const override { return (void*)&CPU; }
+
+	uint8_t					Memory[FCodeAnalysisState::kAddressSize];
+	z80_t					CPU;
+	FCodeAnalysisState*		pCodeAnalysis = nullptr;
+};
+
+struct FBenchContext
+{
+	FBenchCPUInterface			CPUInterface;
+	FCodeAnalysisState			CodeAnalysis;
+	std::vector<uint16_t>		CodeAddresses;	// address of each synthetic instruction
+	std::vector<FAddressRef>	AllAddresses;	// every address in the address space
+};
+
+struct FBenchResult
+{
+	std::string		Name;
+	int64_t			NoOperations = 0;
+	double			Seconds = 0.0;
+};
+
+// Fill the code region with a repeating block of data accessing instructions & map the banks
+static void SetupBenchContext(FBenchContext& context)
+{
+	FBenchCPUInterface& cpuIF = context.CPUInterface;
+	FCodeAnalysisState& state = context.CodeAnalysis;
+	cpuIF.pCodeAnalysis = &state;
+
+	// LD A,(nn) / LD (nn),A / INC HL - operands spread over the data region
+	uint16_t addr = kCodeStart;
+	int blockNo = 0;
+	while (addr + 7 <= kCodeStart + kCodeSize - 3)
+	{
+		const uint16_t dataAddr = kDataStart + ((blockNo * 37) & (kDataSize - 1));
+		context.CodeAddresses.push_back(addr);
+		cpuIF.Memory[addr++] = 0x3A;
+		cpuIF.Memory[addr++] = dataAddr & 0xff;
+		cpuIF.Memory[addr++] = dataAddr >> 8;
+		context.CodeAddresses.push_back(addr);
+		cpuIF.Memory[addr++] = 0x32;
+		cpuIF.Memory[addr++] = dataAddr & 0xff;
+		cpuIF.Memory[addr++] = dataAddr >> 8;
+		context.CodeAddresses.push_back(addr);
+		cpuIF.Memory[addr++] = 0x23;
+		blockNo++;
+	}
+	// JP kCodeStart
+	context.CodeAddresses.push_back(addr);
+	cpuIF.Memory[addr++] = 0xC3;
+	cpuIF.Memory[addr++] = kCodeStart & 0xff;
+	cpuIF.Memory[addr++] = kCodeStart >> 8;
+
+	const int16_t romBank = state.CreateBank("ROM", kBankSizeKb, &cpuIF.Memory[0x0000], true);
+	const int16_t ramBank0 = state.CreateBank("RAM 0", kBankSizeKb, &cpuIF.Memory[0x4000], false);
+	const int16_t ramBank1 = state.CreateBank("RAM 1", kBankSizeKb, &cpuIF.Memory[0x8000], false);
+	const int16_t ramBank2 = state.CreateBank("RAM 2", kBankSizeKb, &cpuIF.Memory[0xc000], false);
+	state.MapBank(romBank, 0);
+	state.MapBank(ramBank0, 16);
+	state.MapBank(ramBank1, 32);
+	state.MapBank(ramBank2, 48);
+
+	state.Init(&cpuIF);
+
+	// run the code once so code info exists
+	uint16_t oldPC = context.CodeAddresses.back();
+	for (uint16_t pc : context.CodeAddresses)
+	{
+		RegisterCodeExecuted(state, pc, oldPC);
+		oldPC = pc;
+	}
+
+	// labels every 8 bytes, with some function & global data labels for GenerateGlobalInfo()
+	for (int labelAddr = kDataStart; labelAddr < FCodeAnalysisState::kAddressSize; labelAddr += 8)
+	{
+		char labelName[32];
+		snprintf(labelName, sizeof(labelName), "label_%04X", labelAddr);
+		if ((labelAddr & 0x1ff) == 0)
+			AddLabel(state, labelAddr, labelName, labelAddr >= kCodeStart ? ELabelType::Function : ELabelType::Data, true);
+		else
+			AddLabel(state, labelAddr, labelName, ELabelType::Data);
+	}
+
+	// a comment block every 256 bytes so item lists have comment lines in them
+	for (int commentAddr = kDataStart; commentAddr < FCodeAnalysisState::kAddressSize; commentAddr += 256)
+	{
+		FCommentBlock* pCommentBlock = AddCommentBlock(state, state.AddressRefFromPhysicalAddress(commentAddr));
+		pCommentBlock->Comment = "Benchmark comment\nsecond line";
+	}
+
+	for (int address = 0; address < FCodeAnalysisState::kAddressSize; address++)
+		context.AllAddresses.push_back(state.AddressRefFromPhysicalAddress(address));
+}
+
+template <typename TBenchFunc>
+static FBenchResult RunBenchmark(const char* pName, int64_t noOperations, TBenchFunc benchFunc)
+{
+	FBenchResult result;
+	result.Name = pName;
+	result.NoOperations = noOperations;
+
+	const auto startTime = std::chrono::high_resolution_clock::now();
+	benchFunc(noOperations);
+	const auto endTime = std::chrono::high_resolution_clock::now();
+	result.Seconds = std::chrono::duration<double>(endTime - startTime).count();
+
+	const double nsPerOp = noOperations > 0 ? (result.Seconds * 1000000000.0) / noOperations : 0.0;
+	printf("%-40s %12lld ops %10.2f ns/op\n", pName, (long long)noOperations, nsPerOp);
+	return result;
+}
+
+// data accesses - each address is accessed from a handful of instructions, as in real code
+static uint16_t GetBenchDataAddress(int64_t opNo)
+{
+	return kDataStart + ((opNo * 37) & (kDataSize - 1));
+}
+
+static uint16_t GetBenchAccessorPC(const FBenchContext& context, int64_t opNo)
+{
+	const int64_t accessorNo = GetBenchDataAddress(opNo) + ((opNo / kDataSize) & 3);
+	return context.CodeAddresses[accessorNo % context.CodeAddresses.size()];
+}
+
+static void RunBenchmarks(FBenchContext& context, int scale, std::vector<FBenchResult>& results)
+{
+	FCodeAnalysisState& state = context.CodeAnalysis;
+	const int64_t kNoAccesses = 4 * 1000 * 1000 * (int64_t)scale;
+	const int64_t kNoLookups = 16 * 1000 * 1000 * (int64_t)scale;
+	const int64_t kNoListUpdates = 100 * (int64_t)scale;
+
+	// untimed warm-up so reference lists are at their steady state size
+	for (int64_t opNo = 0; opNo < kDataSize * 4; opNo++)
+	{
+		RegisterDataRead(state, GetBenchAccessorPC(context, opNo), GetBenchDataAddress(opNo));
+		RegisterDataWrite(state, GetBenchAccessorPC(context, opNo), GetBenchDataAddress(opNo), (uint8_t)opNo);
+	}
+
+	results.push_back(RunBenchmark("RegisterDataRead", kNoAccesses, [&](int64_t noOps)
+	{
+		for (int64_t opNo = 0; opNo < noOps; opNo++)
+			RegisterDataRead(state, GetBenchAccessorPC(context, opNo), GetBenchDataAddress(opNo));
+	}));
+
+	results.push_back(RunBenchmark("RegisterDataWrite", kNoAccesses, [&](int64_t noOps)
+	{
+		for (int64_t opNo = 0; opNo < noOps; opNo++)
+			RegisterDataWrite(state, GetBenchAccessorPC(context, opNo), GetBenchDataAddress(opNo), (uint8_t)opNo);
+	}));
+
+	results.push_back(RunBenchmark("RegisterCodeExecuted", kNoAccesses, [&](int64_t noOps)
+	{
+		const size_t noInstructions = context.CodeAddresses.size();
+		uint16_t oldPC = context.CodeAddresses.back();
+		for (int64_t opNo = 0; opNo < noOps; opNo++)
+		{
+			const uint16_t pc = context.CodeAddresses[opNo % noInstructions];
+			RegisterCodeExecuted(state, pc, oldPC);
+			oldPC = pc;
+		}
+	}));
+
+	results.push_back(RunBenchmark("GetCodeInfoForAddress(FAddressRef)", kNoLookups, [&](int64_t noOps)
+	{
+		uintptr_t sink = 0;
+		for (int64_t opNo = 0; opNo < noOps; opNo++)
+			sink += (uintptr_t)state.GetCodeInfoForAddress(context.AllAddresses[opNo & 0xffff]);
+		g_BenchSink = sink;
+	}));
+
+	results.push_back(RunBenchmark("GetLabelForAddress", kNoLookups, [&](int64_t noOps)
+	{
+		uintptr_t sink = 0;
+		for (int64_t opNo = 0; opNo < noOps; opNo++)
+			sink += (uintptr_t)state.GetLabelForAddress(context.AllAddresses[opNo & 0xffff]);
+		g_BenchSink = sink;
+	}));
+
+	results.push_back(RunBenchmark("GetBankHeatmapColours (per byte)", kNoLookups, [&](int64_t noOps)
+	{
+		const FCodeAnalysisBank* pBank = state.GetBank(state.GetBankFromAddress(kDataStart));
+		std::vector<uint8_t> colours(pBank->GetSizeBytes());
+		for (int64_t opNo = 0; opNo < noOps; opNo += colours.size())
+		{
+			GetBankHeatmapColours(*pBank, 0, (int)colours.size(), state.CurrentFrameNo, 4, colours.data());
+			g_BenchSink = colours[opNo & (colours.size() - 1)];
+		}
+	}));
+
+	// reference trackers which already hold a number of references - the accesses are all repeats
+	for (int noRefs : { 1, 8, 64 })
+	{
+		std::vector<FAddressRef> refs;
+		FItemReferenceTracker tracker;
+		for (int refNo = 0; refNo < noRefs; refNo++)
+		{
+			refs.push_back(state.AddressRefFromPhysicalAddress(context.CodeAddresses[refNo * 3]));
+			tracker.RegisterAccess(refs.back());
+		}
+
+		char benchName[64];
+		snprintf(benchName, sizeof(benchName), "RegisterAccess (%d refs)", noRefs);
+		results.push_back(RunBenchmark(benchName, kNoLookups, [&](int64_t noOps)
+		{
+			for (int64_t opNo = 0; opNo < noOps; opNo++)
+				tracker.RegisterAccess(refs[opNo % noRefs]);
+		}));
+	}
+
+	results.push_back(RunBenchmark("UpdateItemListForBank", kNoListUpdates, [&](int64_t noOps)
+	{
+		for (int64_t opNo = 0; opNo < noOps; opNo++)
+		{
+			for (FCodeAnalysisBank& bank : state.GetBanks())
+			{
+				bank.bIsDirty = true;	// rebuild every page
+				UpdateItemListForBank(state, bank);
+			}
+		}
+	}));
+
+	results.push_back(RunBenchmark("UpdateItemListForBank (1 dirty page)", kNoListUpdates, [&](int64_t noOps)
+	{
+		for (int64_t opNo = 0; opNo < noOps; opNo++)
+		{
+			state.SetCodeAnalysisDirty(0x8000);	// as executing a new instruction does
+			for (FCodeAnalysisBank& bank : state.GetBanks())
+				UpdateItemListForBank(state, bank);
+		}
+	}));
+
+	results.push_back(RunBenchmark("GenerateGlobalInfo", kNoListUpdates, [&](int64_t noOps)
+	{
+		for (int64_t opNo = 0; opNo < noOps; opNo++)
+			GenerateGlobalInfo(state);
+	}));
+
+	results.push_back(RunBenchmark("UpdateGlobalLabel", kNoListUpdates, [&](int64_t noOps)
+	{
+		const FAddressRef labelAddr = state.AddressRefFromPhysicalAddress(kCodeStart);
+		for (int64_t opNo = 0; opNo < noOps; opNo++)
+			state.UpdateGlobalLabel(labelAddr);	// as toggling a label's Global flag does
+	}));
+
+	results.push_back(RunBenchmark("ReAnalyseCode", kNoListUpdates, [&](int64_t noOps)
+	{
+		for (int64_t opNo = 0; opNo < noOps; opNo++)
+			ReAnalyseCode(state);
+	}));
+
+	results.push_back(RunBenchmark("ResetReferenceInfo", kNoListUpdates, [&](int64_t noOps)
+	{
+		for (int64_t opNo = 0; opNo < noOps; opNo++)
+			ResetReferenceInfo(state);
+	}));
+
+	results.push_back(RunBenchmark("UnMapBank/MapBank", kNoAccesses, [&](int64_t noOps)
+	{
+		const int16_t bankId = state.GetBankFromAddress(0xc000);
+		for (int64_t opNo = 0; opNo < noOps; opNo++)
+		{
+			state.UnMapBank(bankId, 48);	// as a 128K bank switch does
+			state.MapBank(bankId, 48);
+		}
+		state.ClearRemappings();
+	}));
+}
+
+static bool WriteResultsJson(const std::vector<FBenchResult>& results, const char* pFileName)
+{
+	json jsonResults;
+
+	for (const FBenchResult& result : results)
+	{
+		json resultJson;
+		resultJson["Name"] = result.Name;
+		resultJson["Operations"] = result.NoOperations;
+		resultJson["Seconds"] = result.Seconds;
+		resultJson["NanoSecondsPerOperation"] = result.NoOperations > 0 ? (result.Seconds * 1000000000.0) / result.NoOperations : 0.0;
+		jsonResults["Results"].push_back(resultJson);
+	}
+
+	std::ofstream outFileStream(pFileName);
+	if (outFileStream.is_open() == false)
+		return false;
+
+	outFileStream << std::setw(4) << jsonResults << std::endl;
+	return true;
+}
+
+int main(int argc, char** argv)
+{
+	int scale = 1;
+	std::string outFile;
+
+	for (int arg = 1; arg < argc - 1; arg++)
+	{
+		const std::string argStr(argv[arg]);
+		if (argStr == "-scale")
+			scale = std::max(atoi(argv[++arg]), 1);
+		else if (argStr == "-out")
+			outFile = argv[++arg];
+	}
+
+	// the analyser sets up key bindings using ImGui
+	ImGui::CreateContext();
+
+	FBenchContext* pContext = new FBenchContext;
+	SetupBenchContext(*pContext);
+
+	std::vector<FBenchResult> results;
+	RunBenchmarks(*pContext, scale, results);
+
+	delete pContext;
+	ImGui::DestroyContext();
+
+	if (outFile.empty() == false && WriteResultsJson(results, outFile.c_str()) == false)
+	{
+		fprintf(stderr, "Failed to write '%s'\n", outFile.c_str());
+		return 1;
+	}
+
+	return 0;
+}
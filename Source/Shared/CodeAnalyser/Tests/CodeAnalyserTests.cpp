@@ -1,9 +1,64 @@
 #include "CodeAnalyserTests.h"
 
+#include "CodeAnalyser/CodeAnalyser.h"
 #include "CodeAnalyser/CodeAnalyserTypes.h"
 #include "CodeAnalyser/CodeAnalysisPage.h"
+#include "CodeAnalyser/DisassemblyCache.h"
+#include "CodeAnalyser/UI/CodeAnalyserUI.h"
+#include "CodeAnalyser/UI/MemoryHeatmap.h"
+#include "CodeAnalyser/Z80/CodeAnalyserZ80.h"
+#include "CodeAnalyser/Z80/Z80OpcodeInfo.h"
+#include "CodeAnalyser/6502/CodeAnalyser6502.h"
+#include "Util/SlabArena.h"
 
 #include <gtest/gtest.h>
+#include <cstring>
+#include <memory>
+
+// CPU interface over a flat 64K memory, for tests that need a whole analysis state
+class FTestCPUInterface : public ICPUInterface
+{
+public:
+	FTestCPUInterface()
+	{
+		CPUType = ECPUType::Z80;
+		memset(Memory, 0, sizeof(Memory));
+	}
+
+	uint8_t		ReadByte(uint16_t address) const override { return Memory[address]; }
+	uint16_t	ReadWord(uint16_t address) const override { return Memory[address] | (Memory[(uint16_t)(address + 1)] << 8); }
+	const uint8_t* GetMemPtr(uint16_t address) const override { return &Memory[address]; }
+	void		WriteByte(uint16_t address, uint8_t value) override { Memory[address] = value; }
+	FAddressRef	GetPC(void) override { return pCodeAnalysis->AddressRefFromPhysicalAddress(PC); }
+	uint16_t	GetSP(void) override { return SP; }
+
+	uint8_t					Memory[FCodeAnalysisState::kAddressSize];
+	uint16_t				PC = 0;
+	uint16_t				SP = 0;
+	FCodeAnalysisState*		pCodeAnalysis = nullptr;
+};
+
+// Analysis state with a 48K Spectrum style memory map - a ROM bank & 3 RAM banks of 16K
+struct FTestAnalysis
+{
+	FTestAnalysis(ECPUType cpuType = ECPUType::Z80)
+	{
+		CPUInterface.CPUType = cpuType;
+		CPUInterface.pCodeAnalysis = &CodeAnalysis;
+		const int16_t romBank = CodeAnalysis.CreateBank("ROM", 16, &CPUInterface.Memory[0x0000], true);
+		const int16_t ramBank0 = CodeAnalysis.CreateBank("RAM 0", 16, &CPUInterface.Memory[0x4000], false);
+		const int16_t ramBank1 = CodeAnalysis.CreateBank("RAM 1", 16, &CPUInterface.Memory[0x8000], false);
+		const int16_t ramBank2 = CodeAnalysis.CreateBank("RAM 2", 16, &CPUInterface.Memory[0xc000], false);
+		CodeAnalysis.MapBank(romBank, 0);
+		CodeAnalysis.MapBank(ramBank0, 16);
+		CodeAnalysis.MapBank(ramBank1, 32);
+		CodeAnalysis.MapBank(ramBank2, 48);
+		CodeAnalysis.Init(&CPUInterface);
+	}
+
+	FTestCPUInterface	CPUInterface;
+	FCodeAnalysisState	CodeAnalysis;
+};
 
 TEST(CodeAnalyserTest, BasicAssertions)
 {
@@ -27,6 +82,691 @@ TEST(CodeAnalyserTest, Enums)
 	EXPECT_EQ((int)ELabelType::Text, 3);
 }
 
+TEST(CodeAnalyserTest, ItemReferenceTracker)
+{
+	FItemReferenceTracker tracker;
+	EXPECT_EQ(tracker.IsEmpty(), true);
+
+	// duplicates are ignored & order is kept when moving from inline to large set storage
+	for (int i = 0; i < 10; i++)
+	{
+		tracker.RegisterAccess(FAddressRef(0, 0x8000 + i));
+		tracker.RegisterAccess(FAddressRef(0, 0x8000));
+	}
+	EXPECT_EQ(tracker.GetNoReferences(), 10);
+	int refNo = 0;
+	for (const FAddressRef& ref : tracker.GetReferences())
+		EXPECT_EQ(ref, FAddressRef(0, 0x8000 + refNo++));
+
+	// references past the cap are counted but not stored
+	for (int i = 0; i < FItemReferenceTracker::kMaxReferences + 5; i++)
+		tracker.RegisterAccess(FAddressRef(1, i));
+	EXPECT_EQ(tracker.GetNoReferences(), FItemReferenceTracker::kMaxReferences);
+	EXPECT_EQ(tracker.GetNoOverflowedAccesses(), 15);
+
+	tracker.Reset();
+	EXPECT_EQ(tracker.IsEmpty(), true);
+}
+
+TEST(CodeAnalyserTest, PageCodeBits)
+{
+	std::unique_ptr<FCodeAnalysisPage> pPage = std::make_unique<FCodeAnalysisPage>();
+	pPage->Initialise();
+	EXPECT_EQ(pPage->IsCode(100), false);
+
+	// operand bytes count as code
+	pPage->DataInfo[100].DataType = EDataType::InstructionOperand;
+	pPage->UpdateCodeBit(100);
+	EXPECT_EQ(pPage->IsCode(100), true);
+	EXPECT_EQ(pPage->IsCode(101), false);
+
+	pPage->DataInfo[100].DataType = EDataType::Byte;
+	pPage->RebuildCodeBits();
+	EXPECT_EQ(pPage->IsCode(100), false);
+}
+
+TEST(CodeAnalyserTest, PageHeatmapColours)
+{
+	std::unique_ptr<FCodeAnalysisPage> pPage = std::make_unique<FCodeAnalysisPage>();
+	pPage->Initialise();
+
+	const int kCurrentFrame = 100;
+	const int kThreshold = 4;
+	for (int addr = 0; addr < FCodeAnalysisPage::kPageSize; addr++)
+	{
+		// mix of never accessed, recent & old accesses
+		pPage->LastFrameRead[addr] = addr % 3 == 0 ? -1 : kCurrentFrame - (addr % 7);
+		pPage->LastFrameWritten[addr] = addr % 5 == 0 ? kCurrentFrame - (addr % 6) : -1;
+		pPage->LastFrameExecuted[addr] = addr % 11 == 0 ? kCurrentFrame - (addr % 9) : -1;
+	}
+
+	// odd start & length so the vector loop & the leftover bytes both get used
+	uint8_t colours[FCodeAnalysisPage::kPageSize];
+	const int kStartAddr = 3;
+	const int kNoBytes = FCodeAnalysisPage::kPageSize - 10;
+	GetPageHeatmapColours(*pPage, kStartAddr, kNoBytes, kCurrentFrame, kThreshold, colours);
+
+	for (int byteNo = 0; byteNo < kNoBytes; byteNo++)
+	{
+		const int addr = kStartAddr + byteNo;
+		auto IsRecent = [&](int lastFrame) { return lastFrame != -1 && kCurrentFrame - lastFrame < kThreshold; };
+		EHeatmapColour expected = EHeatmapColour::None;
+		if (IsRecent(pPage->LastFrameExecuted[addr]))
+			expected = EHeatmapColour::Executed;
+		else if (IsRecent(pPage->LastFrameWritten[addr]))
+			expected = EHeatmapColour::Written;
+		else if (IsRecent(pPage->LastFrameRead[addr]))
+			expected = EHeatmapColour::Read;
+		EXPECT_EQ(colours[byteNo], (uint8_t)expected) << "address " << addr;
+	}
+}
+
+TEST(CodeAnalyserTest, SparseDataInfo)
+{
+	std::unique_ptr<FTestAnalysis> pTest = std::make_unique<FTestAnalysis>();
+	FCodeAnalysisState& state = pTest->CodeAnalysis;
+	const FCodeAnalysisPage* pPage = state.GetWritePage(0x9000);
+
+	// looking up references doesn't create entries
+	EXPECT_EQ(state.GetDataReadsForAddress(0x9000).IsEmpty(), true);
+	EXPECT_EQ(state.GetDataWritesForAddress(0x9000).IsEmpty(), true);
+	EXPECT_EQ(pPage->GetNoDataReferenceEntries(), 0);
+
+	// only accessed bytes get one
+	state.LogDataWrite(0x8000, 0x9000);
+	state.LogDataWrite(0x8003, 0x9000);
+	state.FlushDataAccessLog();
+	EXPECT_EQ(pPage->GetNoDataReferenceEntries(), 1);
+	EXPECT_EQ(state.GetDataWritesForAddress(0x9000).GetNoReferences(), 2);
+
+	// comments are only allocated when set
+	FDataInfo* pDataInfo = state.GetWriteDataInfoForAddress(0x9000);
+	EXPECT_EQ(pDataInfo->Comment.empty(), true);
+	EXPECT_STREQ(pDataInfo->Comment.c_str(), "");
+	pDataInfo->Comment = "score";
+	pDataInfo->Comment += " digits";
+	EXPECT_EQ(pDataInfo->Comment.Get(), "score digits");
+	FItemComment commentCopy = pDataInfo->Comment;
+	pDataInfo->Comment = "";
+	EXPECT_EQ(pDataInfo->Comment.empty(), true);
+	EXPECT_EQ(commentCopy.Get(), "score digits");
+}
+
+TEST(CodeAnalyserTest, GlobalLabels)
+{
+	std::unique_ptr<FTestAnalysis> pTest = std::make_unique<FTestAnalysis>();
+	FCodeAnalysisState& state = pTest->CodeAnalysis;
+	GenerateGlobalInfo(state);
+
+	AddLabel(state, 0x9000, "GlobalData", ELabelType::Data, true);
+	AddLabel(state, 0x9010, "LocalData", ELabelType::Data);
+	AddLabel(state, 0x8000, "Function", ELabelType::Function);
+	EXPECT_EQ(state.GlobalDataLabels.size(), 1);
+	EXPECT_EQ(state.GlobalFunctionLabels.size(), 1);
+	EXPECT_EQ(CheckGlobalInfo(state), true);
+
+	// changing the flag through the state
+	state.SetLabelGlobal(state.AddressRefFromPhysicalAddress(0x9010), true);
+	state.SetLabelGlobal(state.AddressRefFromPhysicalAddress(0x9000), false);
+	EXPECT_EQ(state.GlobalDataLabels.size(), 1);
+	EXPECT_EQ(CheckGlobalInfo(state), true);
+
+	// labels set through the page
+	FCodeAnalysisPage* pPage = state.GetReadPage(0xC400);
+	pPage->SetLabelAtAddress(state, "PageFunction", ELabelType::Function, 0x3ff);
+	EXPECT_EQ(state.GlobalFunctionLabels.size(), 2);
+	EXPECT_EQ(CheckGlobalInfo(state), true);
+
+	UpdateGlobalInfo(state);
+	EXPECT_EQ(state.GlobalFunctions.size(), 2);
+	EXPECT_EQ(state.GlobalDataItems.size(), 1);
+}
+
+TEST(CodeAnalyserTest, SlabArena)
+{
+	FSlabArena<std::string, 4> arena;
+
+	// indices are stable across slabs
+	std::string* pStrings[10];
+	for (int i = 0; i < 10; i++)
+	{
+		pStrings[i] = arena.Allocate();
+		*pStrings[i] = std::to_string(i);
+	}
+	EXPECT_EQ(arena.GetNoAllocated(), 10);
+	EXPECT_EQ(arena.GetCapacity(), 12);
+	for (int i = 0; i < 10; i++)
+	{
+		EXPECT_EQ(arena.GetIndex(pStrings[i]), (uint32_t)i);
+		EXPECT_EQ(arena.Get(i), pStrings[i]);
+	}
+
+	// freed objects are reused in their default state
+	arena.Free(pStrings[5]);
+	EXPECT_EQ(arena.GetNoFree(), 1);
+	EXPECT_EQ(arena.Allocate(), pStrings[5]);
+	EXPECT_EQ(pStrings[5]->empty(), true);
+	EXPECT_EQ(arena.GetNoFree(), 0);
+
+	// freeing twice doesn't hand the object out twice
+	arena.Free(pStrings[9]);
+	arena.Free(pStrings[9]);
+	EXPECT_EQ(arena.GetNoFree(), 1);
+	EXPECT_EQ(arena.GetNoAllocated(), 9);
+	EXPECT_EQ(arena.IsAllocated(pStrings[9]), false);
+	EXPECT_EQ(arena.Allocate(), pStrings[9]);
+	EXPECT_NE(arena.Allocate(), pStrings[9]);
+	EXPECT_EQ(arena.IsAllocated(pStrings[9]), true);
+
+	// objects outside the arena aren't found
+	std::string notInArena;
+	EXPECT_EQ(arena.GetIndex(&notInArena), (FSlabArena<std::string, 4>::kInvalidIndex));
+
+	// reset keeps the slabs
+	arena.Reset();
+	EXPECT_EQ(arena.GetNoAllocated(), 0);
+	EXPECT_EQ(arena.GetCapacity(), 12);
+	EXPECT_EQ(arena.Allocate(), pStrings[0]);
+}
+
+TEST(CodeAnalyserTest, DisassemblyCache)
+{
+	// keys change with anything that changes the text
+	const uint8_t bytes[] = { 0x3a, 0x00, 0x40 };
+	const uint64_t key = FDisassemblyCache::MakeKey(0x8000, bytes, 3, EOperandType::Unknown, ENumberDisplayMode::HexDollar);
+	const uint8_t modifiedBytes[] = { 0x3a, 0x01, 0x40 };
+	EXPECT_NE(key, FDisassemblyCache::MakeKey(0x8000, modifiedBytes, 3, EOperandType::Unknown, ENumberDisplayMode::HexDollar));
+	EXPECT_NE(key, FDisassemblyCache::MakeKey(0x8001, bytes, 3, EOperandType::Unknown, ENumberDisplayMode::HexDollar));
+	EXPECT_NE(key, FDisassemblyCache::MakeKey(0x8000, bytes, 3, EOperandType::Decimal, ENumberDisplayMode::HexDollar));
+	EXPECT_NE(key, FDisassemblyCache::MakeKey(0x8000, bytes, 3, EOperandType::Unknown, ENumberDisplayMode::Decimal));
+
+	// least recently used entries are evicted
+	FDisassemblyCache cache;
+	cache.SetMaxEntries(2);
+	cache.Add(1, "one");
+	cache.Add(2, "two");
+	EXPECT_EQ(*cache.Find(1), "one");
+	cache.Add(3, "three");
+	EXPECT_EQ(cache.Find(2), nullptr);
+	EXPECT_EQ(*cache.Find(1), "one");
+	EXPECT_EQ(*cache.Find(3), "three");
+	EXPECT_EQ(cache.GetNoEntries(), 2);
+}
+
+// Code info laid out from a fixed seed - overlapping & empty instructions, instructions across pages & one wrapping round memory
+static void SetupReAnalyseTestCode(FCodeAnalysisState& state)
+{
+	uint32_t seed = 1234;
+	auto random = [&seed]() { seed = seed * 1664525 + 1013904223; return (int)(seed >> 16); };
+
+	int addr = 0x4000;
+	while (addr < 0xfff0)
+	{
+		const int kind = random() % 8;
+		if (kind == 0)	// gap
+		{
+			addr += 1 + random() % 64;
+			continue;
+		}
+
+		FCodeInfo* pCodeInfo = FCodeInfo::Allocate(state);
+		pCodeInfo->ByteSize = kind == 1 ? 0 : 1 + random() % 4;
+		state.SetCodeInfoForAddress(addr, pCodeInfo);
+
+		if (kind == 2 && pCodeInfo->ByteSize > 1)	// stale code info inside the instruction
+		{
+			FCodeInfo* pStaleCodeInfo = FCodeInfo::Allocate(state);
+			pStaleCodeInfo->ByteSize = 3;
+			state.SetCodeInfoForAddress(addr + 1, pStaleCodeInfo);
+		}
+		if (kind == 3 && pCodeInfo->ByteSize > 1)	// written operand
+		{
+			const uint16_t operandAddr = addr + 1;
+			state.GetWritePage(operandAddr)->GetOrCreateDataWrites(operandAddr & FCodeAnalysisPage::kPageMask).RegisterAccess(state.AddressRefFromPhysicalAddress(0x8000));
+		}
+		if (kind == 4)
+		{
+			char labelName[16];
+			snprintf(labelName, sizeof(labelName), "l%04X", addr);
+			AddLabel(state, addr, labelName, ELabelType::Code)->References.RegisterAccess(state.AddressRefFromPhysicalAddress(addr ^ 0x100));
+		}
+
+		addr += pCodeInfo->ByteSize > 0 ? pCodeInfo->ByteSize : 1;
+	}
+
+	FCodeInfo* pWrappingCodeInfo = FCodeInfo::Allocate(state);
+	pWrappingCodeInfo->ByteSize = 4;
+	state.SetCodeInfoForAddress(0xfffe, pWrappingCodeInfo);
+}
+
+TEST(CodeAnalyserTest, ReAnalyseCodeParallel)
+{
+	std::unique_ptr<FTestAnalysis> pSerial = std::make_unique<FTestAnalysis>();
+	std::unique_ptr<FTestAnalysis> pParallel = std::make_unique<FTestAnalysis>();
+	FCodeAnalysisState& serialState = pSerial->CodeAnalysis;
+	FCodeAnalysisState& parallelState = pParallel->CodeAnalysis;
+	serialState.bAllowParallelAnalysis = false;
+
+	SetupReAnalyseTestCode(serialState);
+	SetupReAnalyseTestCode(parallelState);
+	ReAnalyseCode(serialState);
+	ReAnalyseCode(parallelState);
+
+	for (int addr = 0; addr < FCodeAnalysisState::kAddressSize; addr++)
+	{
+		const FCodeInfo* pSerialCodeInfo = serialState.GetCodeInfoForAddress(addr);
+		const FCodeInfo* pParallelCodeInfo = parallelState.GetCodeInfoForAddress(addr);
+		ASSERT_EQ(pSerialCodeInfo == nullptr, pParallelCodeInfo == nullptr) << "address " << addr;
+		if (pSerialCodeInfo != nullptr)
+		{
+			EXPECT_EQ(pSerialCodeInfo->ByteSize, pParallelCodeInfo->ByteSize) << "address " << addr;
+			EXPECT_EQ(pSerialCodeInfo->bSelfModifyingCode, pParallelCodeInfo->bSelfModifyingCode) << "address " << addr;
+		}
+
+		const FDataInfo* pSerialDataInfo = serialState.GetReadDataInfoForAddress(addr);
+		const FDataInfo* pParallelDataInfo = parallelState.GetReadDataInfoForAddress(addr);
+		EXPECT_EQ(pSerialDataInfo->DataType, pParallelDataInfo->DataType) << "address " << addr;
+		EXPECT_EQ(pSerialDataInfo->ByteSize, pParallelDataInfo->ByteSize) << "address " << addr;
+		if (pSerialDataInfo->DataType == EDataType::InstructionOperand)
+			EXPECT_EQ(pSerialDataInfo->InstructionAddress, pParallelDataInfo->InstructionAddress) << "address " << addr;
+		EXPECT_EQ(serialState.IsCodeAddress(addr), parallelState.IsCodeAddress(addr)) << "address " << addr;
+
+		const FLabelInfo* pSerialLabel = serialState.GetLabelForPhysicalAddress(addr);
+		const FLabelInfo* pParallelLabel = parallelState.GetLabelForPhysicalAddress(addr);
+		ASSERT_EQ(pSerialLabel == nullptr, pParallelLabel == nullptr) << "address " << addr;
+		if (pSerialLabel != nullptr)
+		{
+			EXPECT_EQ(pSerialLabel->Name, pParallelLabel->Name) << "address " << addr;
+			EXPECT_EQ(pSerialLabel->References.GetNoReferences(), pParallelLabel->References.GetNoReferences()) << "address " << addr;
+		}
+		EXPECT_EQ(serialState.GetDataWritesForAddress(addr).GetNoReferences(), parallelState.GetDataWritesForAddress(addr).GetNoReferences()) << "address " << addr;
+	}
+}
+
+TEST(CodeAnalyserTest, SelfModifyingJump)
+{
+	std::unique_ptr<FTestAnalysis> pTest = std::make_unique<FTestAnalysis>();
+	FCodeAnalysisState& state = pTest->CodeAnalysis;
+	uint8_t* pMemory = pTest->CPUInterface.Memory;
+
+	// JP $9000
+	pMemory[0x8000] = 0xC3;
+	pMemory[0x8001] = 0x00;
+	pMemory[0x8002] = 0x90;
+	RegisterCodeExecuted(state, 0x8000, 0x8000);
+	RegisterCodeExecuted(state, 0x8000, 0x8000);	// second run uses the decoded instruction
+	EXPECT_EQ(state.GetCodeInfoForAddress(0x8000)->Decoded.bValid, true);
+	EXPECT_EQ(state.GetCodeInfoForAddress(0x8000)->JumpAddress, state.AddressRefFromPhysicalAddress(0x9000));
+
+	// patch the jump address through the access log - the instruction gets decoded again next time it runs
+	pMemory[0x8002] = 0xA0;
+	state.LogDataWrite(0x8100, 0x8002);
+	state.FlushDataAccessLog();
+	EXPECT_EQ(state.GetCodeInfoForAddress(0x8000)->bSelfModifyingCode, true);
+	RegisterCodeExecuted(state, 0x8000, 0x8000);
+	EXPECT_EQ(state.GetCodeInfoForAddress(0x8000)->JumpAddress, state.AddressRefFromPhysicalAddress(0xA000));
+
+	// writes that aren't logged still invalidate the decoded instruction
+	pMemory[0x8002] = 0xB0;
+	state.InvalidateDecodedInstructionOnWrite(0x8002);
+	RegisterCodeExecuted(state, 0x8000, 0x8000);
+	EXPECT_EQ(state.GetCodeInfoForAddress(0x8000)->JumpAddress, state.AddressRefFromPhysicalAddress(0xB000));
+}
+
+TEST(CodeAnalyserTest, OpcodeFlow)
+{
+	std::unique_ptr<FTestAnalysis> pZ80Test = std::make_unique<FTestAnalysis>();
+	FCodeAnalysisState& z80State = pZ80Test->CodeAnalysis;
+	uint8_t* pZ80Memory = pZ80Test->CPUInterface.Memory;
+	uint16_t jumpAddr = 0;
+
+	// conditional returns carry on to the next instruction
+	pZ80Memory[0x8000] = 0xC8;	// RET Z
+	EXPECT_EQ(CheckStopInstructionZ80(z80State, 0x8000), false);
+	pZ80Memory[0x8000] = 0xC0;	// RET NZ
+	EXPECT_EQ(CheckStopInstructionZ80(z80State, 0x8000), false);
+	pZ80Memory[0x8000] = 0xC9;	// RET
+	EXPECT_EQ(CheckStopInstructionZ80(z80State, 0x8000), true);
+
+	// RST is a call to a fixed address which pushes the return address
+	pZ80Memory[0x8000] = 0xFF;	// RST 38h
+	EXPECT_EQ(CheckJumpInstructionZ80(z80State, 0x8000, &jumpAddr), true);
+	EXPECT_EQ(jumpAddr, 0x0038);
+	EXPECT_EQ(CheckCallInstructionZ80(z80State, 0x8000), true);
+	EXPECT_EQ(GetZ80OpcodeInfo(EZ80OpcodeTable::Base, 0xFF).StackOp, EZ80StackOp::Push);
+	EXPECT_EQ(GetZ80OpcodeInfo(EZ80OpcodeTable::Base, 0xC7).StackOp, EZ80StackOp::Push);	// RST 0
+
+	std::unique_ptr<FTestAnalysis> p6502Test = std::make_unique<FTestAnalysis>(ECPUType::M6502);
+	FCodeAnalysisState& m6502State = p6502Test->CodeAnalysis;
+	uint8_t* p6502Memory = p6502Test->CPUInterface.Memory;
+
+	// JMP $9000
+	p6502Memory[0x8000] = 0x4C;
+	p6502Memory[0x8001] = 0x00;
+	p6502Memory[0x8002] = 0x90;
+	EXPECT_EQ(CheckStopInstruction6502(m6502State, 0x8000), true);
+	EXPECT_EQ(CheckJumpInstruction6502(m6502State, 0x8000, &jumpAddr), true);
+	EXPECT_EQ(jumpAddr, 0x9000);
+
+	// JMP ($9000) -> $A000
+	p6502Memory[0x8000] = 0x6C;
+	p6502Memory[0x9000] = 0x00;
+	p6502Memory[0x9001] = 0xA0;
+	EXPECT_EQ(CheckStopInstruction6502(m6502State, 0x8000), true);
+	EXPECT_EQ(CheckJumpInstruction6502(m6502State, 0x8000, &jumpAddr), true);
+	EXPECT_EQ(jumpAddr, 0xA000);
+
+	// conditional branches carry on to the next instruction
+	p6502Memory[0x8000] = 0xD0;	// BNE
+	EXPECT_EQ(CheckStopInstruction6502(m6502State, 0x8000), false);
+}
+
+TEST(CodeAnalyserTest, FindLabelAtOrBefore)
+{
+	std::unique_ptr<FTestAnalysis> pTest = std::make_unique<FTestAnalysis>();
+	FCodeAnalysisState& state = pTest->CodeAnalysis;
+	uint16_t labelAddr = 0;
+
+	// empty page
+	const FCodeAnalysisPage* pPage = state.GetReadPage(0x4000);
+	EXPECT_EQ(pPage->FindLabelAtOrBefore(FCodeAnalysisPage::kPageMask), -1);
+	EXPECT_EQ(state.FindLabelAtOrBeforeAddress(state.AddressRefFromPhysicalAddress(0xFFFF), labelAddr), nullptr);
+
+	// first & last address of a page & either side of a bitmap word
+	AddLabel(state, 0x4000, "PageStart", ELabelType::Data);
+	AddLabel(state, 0x403F, "WordEnd", ELabelType::Data);
+	AddLabel(state, 0x4040, "WordStart", ELabelType::Code);
+	AddLabel(state, 0x43FF, "PageEnd", ELabelType::Data);
+	EXPECT_EQ(pPage->FindLabelAtOrBefore(0x000), 0x000);
+	EXPECT_EQ(pPage->FindLabelAtOrBefore(0x03E), 0x000);
+	EXPECT_EQ(pPage->FindLabelAtOrBefore(0x03F), 0x03F);
+	EXPECT_EQ(pPage->FindLabelAtOrBefore(0x040), 0x040);
+	EXPECT_EQ(pPage->FindLabelAtOrBefore(0x3FE), 0x040);
+	EXPECT_EQ(pPage->FindLabelAtOrBefore(0x3FF), 0x3FF);
+
+	// searches back through earlier pages & banks
+	EXPECT_EQ(state.FindLabelAtOrBeforeAddress(state.AddressRefFromPhysicalAddress(0xFFFF), labelAddr)->Name, "PageEnd");
+	EXPECT_EQ(labelAddr, 0x43FF);
+	EXPECT_EQ(state.FindLabelAtOrBeforeAddress(state.AddressRefFromPhysicalAddress(0x3FFF), labelAddr), nullptr);
+	AddLabel(state, 0x0000, "ROMStart", ELabelType::Function);
+	EXPECT_EQ(state.FindLabelAtOrBeforeAddress(state.AddressRefFromPhysicalAddress(0x3FFF), labelAddr)->Name, "ROMStart");
+	EXPECT_EQ(labelAddr, 0x0000);
+
+	// label type mask
+	const uint32_t codeMask = 1 << (int)ELabelType::Code;
+	EXPECT_EQ(state.FindLabelAtOrBeforeAddress(state.AddressRefFromPhysicalAddress(0x43FF), labelAddr, codeMask)->Name, "WordStart");
+	EXPECT_EQ(state.FindLabelAtOrBeforeAddress(state.AddressRefFromPhysicalAddress(0x403F), labelAddr, codeMask), nullptr);
+
+	// removing a label clears its bit
+	state.SetLabelForPhysicalAddress(0x43FF, nullptr);
+	EXPECT_EQ(pPage->FindLabelAtOrBefore(0x3FF), 0x040);
+}
+
+TEST(CodeAnalyserTest, ItemListIndex)
+{
+	std::unique_ptr<FTestAnalysis> pTest = std::make_unique<FTestAnalysis>();
+	FCodeAnalysisState& state = pTest->CodeAnalysis;
+	const int16_t ramBank0 = state.GetBankFromAddress(0x4000);
+
+	// one data item per address to start with
+	UpdateItemList(state);
+	EXPECT_EQ(state.ItemList.size(), (int)FCodeAnalysisState::kAddressSize);
+	for (int addr : { 0x0000, 0x03FF, 0x0400, 0x3FFF, 0x4000, 0x43FF, 0x4400, 0xFFFF })
+	{
+		EXPECT_EQ(state.GetItemListIndex(state.AddressRefFromPhysicalAddress(addr)), addr);
+		EXPECT_EQ(state.ItemList[addr].AddressRef.Address, addr);
+	}
+
+	// a label on the first address of a page shifts everything after it
+	AddLabel(state, 0x4400, "PageStart", ELabelType::Data);
+	state.SetCodeAnalysisDirty(0x4400);
+	UpdateItemList(state);
+	EXPECT_EQ(state.ItemList.size(), (int)FCodeAnalysisState::kAddressSize + 1);
+	EXPECT_EQ(state.GetItemListIndex(state.AddressRefFromPhysicalAddress(0x43FF)), 0x43FF);
+	EXPECT_EQ(state.GetItemListIndex(state.AddressRefFromPhysicalAddress(0x4400)), 0x4400);
+	EXPECT_EQ(state.ItemList[0x4400].Item->Type, EItemType::Label);
+	EXPECT_EQ(state.ItemList[0x4401].Item->Type, EItemType::Data);
+	EXPECT_EQ(state.ItemList[0x4401].AddressRef.Address, 0x4400);
+	EXPECT_EQ(state.GetItemListIndex(state.AddressRefFromPhysicalAddress(0x4401)), 0x4402);
+	EXPECT_EQ(state.GetItemListIndex(state.AddressRefFromPhysicalAddress(0xFFFF)), 0x10000);
+
+	// bank list indices are relative to the bank
+	EXPECT_EQ(state.GetBankItemListIndex(FAddressRef(ramBank0, 0x4000)), 0x0000);
+	EXPECT_EQ(state.GetBankItemListIndex(FAddressRef(ramBank0, 0x4401)), 0x0402);
+	EXPECT_EQ(state.GetBankItemListIndex(FAddressRef(ramBank0, 0x7FFF)), 0x4000);
+
+	// addresses outside the bank
+	EXPECT_EQ(state.GetBankItemListIndex(FAddressRef(ramBank0, 0x8000)), -1);
+	EXPECT_EQ(state.GetBankItemListIndex(FAddressRef(ramBank0, 0x3FFF)), -1);
+}
+
+TEST(CodeAnalyserTest, IncrementalItemList)
+{
+	std::unique_ptr<FTestAnalysis> pTest = std::make_unique<FTestAnalysis>();
+	FCodeAnalysisState& state = pTest->CodeAnalysis;
+	UpdateItemList(state);
+
+	// word on the last address of a page overruns the first address of the next page
+	FDataInfo* pDataInfo = state.GetReadDataInfoForAddress(0x43FF);
+	pDataInfo->DataType = EDataType::Word;
+	pDataInfo->ByteSize = 2;
+	state.SetCodeAnalysisDirty(0x43FF);
+	UpdateItemList(state);
+	EXPECT_EQ(state.ItemList.size(), (int)FCodeAnalysisState::kAddressSize - 1);
+	EXPECT_EQ(state.ItemList[0x43FF].AddressRef.Address, 0x43FF);
+	EXPECT_EQ(state.ItemList[0x4400].AddressRef.Address, 0x4401);
+	EXPECT_EQ(state.GetItemListIndex(state.AddressRefFromPhysicalAddress(0xFFFF)), 0xFFFE);
+
+	// must match a full rebuild
+	std::vector<FCodeAnalysisItem> incrementalItems(state.ItemList.begin(), state.ItemList.end());
+	for (FCodeAnalysisBank& bank : state.GetBanks())
+		bank.bIsDirty = true;
+	state.SetCodeAnalysisDirty(0x0000);
+	UpdateItemList(state);
+	ASSERT_EQ(state.ItemList.size(), (int)incrementalItems.size());
+	for (int i = 0; i < (int)incrementalItems.size(); i++)
+	{
+		EXPECT_EQ(state.ItemList[i].Item, incrementalItems[i].Item);
+		EXPECT_EQ(state.ItemList[i].AddressRef, incrementalItems[i].AddressRef);
+	}
+
+	// shrinking it back brings the next page's first item back
+	pDataInfo->DataType = EDataType::Byte;
+	pDataInfo->ByteSize = 1;
+	state.SetCodeAnalysisDirty(0x43FF);
+	UpdateItemList(state);
+	EXPECT_EQ(state.ItemList.size(), (int)FCodeAnalysisState::kAddressSize);
+	EXPECT_EQ(state.ItemList[0x4400].AddressRef.Address, 0x4400);
+}
+
+TEST(CodeAnalyserTest, ItemListSegments)
+{
+	// empty segments at the start, middle & end of the list
+	FItemList::FSegment segment0, segment1, segment2;
+	segment1 = { FCodeAnalysisItem(nullptr, 0, 0x0100), FCodeAnalysisItem(nullptr, 0, 0x0101) };
+	segment2 = { FCodeAnalysisItem(nullptr, 0, 0x0200), FCodeAnalysisItem(nullptr, 0, 0x0201), FCodeAnalysisItem(nullptr, 0, 0x0202) };
+
+	FItemList itemList;
+	itemList.AddSegment(&segment0);
+	itemList.AddSegment(&segment1);
+	itemList.AddSegment(&segment0);
+	itemList.AddSegment(&segment2);
+	itemList.AddSegment(&segment0);
+	EXPECT_EQ(itemList.size(), 5);
+	EXPECT_EQ(itemList.GetSegmentStart(0), 0);
+	EXPECT_EQ(itemList.GetSegmentStart(1), 0);
+	EXPECT_EQ(itemList.GetSegmentStart(2), 2);
+	EXPECT_EQ(itemList.GetSegmentStart(3), 2);
+	EXPECT_EQ(itemList.GetSegmentStart(4), 5);
+	EXPECT_EQ(itemList[0].AddressRef.Address, 0x0100);
+	EXPECT_EQ(itemList[1].AddressRef.Address, 0x0101);
+	EXPECT_EQ(itemList[2].AddressRef.Address, 0x0200);
+	EXPECT_EQ(itemList[4].AddressRef.Address, 0x0202);
+
+	std::vector<uint16_t> addresses;
+	for (const FCodeAnalysisItem& item : itemList)
+		addresses.push_back(item.AddressRef.Address);
+	EXPECT_EQ(addresses, (std::vector<uint16_t>{ 0x0100, 0x0101, 0x0200, 0x0201, 0x0202 }));
+
+	// a segment changing size moves the starts of the ones after it
+	segment1.pop_back();
+	itemList.SetSegment(2, &segment1);
+	itemList.UpdateSegmentStarts();
+	EXPECT_EQ(itemList.size(), 5);
+	EXPECT_EQ(itemList.GetSegmentStart(2), 1);
+	EXPECT_EQ(itemList.GetSegmentStart(3), 2);
+	EXPECT_EQ(itemList[0].AddressRef.Address, 0x0100);
+	EXPECT_EQ(itemList[1].AddressRef.Address, 0x0100);
+	EXPECT_EQ(itemList[2].AddressRef.Address, 0x0200);
+
+	FItemList emptyList;
+	emptyList.AddSegment(&segment0);
+	EXPECT_TRUE(emptyList.empty());
+	EXPECT_TRUE(emptyList.begin() == emptyList.end());
+}
+
+TEST(CodeAnalyserTest, ItemListUnmappedPages)
+{
+	std::unique_ptr<FTestAnalysis> pTest = std::make_unique<FTestAnalysis>();
+	FCodeAnalysisState& state = pTest->CodeAnalysis;
+	const int16_t ramBank2 = state.GetBankFromAddress(0xC000);
+	UpdateItemList(state);
+
+	// nothing mapped in the top 16K gives empty segments for its pages
+	state.UnMapBank(ramBank2, 48);
+	UpdateItemList(state);
+	EXPECT_EQ(state.ItemList.size(), 0xC000);
+	EXPECT_EQ(state.ItemList.GetSegmentStart(48), 0xC000);
+	EXPECT_EQ(state.ItemList.GetSegmentStart(63), 0xC000);
+	EXPECT_EQ(state.ItemList[0xBFFF].AddressRef.Address, 0xBFFF);
+	EXPECT_EQ(state.GetItemListIndex(state.AddressRefFromPhysicalAddress(0xBFFF)), 0xBFFF);
+	EXPECT_EQ(state.GetItemListIndex(FAddressRef(ramBank2, 0xC000)), -1);
+	EXPECT_EQ(state.GetItemListIndex(FAddressRef(ramBank2, 0xFFFF)), -1);
+
+	state.MapBank(ramBank2, 48);
+	UpdateItemList(state);
+	EXPECT_EQ(state.ItemList.size(), (int)FCodeAnalysisState::kAddressSize);
+	EXPECT_EQ(state.GetItemListIndex(FAddressRef(ramBank2, 0xFFFF)), 0xFFFF);
+}
+
+TEST(CodeAnalyserTest, RemapBank)
+{
+	std::unique_ptr<FTestAnalysis> pTest = std::make_unique<FTestAnalysis>();
+	FCodeAnalysisState& state = pTest->CodeAnalysis;
+	const int16_t ramBank2 = state.GetBankFromAddress(0xC000);
+	std::vector<uint8_t> bankMem(0x4000, 0);
+	bankMem[0x0000] = 0x12;
+	bankMem[0x3FFF] = 0x34;
+	pTest->CPUInterface.Memory[0xC000] = 0x56;
+	const int16_t ramBank3 = state.CreateBank("RAM 3", 16, bankMem.data(), false);
+	state.Init(&pTest->CPUInterface);	// banks are set up before Init
+	UpdateItemList(state);
+
+	// swap a different bank into the top 16K
+	EXPECT_TRUE(state.UnMapBank(ramBank2, 48));
+	EXPECT_TRUE(state.MapBank(ramBank3, 48));
+	EXPECT_EQ(state.GetBank(ramBank2)->MappedPageBits, 0ull);
+	EXPECT_EQ(state.GetBank(ramBank3)->MappedPageBits, 1ull << 48);
+	EXPECT_EQ(state.GetBank(ramBank3)->GetMappedStartPage(48), 48);
+	EXPECT_EQ(state.GetBank(ramBank3)->GetMappedStartPage(63), 48);
+	EXPECT_EQ(state.GetBank(ramBank3)->GetMappedStartPage(47), -1);
+	EXPECT_EQ(state.GetBankFromAddress(0xBFFF), state.GetBankFromAddress(0x8000));
+	EXPECT_EQ(state.GetBankFromAddress(0xC000), ramBank3);
+	EXPECT_EQ(state.GetBankFromAddress(0xFFFF), ramBank3);
+	EXPECT_EQ(state.ReadByte(0xC000), 0x12);
+	EXPECT_EQ(state.ReadByte(0xFFFF), 0x34);
+
+	UpdateItemList(state);
+	EXPECT_EQ(state.ItemList.size(), (int)FCodeAnalysisState::kAddressSize);
+	EXPECT_EQ(state.ItemList[0xBFFF].AddressRef.BankId, state.GetBankFromAddress(0x8000));
+	EXPECT_EQ(state.ItemList[0xC000].AddressRef, FAddressRef(ramBank3, 0xC000));
+	EXPECT_EQ(state.ItemList[0xFFFF].AddressRef, FAddressRef(ramBank3, 0xFFFF));
+	EXPECT_EQ(state.GetItemListIndex(FAddressRef(ramBank3, 0xFFFF)), 0xFFFF);
+
+	// and back again
+	EXPECT_TRUE(state.UnMapBank(ramBank3, 48));
+	EXPECT_TRUE(state.MapBank(ramBank2, 48));
+	EXPECT_EQ(state.ReadByte(0xC000), 0x56);
+	UpdateItemList(state);
+	EXPECT_EQ(state.ItemList[0xC000].AddressRef, FAddressRef(ramBank2, 0xC000));
+	EXPECT_EQ(state.GetItemListIndex(FAddressRef(ramBank3, 0xC000)), 0xC000);	// unmapped bank resolves to what's mapped there
+}
+
+TEST(CodeAnalyserTest, BankPageTable)
+{
+	std::unique_ptr<FTestAnalysis> pTest = std::make_unique<FTestAnalysis>();
+	FCodeAnalysisState& state = pTest->CodeAnalysis;
+	const int16_t ramBank0 = state.GetBankFromAddress(0x4000);
+	const int16_t ramBank1 = state.GetBankFromAddress(0x8000);
+	const int16_t ramBank2 = state.GetBankFromAddress(0xC000);
+	const int16_t ramBank3 = state.CreateBank("RAM 3", 16, &pTest->CPUInterface.Memory[0xC000], false);
+	state.Init(&pTest->CPUInterface);
+
+	// first & last address of a bank
+	const FCodeAnalysisBank* pBank0 = state.GetBank(ramBank0);
+	EXPECT_EQ(state.GetBankPageForAddress(FAddressRef(ramBank0, 0x4000)), &pBank0->Pages[0]);
+	EXPECT_EQ(state.GetBankPageForAddress(FAddressRef(ramBank0, 0x43FF)), &pBank0->Pages[0]);
+	EXPECT_EQ(state.GetBankPageForAddress(FAddressRef(ramBank0, 0x4400)), &pBank0->Pages[1]);
+	EXPECT_EQ(state.GetBankPageForAddress(FAddressRef(ramBank0, 0x7FFF)), &pBank0->Pages[15]);
+	EXPECT_EQ(state.GetBankPageForAddress(FAddressRef(ramBank2, 0xFFFF)), &state.GetBank(ramBank2)->Pages[15]);
+
+	// outside the bank, invalid bank ids & a bank that's never been mapped
+	EXPECT_EQ(state.GetBankPageForAddress(FAddressRef(ramBank0, 0x3FFF)), nullptr);
+	EXPECT_EQ(state.GetBankPageForAddress(FAddressRef(ramBank0, 0x8000)), nullptr);
+	EXPECT_EQ(state.GetBankPageForAddress(FAddressRef(-1, 0x4000)), nullptr);
+	EXPECT_EQ(state.GetBankPageForAddress(FAddressRef(ramBank3 + 1, 0x4000)), nullptr);
+	EXPECT_EQ(state.GetBankPageForAddress(FAddressRef(ramBank3, 0x0000)), nullptr);
+	EXPECT_EQ(state.GetBankPageForAddress(FAddressRef(ramBank3, 0xC000)), nullptr);
+
+	// primary mapped page decides the addresses a bank's pages are found at, mapped or not
+	state.SetBankPrimaryMappedPage(ramBank3, 32);
+	const FCodeAnalysisBank* pBank3 = state.GetBank(ramBank3);
+	EXPECT_EQ(state.GetBankPageForAddress(FAddressRef(ramBank3, 0x8000)), &pBank3->Pages[0]);
+	EXPECT_EQ(state.GetBankPageForAddress(FAddressRef(ramBank3, 0xBFFF)), &pBank3->Pages[15]);
+	EXPECT_EQ(state.GetBankPageForAddress(FAddressRef(ramBank3, 0xC000)), nullptr);
+	EXPECT_EQ(state.GetBankPageForAddress(FAddressRef(ramBank1, 0x8000)), &state.GetBank(ramBank1)->Pages[0]);
+
+	state.SetBankPrimaryMappedPage(ramBank3, 48);
+	EXPECT_EQ(state.GetBankPageForAddress(FAddressRef(ramBank3, 0x8000)), nullptr);
+	EXPECT_EQ(state.GetBankPageForAddress(FAddressRef(ramBank3, 0xFFFF)), &pBank3->Pages[15]);
+}
+
+TEST(CodeAnalyserTest, ReadWordBoundaries)
+{
+	std::unique_ptr<FTestAnalysis> pTest = std::make_unique<FTestAnalysis>();
+	FCodeAnalysisState& state = pTest->CodeAnalysis;
+	uint8_t* pMemory = pTest->CPUInterface.Memory;
+	const int16_t ramBank2 = state.GetBankFromAddress(0xC000);
+	std::vector<uint8_t> bankMem(0x4000, 0);
+	const int16_t ramBank3 = state.CreateBank("RAM 3", 16, bankMem.data(), false);
+	state.Init(&pTest->CPUInterface);
+
+	// words straddling page & bank boundaries, wrapping at the top of memory
+	pMemory[0x0000] = 0x01;
+	pMemory[0x3FFF] = 0x02;
+	pMemory[0x4000] = 0x03;
+	pMemory[0x43FF] = 0x04;
+	pMemory[0x4400] = 0x05;
+	pMemory[0xFFFF] = 0x06;
+	EXPECT_EQ(state.ReadWord(0x3FFF), 0x0302);
+	EXPECT_EQ(state.ReadWord(0x43FF), 0x0504);
+	EXPECT_EQ(state.ReadWord(0xFFFF), 0x0106);
+	EXPECT_EQ(state.ReadWord(state.AddressRefFromPhysicalAddress(0x3FFF)), 0x0302);
+	EXPECT_EQ(state.ReadWord(state.AddressRefFromPhysicalAddress(0x43FF)), 0x0504);
+
+	// bank with its own memory - high byte comes from whatever is mapped after it
+	EXPECT_TRUE(state.UnMapBank(ramBank2, 48));
+	EXPECT_TRUE(state.MapBank(ramBank3, 48));
+	bankMem[0x0000] = 0x07;
+	bankMem[0x3FFE] = 0x08;
+	bankMem[0x3FFF] = 0x09;
+	EXPECT_EQ(state.ReadWord(0xBFFF), 0x0700 | pMemory[0xBFFF]);
+	EXPECT_EQ(state.ReadWord(0xFFFE), 0x0908);
+	EXPECT_EQ(state.ReadWord(0xFFFF), 0x0109);
+	EXPECT_EQ(state.ReadWord(FAddressRef(ramBank3, 0xFFFE)), 0x0908);
+	EXPECT_EQ(state.ReadWord(FAddressRef(ramBank3, 0xFFFF)), 0x0109);
+}
+
 bool RunCodeAnalyserTests(void)
 {
 	return true;
@@ -59,7 +59,7 @@ void DrawColourInfoComboBox(EColourInfo* pValue)
 
 void DrawCharacterSetComboBox(FCodeAnalysisState& state, FAddressRef& addr)
 {
-	const FCharacterSet* pCharSet = addr.IsValid() ? GetCharacterSetFromAddress(addr) : nullptr;
+	const FCharacterSet* pCharSet = addr.IsValid() ? GetCharacterSetFromAddress(state, addr) : nullptr;
 	const FLabelInfo* pLabel = pCharSet != nullptr ? state.GetLabelForAddress(addr) : nullptr;
 
 	const char* pCharSetName = pLabel != nullptr ? pLabel->Name.c_str() : "None";
@@ -71,9 +71,9 @@ void DrawCharacterSetComboBox(FCodeAnalysisState& state, FAddressRef& addr)
 			addr = FAddressRef();
 		}
 
-		for (int i=0;i< GetNoCharacterSets();i++)
+		for (int i=0;i< GetNoCharacterSets(state);i++)
 		{
-			const FCharacterSet* pCharSet = GetCharacterSetFromIndex(i);
+			const FCharacterSet* pCharSet = GetCharacterSetFromIndex(state, i);
 			const FLabelInfo* pSetLabel = state.GetLabelForAddress(pCharSet->Params.Address);
 			if (pSetLabel == nullptr)
 				continue;
@@ -95,9 +95,9 @@ void DrawCharacterSetViewer(FCodeAnalysisState& state, FCodeAnalysisViewState& v
 	if (ImGui::BeginChild("##charsetselect", ImVec2(ImGui::GetWindowContentRegionWidth() * 0.25f, 0), true))
 	{
 		int deleteIndex = -1;
-		for (int i = 0; i < GetNoCharacterSets(); i++)
+		for (int i = 0; i < GetNoCharacterSets(state); i++)
 		{
-			const FCharacterSet* pCharSet = GetCharacterSetFromIndex(i);
+			const FCharacterSet* pCharSet = GetCharacterSetFromIndex(state, i);
 			const FLabelInfo* pSetLabel = state.GetLabelForAddress(pCharSet->Params.Address);
 			const bool bSelected = params.Address == pCharSet->Params.Address;
 
@@ -128,14 +128,14 @@ void DrawCharacterSetViewer(FCodeAnalysisState& state, FCodeAnalysisViewState& v
 		}
 
 		if(deleteIndex != -1)
-			DeleteCharacterSet(deleteIndex);
+			DeleteCharacterSet(state, deleteIndex);
 	}
 
 	ImGui::EndChild();
 	ImGui::SameLine();
 	if (ImGui::BeginChild("##charsetdetails", ImVec2(0, 0), true))
 	{
-		FCharacterSet* pCharSet = GetCharacterSetFromAddress(selectedCharSetAddr);
+		FCharacterSet* pCharSet = GetCharacterSetFromAddress(state, selectedCharSetAddr);
 		if (pCharSet)
 		{
 			if (DrawAddressInput(state, "Address", params.Address))
@@ -175,7 +175,7 @@ struct FCharacterMapViewerUIState
 // this assumes the character map is in address space
 void DrawCharacterMap(FCharacterMapViewerUIState& uiState, FCodeAnalysisState& state, FCodeAnalysisViewState& viewState)
 {
-	FCharacterMap* pCharMap = GetCharacterMapFromAddress(uiState.SelectedCharMapAddr);
+	FCharacterMap* pCharMap = GetCharacterMapFromAddress(state, uiState.SelectedCharMapAddr);
 
 	if (pCharMap == nullptr)
 		return;
@@ -217,7 +217,7 @@ void DrawCharacterMap(FCharacterMapViewerUIState& uiState, FCodeAnalysisState& s
 	ImVec2 pos = ImGui::GetCursorScreenPos();
 	const float rectSize = 12.0f;
 	uint16_t byte = 0;
-	const FCharacterSet* pCharSet = GetCharacterSetFromAddress(params.CharacterSet);
+	const FCharacterSet* pCharSet = GetCharacterSetFromAddress(state, params.CharacterSet);
 	static bool bShowReadWrites = true;
 	const uint16_t physAddress = params.Address.Address;
 
@@ -226,9 +226,10 @@ void DrawCharacterMap(FCharacterMapViewerUIState& uiState, FCodeAnalysisState& s
 		for (int x = 0; x < params.Width; x++)
 		{
 			const uint8_t val = state.ReadByte(physAddress + byte);
-			FDataInfo* pDataInfo = state.GetReadDataInfoForAddress(physAddress + byte);
-			const int framesSinceWritten = pDataInfo->LastFrameWritten == -1 ? 255 : state.CurrentFrameNo - pDataInfo->LastFrameWritten;
-			const int framesSinceRead = pDataInfo->LastFrameRead == -1 ? 255 : state.CurrentFrameNo - pDataInfo->LastFrameRead;
+			const int lastFrameWritten = state.GetLastFrameWrittenForAddress(physAddress + byte);
+			const int lastFrameRead = state.GetLastFrameReadForAddress(physAddress + byte);
+			const int framesSinceWritten = lastFrameWritten == -1 ? 255 : state.CurrentFrameNo - lastFrameWritten;
+			const int framesSinceRead = lastFrameRead == -1 ? 255 : state.CurrentFrameNo - lastFrameRead;
 			const int wBrightVal = (255 - std::min(framesSinceWritten << 3, 255)) & 0xff;
 			const int rBrightVal = (255 - std::min(framesSinceRead << 3, 255)) & 0xff;
 
@@ -344,12 +345,13 @@ void DrawCharacterMap(FCharacterMapViewerUIState& uiState, FCodeAnalysisState& s
 	{
 		// Show data reads & writes
 		// 
-		FDataInfo* pDataInfo = state.GetReadDataInfoForAddress(uiState.SelectedCharAddress);
+		const FItemReferenceTracker& reads = state.GetDataReadsForAddress(uiState.SelectedCharAddress);
+		const FItemReferenceTracker& writes = state.GetDataWritesForAddress(uiState.SelectedCharAddress);
 		// List Data accesses
-		if (pDataInfo->Reads.IsEmpty() == false)
+		if (reads.IsEmpty() == false)
 		{
 			ImGui::Text("Reads:");
-			for (const auto& reader : pDataInfo->Reads.GetReferences())
+			for (const auto& reader : reads.GetReferences())
 			{
 				ShowCodeAccessorActivity(state, reader);
 
@@ -359,10 +361,10 @@ void DrawCharacterMap(FCharacterMapViewerUIState& uiState, FCodeAnalysisState& s
 			}
 		}
 
-		if (pDataInfo->Writes.IsEmpty() == false)
+		if (writes.IsEmpty() == false)
 		{
 			ImGui::Text("Writes:");
-			for (const auto& writer : pDataInfo->Writes.GetReferences())
+			for (const auto& writer : writes.GetReferences())
 			{
 				ShowCodeAccessorActivity(state, writer);
 
@@ -386,9 +388,9 @@ void DrawCharacterMaps(FCodeAnalysisState& state, FCodeAnalysisViewState& viewSt
 		int deleteIndex = -1;
 
 		// List character maps
-		for (int i = 0; i < GetNoCharacterMaps(); i++)
+		for (int i = 0; i < GetNoCharacterMaps(state); i++)
 		{
-			const FCharacterMap* pCharMap = GetCharacterMapFromIndex(i);
+			const FCharacterMap* pCharMap = GetCharacterMapFromIndex(state, i);
 			const FLabelInfo* pSetLabel = state.GetLabelForAddress(pCharMap->Params.Address);
 			const bool bSelected = uiState.SelectedCharMapAddr == pCharMap->Params.Address;
 
@@ -422,7 +424,7 @@ void DrawCharacterMaps(FCodeAnalysisState& state, FCodeAnalysisViewState& viewSt
 		}
 
 		if(deleteIndex != -1)
-			DeleteCharacterMap(deleteIndex);
+			DeleteCharacterMap(state, deleteIndex);
 
 		
 	}
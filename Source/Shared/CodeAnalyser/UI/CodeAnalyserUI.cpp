@@ -47,27 +47,26 @@ bool FCodeAnalysisViewState::GoToPreviousAddress()
 int GetItemIndexForAddress(const FCodeAnalysisState &state, FAddressRef addr)
 {
 	const FCodeAnalysisBank* pBank = state.GetBank(addr.BankId);
-
-	int index = -1;
-
 	assert(pBank != nullptr);
-	
-	for (int i = 0; i < (int)pBank->ItemList.size(); i++)
+
+	// the last item at or before the address is the one before the first item after it
+	const FAddressRef nextAddr(addr.BankId, addr.Address + 1);
+	int nextIndex = (int)pBank->ItemList.size();
+	if (addr.Address != 0xffff && pBank->AddressValid(nextAddr.Address))
 	{
-		if (pBank->ItemList[i].IsValid() && pBank->ItemList[i].AddressRef.Address > addr.Address)
-			return index;
-		index = i;
+		nextIndex = state.GetBankItemListIndex(nextAddr);
+		if (nextIndex == -1)
+			nextIndex = (int)pBank->ItemList.size();
 	}
-	return -1;
-}
 
+	return nextIndex > 0 ? nextIndex - 1 : -1;
+}
 
 
-std::vector<FMemoryRegionDescGenerator*>	g_RegionDescHandlers;
 
-const char* GetRegionDesc(uint16_t addr)
+const char* GetRegionDesc(const FCodeAnalysisState& state, uint16_t addr)
 {
-	for (FMemoryRegionDescGenerator* pDescGen : g_RegionDescHandlers)
+	for (FMemoryRegionDescGenerator* pDescGen : state.RegionDescHandlers)
 	{
 		if (pDescGen)
 		{
@@ -78,9 +77,9 @@ const char* GetRegionDesc(uint16_t addr)
 	return nullptr;
 }
 
-bool AddMemoryRegionDescGenerator(FMemoryRegionDescGenerator* pGen)
+bool AddMemoryRegionDescGenerator(FCodeAnalysisState& state, FMemoryRegionDescGenerator* pGen)
 {
-	g_RegionDescHandlers.push_back(pGen);
+	state.RegionDescHandlers.push_back(pGen);
 	return true;
 }
 
@@ -115,35 +114,24 @@ void DrawAddressLabel(FCodeAnalysisState& state, FCodeAnalysisViewState& viewSta
 void DrawAddressLabel(FCodeAnalysisState &state, FCodeAnalysisViewState& viewState, FAddressRef addr, bool bFunctionRel)
 {
 	int labelOffset = 0;
-	const char *pLabelString = GetRegionDesc(addr.Address);
-	FCodeAnalysisBank* pBank = state.GetBank(addr.BankId);
-	assert(pBank != nullptr);
+	const char *pLabelString = GetRegionDesc(state, addr.Address);
+	assert(state.GetBank(addr.BankId) != nullptr);
 
 	if (pLabelString == nullptr)	// get a label
 	{
 		// find a label for this address
-		for (int addrVal = addr.Address; addrVal >= 0; addrVal--)
+		const uint32_t labelTypeMask = bFunctionRel ? (1 << (int)ELabelType::Function) : ~0u;
+		uint16_t labelAddress = 0;
+		const FLabelInfo* pLabel = state.FindLabelAtOrBeforeAddress(addr, labelAddress, labelTypeMask);
+		if (pLabel != nullptr)
 		{
-			if (pBank->AddressValid(addrVal) == false)
-			{
-				pBank = state.GetBank(state.GetBankFromAddress(addrVal));
-				assert(pBank != nullptr);
-			}
-
-			const FLabelInfo* pLabel = state.GetLabelForAddress(FAddressRef(pBank->Id,addrVal));
-			if (pLabel != nullptr)
-			{
-				if (bFunctionRel == false || pLabel->LabelType == ELabelType::Function)
-				{
-					pLabelString = pLabel->Name.c_str();
-					break;
-				}
-			}
-
-			labelOffset++;
-
-			if (pLabelString == nullptr && addrVal == 0)
-				pLabelString = "0000";
+			pLabelString = pLabel->Name.c_str();
+			labelOffset = addr.Address - labelAddress;
+		}
+		else
+		{
+			pLabelString = "0000";
+			labelOffset = addr.Address;
 		}
 	}
 	
@@ -266,13 +254,14 @@ void DrawLabelDetails(FCodeAnalysisState &state, FCodeAnalysisViewState& viewSta
 		SetLabelName(state, pLabelInfo, LabelText.c_str());
 	}
 
-	if(ImGui::Checkbox("Global", &pLabelInfo->Global))
+	bool bGlobal = pLabelInfo->Global;
+	if(ImGui::Checkbox("Global", &bGlobal))
 	{
-		if (pLabelInfo->LabelType == ELabelType::Code && pLabelInfo->Global == true)
+		if (pLabelInfo->LabelType == ELabelType::Code && bGlobal == true)
 			pLabelInfo->LabelType = ELabelType::Function;
-		if (pLabelInfo->LabelType == ELabelType::Function && pLabelInfo->Global == false)
+		if (pLabelInfo->LabelType == ELabelType::Function && bGlobal == false)
 			pLabelInfo->LabelType = ELabelType::Code;
-		GenerateGlobalInfo(state);
+		state.SetLabelGlobal(item.AddressRef, bGlobal);
 	}
 
 	ImGui::Text("References:");
@@ -303,10 +292,13 @@ void DrawCommentBlockDetails(FCodeAnalysisState& state, const FCodeAnalysisItem&
 	if (pCommentBlock == nullptr)
 		return;
 
-	if (ImGui::InputTextMultiline("Comment Text", &pCommentBlock->Comment))
+	if (ImGui::InputTextMultiline("Comment Text", &pCommentBlock->Comment.Edit()))
 	{
 		if (pCommentBlock->Comment.empty() == true)
+		{
 			state.SetCommentBlockForAddress(item.AddressRef, nullptr);
+			state.FreeItemLater(pCommentBlock);	// the item list & cursors can still point at it
+		}
 		state.SetCodeAnalysisDirty(item.AddressRef);
 	}
 
@@ -412,29 +404,29 @@ void ProcessKeyCommands(FCodeAnalysisState& state, FCodeAnalysisViewState& viewS
 	{
 		if (state.Debugger.IsStopped())
 		{
-			state.Debugger.Continue();
+			state.Debugger.QueueCommand(EDebugCommand::Continue);
 			//viewState.TrackPCFrame = true;
 		}
 		else
 		{
-			state.Debugger.Break();
+			state.Debugger.QueueCommand(EDebugCommand::Break);
 		}
 	}
 	else if (ImGui::IsKeyPressed(state.KeyConfig[(int)EKey::StepOver]))
 	{
-		state.Debugger.StepOver();
+		state.Debugger.QueueCommand(EDebugCommand::StepOver);
 	}
 	else if (ImGui::IsKeyPressed(state.KeyConfig[(int)EKey::StepInto]))
 	{
-		state.Debugger.StepInto();
+		state.Debugger.QueueCommand(EDebugCommand::StepInto);
 	}
 	else if (ImGui::IsKeyPressed(state.KeyConfig[(int)EKey::StepFrame]))
 	{
-		state.Debugger.StepFrame();
+		state.Debugger.QueueCommand(EDebugCommand::StepFrame);
 	}
 	else if (ImGui::IsKeyPressed(state.KeyConfig[(int)EKey::StepScreenWrite]))
 	{
-		state.Debugger.StepScreenWrite();
+		state.Debugger.QueueCommand(EDebugCommand::StepScreenWrite);
 	}
 }
 
@@ -448,7 +440,7 @@ void UpdatePopups(FCodeAnalysisState& state, FCodeAnalysisViewState& viewState)
 	if (ImGui::BeginPopup("Enter Comment Text", ImGuiWindowFlags_AlwaysAutoResize))
 	{
 		ImGui::SetKeyboardFocusHere();
-		if (ImGui::InputText("##comment", &cursorItem.Item->Comment, ImGuiInputTextFlags_EnterReturnsTrue))
+		if (ImGui::InputText("##comment", &cursorItem.Item->Comment.Edit(), ImGuiInputTextFlags_EnterReturnsTrue))
 		{
 			ImGui::CloseCurrentPopup();
 		}
@@ -459,7 +451,7 @@ void UpdatePopups(FCodeAnalysisState& state, FCodeAnalysisViewState& viewState)
 	if (ImGui::BeginPopup("Enter Comment Text Multi", ImGuiWindowFlags_AlwaysAutoResize))
 	{
 		ImGui::SetKeyboardFocusHere();
-		if(ImGui::InputTextMultiline("##comment", &cursorItem.Item->Comment,ImVec2(), ImGuiInputTextFlags_EnterReturnsTrue | ImGuiInputTextFlags_CtrlEnterForNewLine))
+		if(ImGui::InputTextMultiline("##comment", &cursorItem.Item->Comment.Edit(),ImVec2(), ImGuiInputTextFlags_EnterReturnsTrue | ImGuiInputTextFlags_CtrlEnterForNewLine))
 		{
 			state.SetCodeAnalysisDirty(cursorItem.AddressRef);
 			ImGui::CloseCurrentPopup();
@@ -487,8 +479,9 @@ void UpdatePopups(FCodeAnalysisState& state, FCodeAnalysisViewState& viewState)
 
 struct FItemListBuilder
 {
-	FItemListBuilder(std::vector<FCodeAnalysisItem>& itemList) :ItemList(itemList) {}
+	FItemListBuilder(FItemListSegment& segment) :Segment(segment), ItemList(segment.Items) {}
 
+	FItemListSegment&				Segment;
 	std::vector<FCodeAnalysisItem>&	ItemList;
 	int16_t				BankId = -1;
 	int					CurrAddr = 0;
@@ -508,7 +501,8 @@ void ExpandCommentBlock(FCodeAnalysisState& state, FItemListBuilder& builder, FC
 		if (line.empty() || line[0] == '@')	// skip lines starting with @ - we might want to create items from them in future
 			continue;
 
-		FCommentLine* pLine = FCommentLine::Allocate();
+		FCommentLine* pLine = FCommentLine::Allocate(state);
+		builder.Segment.CommentLines.push_back(pLine);
 		pLine->Comment = line;
 		//pLine->Address = addr;
 		builder.ItemList.emplace_back(pLine, builder.BankId, builder.CurrAddr);
@@ -524,21 +518,29 @@ void ExpandCommentBlock(FCodeAnalysisState& state, FItemListBuilder& builder, FC
 	}
 }
 
-void UpdateItemListForBank(FCodeAnalysisState& state, FCodeAnalysisBank& bank)
+// Rebuild the items for one page of a bank
+// nextItemAddress is where the previous page's last item finished, returns where this page's last item finishes
+static int UpdateItemListForPage(FCodeAnalysisState& state, FCodeAnalysisBank& bank, int pageNo, int nextItemAddress)
 {
-	bank.ItemList.clear();
-	FItemListBuilder listBuilder(bank.ItemList);
+	FItemListSegment& segment = bank.ItemListSegments[pageNo];
+	FCodeAnalysisPage& page = bank.Pages[pageNo];
+
+	for (FCommentLine* pLine : segment.CommentLines)
+		FCommentLine::Free(state, pLine);
+	segment.CommentLines.clear();
+	segment.Items.clear();
+
+	FItemListBuilder listBuilder(segment);
 	listBuilder.BankId = bank.Id;
 
-	const int16_t page = bank.PrimaryMappedPage;
-	const uint16_t bankPhysAddr = page * FCodeAnalysisPage::kPageSize;
-	int nextItemAddress = 0;
+	const uint16_t bankPhysAddr = bank.PrimaryMappedPage * FCodeAnalysisPage::kPageSize;
+	const int pageStart = pageNo * FCodeAnalysisPage::kPageSize;
 
-	for (int bankAddr = 0; bankAddr < bank.NoPages * FCodeAnalysisPage::kPageSize; bankAddr++)
+	for (int pageAddr = 0; pageAddr < FCodeAnalysisPage::kPageSize; pageAddr++)
 	{
-		FCodeAnalysisPage& page = bank.Pages[bankAddr >> FCodeAnalysisPage::kPageShift];
-		const uint16_t pageAddr = bankAddr & FCodeAnalysisPage::kPageMask;
+		const int bankAddr = pageStart + pageAddr;
 		listBuilder.CurrAddr = bankPhysAddr + bankAddr;
+		segment.ItemIndexForAddress[pageAddr] = (int)segment.Items.size();
 
 		FCommentBlock* pCommentBlock = page.CommentBlocks[pageAddr];
 		if (pCommentBlock != nullptr)
@@ -574,63 +576,112 @@ void UpdateItemListForBank(FCodeAnalysisState& state, FCodeAnalysisBank& bank)
 			}
 		}
 	}
+
+	segment.bDirty = false;
+	return nextItemAddress;
+}
+
+// Rebuild the dirty pages of a bank's item list, or all of them if the bank is dirty
+void UpdateItemListForBank(FCodeAnalysisState& state, FCodeAnalysisBank& bank)
+{
+	if (bank.ItemListSegments.size() != bank.NoPages)
+	{
+		bank.ItemListSegments.clear();
+		bank.ItemListSegments.resize(bank.NoPages);
+		bank.bIsDirty = true;
+	}
+
+	bool bListChanged = bank.bIsDirty;
+	int nextItemAddress = 0;
+	for (int pageNo = 0; pageNo < bank.NoPages; pageNo++)
+	{
+		FItemListSegment& segment = bank.ItemListSegments[pageNo];
+		if (segment.bDirty || bank.bIsDirty)
+		{
+			const int oldNextItemAddress = segment.NextItemAddress;
+			segment.NextItemAddress = UpdateItemListForPage(state, bank, pageNo, nextItemAddress);
+			bListChanged = true;
+
+			// items overrunning into the next page have changed
+			if (segment.NextItemAddress != oldNextItemAddress && pageNo + 1 < bank.NoPages)
+				bank.ItemListSegments[pageNo + 1].bDirty = true;
+		}
+		nextItemAddress = segment.NextItemAddress;
+	}
+	bank.bIsDirty = false;
+
+	if (bank.ItemList.GetNoSegments() != bank.NoPages)
+	{
+		bank.ItemList.Clear();
+		for (const FItemListSegment& segment : bank.ItemListSegments)
+			bank.ItemList.AddSegment(&segment.Items);
+	}
+	else if (bListChanged)
+	{
+		bank.ItemList.UpdateSegmentStarts();
+	}
+}
+
+// items for the bank page mapped to an address space page
+static const FItemList::FSegment* GetAddressSpaceSegment(const FCodeAnalysisState& state, int pageNo)
+{
+	static const FItemList::FSegment kEmptySegment;
+
+	const FCodeAnalysisBank* pBank = state.GetBank(state.GetBankFromAddress(pageNo * FCodeAnalysisPage::kPageSize));
+	if (pBank == nullptr)
+		return &kEmptySegment;
+
+	const int startPageNo = pBank->GetMappedStartPage(pageNo);
+	const int bankPageNo = pageNo - startPageNo;
+	if (startPageNo == -1 || bankPageNo >= (int)pBank->ItemListSegments.size())
+		return &kEmptySegment;
+
+	return &pBank->ItemListSegments[bankPageNo].Items;
 }
 
 void UpdateItemList(FCodeAnalysisState &state)
 {
+	// address space list is a view with a segment for each page of the mapped banks - no items are copied
+	if (state.ItemList.GetNoSegments() != FCodeAnalysisState::kNoPagesInAddressSpace)
+	{
+		state.ItemList.Clear();
+		for (int pageNo = 0; pageNo < FCodeAnalysisState::kNoPagesInAddressSpace; pageNo++)
+			state.ItemList.AddSegment(GetAddressSpaceSegment(state, pageNo));
+	}
+
 	// build item list - not every frame please!
 	if (state.IsCodeAnalysisDataDirty() )
 	{
-		const float line_height = ImGui::GetTextLineHeight();
-		
-		state.ItemList.clear();
-		FCommentLine::FreeAll();	// recycle comment lines
-
 		//int nextItemAddress = 0;
 
-		auto& banks = state.GetBanks();
-		for (auto& bank : banks)
-		{
-			if (bank.bIsDirty || bank.ItemList.empty())
-			{
-				UpdateItemListForBank(state, bank);
-				bank.bIsDirty = false;
-			}
-		}
-		int pageNo = 0;
+		// only dirty pages are rebuilt
+		for (auto& bank : state.GetBanks())
+			UpdateItemListForBank(state, bank);
 
-		while (pageNo < FCodeAnalysisState::kNoPagesInAddressSpace)
-		{
-			int16_t bankId = state.GetBankFromAddress(pageNo * FCodeAnalysisPage::kPageSize);
-			FCodeAnalysisBank* pBank = state.GetBank(bankId);
-			if (pBank != nullptr)
-			{
-				state.ItemList.insert(state.ItemList.end(), pBank->ItemList.begin(), pBank->ItemList.end());
-				/*const uint16_t bankAddrStart = pageNo * FCodeAnalysisPage::kPageSize;
-				for (const auto& bankItem : pBank->ItemList)
-				{
-					FCodeAnalysisItem& item = state.ItemList.emplace_back(bankItem);
-					item.AddressRef.Address += bankAddrStart;
-				}*/
-				pageNo += pBank->NoPages;
-			}
-			else
-			{
-				pageNo++;
-			}
-		}
+		for (int pageNo = 0; pageNo < FCodeAnalysisState::kNoPagesInAddressSpace; pageNo++)
+			state.ItemList.SetSegment(pageNo, GetAddressSpaceSegment(state, pageNo));
+		state.ItemList.UpdateSegmentStarts();
 
 		// Maybe this needs to follow the same algorithm as the main view?
 		//ImGui::SetScrollY(state.GetFocussedViewState().CursorItemIndex * line_height);
 		state.ClearDirtyStatus();
 
-		if (state.HasMemoryBeenRemapped())
+		// nothing in the item lists points at removed items now
+		state.FreeRemovedItems();
+	}
+	else if (state.HasMemoryBeenRemapped())
+	{
+		// bank switch - just swap in the segments for the remapped pages
+		for (uint64_t remappedPages = state.GetRemappedPages(); remappedPages != 0; remappedPages &= remappedPages - 1)
 		{
-			GenerateGlobalInfo(state);
-			state.ClearRemappings();
+			const int pageNo = LowestSetBit(remappedPages);
+			state.ItemList.SetSegment(pageNo, GetAddressSpaceSegment(state, pageNo));
 		}
+		state.ItemList.UpdateSegmentStarts();
 	}
 
+	// global info is kept up to date as banks are mapped
+	state.ClearRemappings();
 }
 
 void DoItemContextMenu(FCodeAnalysisState& state, const FCodeAnalysisItem &item)
@@ -890,38 +941,38 @@ void DrawDebuggerButtons(FCodeAnalysisState &state, FCodeAnalysisViewState& view
 	{
 		if (ImGui::Button("Continue (F5)"))
 		{
-			state.Debugger.Continue();
+			state.Debugger.QueueCommand(EDebugCommand::Continue);
 		}
 	}
 	else
 	{
 		if (ImGui::Button("Break (F5)"))
 		{
-			state.Debugger.Break();
+			state.Debugger.QueueCommand(EDebugCommand::Break);
 			//viewState.TrackPCFrame = true;
 		}
 	}
 	ImGui::SameLine();
 	if (ImGui::Button("Step Over (F10)"))
 	{
-		state.Debugger.StepOver();
+		state.Debugger.QueueCommand(EDebugCommand::StepOver);
 		viewState.TrackPCFrame = true;
 	}
 	ImGui::SameLine();
 	if (ImGui::Button("Step Into (F11)"))
 	{
-		state.Debugger.StepInto();
+		state.Debugger.QueueCommand(EDebugCommand::StepInto);
 		viewState.TrackPCFrame = true;
 	}
 	ImGui::SameLine();
 	if (ImGui::Button("Step Frame (F6)"))
 	{
-		state.Debugger.StepFrame();
+		state.Debugger.QueueCommand(EDebugCommand::StepFrame);
 	}
 	ImGui::SameLine();
 	if (ImGui::Button("Step Screen Write (F7)"))
 	{
-		state.Debugger.StepScreenWrite();
+		state.Debugger.QueueCommand(EDebugCommand::StepScreenWrite);
 	}
 	ImGui::SameLine();
 	if (ImGui::Button("<<< Trace"))
@@ -937,7 +988,7 @@ void DrawDebuggerButtons(FCodeAnalysisState &state, FCodeAnalysisViewState& view
 	//ImGui::Checkbox("Jump to PC on break", &bJumpToPCOnBreak);
 }
 
-void DrawItemList(FCodeAnalysisState& state, FCodeAnalysisViewState& viewState, const std::vector<FCodeAnalysisItem>&	itemList)
+void DrawItemList(FCodeAnalysisState& state, FCodeAnalysisViewState& viewState, const FItemList& itemList)
 {
 	const float lineHeight = ImGui::GetTextLineHeight();
 	FAddressRef& gotoAddress = viewState.GetGotoAddress();
@@ -948,31 +999,33 @@ void DrawItemList(FCodeAnalysisState& state, FCodeAnalysisViewState& viewState,
 		const float currScrollY = ImGui::GetScrollY();
 		const float currWindowHeight = ImGui::GetWindowHeight();
 		const int kJumpViewOffset = 5;
-		for (int item = 0; item < (int)itemList.size(); item++)
+
+		// find first item at or after the address - skipping labels if we don't want them
+		int item = viewState.ViewingBankId == -1 ? state.GetItemListIndex(gotoAddress) : state.GetBankItemListIndex(FAddressRef(viewState.ViewingBankId, gotoAddress.Address));
+		while (item != -1 && item < (int)itemList.size() && viewState.GoToLabel == false && itemList[item].Item->Type == EItemType::Label)
+			item++;
+
+		if (item != -1 && item < (int)itemList.size())
 		{
-			if ((itemList[item].AddressRef.Address >= gotoAddress.Address) && (viewState.GoToLabel || itemList[item].Item->Type != EItemType::Label))
-			{
-				// set cursor
-				viewState.SetCursorItem(itemList[item]);
+			// set cursor
+			viewState.SetCursorItem(itemList[item]);
 
-				const float itemY = item * lineHeight;
-				const float margin = kJumpViewOffset * lineHeight;
+			const float itemY = item * lineHeight;
+			const float margin = kJumpViewOffset * lineHeight;
 
-				const float moveDist = itemY - currScrollY;
+			const float moveDist = itemY - currScrollY;
 
-				if (moveDist > currWindowHeight)
-				{
-					const int gotoItem = std::max(item - kJumpViewOffset, 0);
-					ImGui::SetScrollY(gotoItem * lineHeight);
-				}
-				else
-				{
-					if (itemY < currScrollY + margin)
-						ImGui::SetScrollY(itemY - margin);
-					if (itemY > currScrollY + currWindowHeight - margin * 2)
-						ImGui::SetScrollY((itemY - currWindowHeight) + margin * 2);
-				}
-				break;	// exit loop as we've found the address
+			if (moveDist > currWindowHeight)
+			{
+				const int gotoItem = std::max(item - kJumpViewOffset, 0);
+				ImGui::SetScrollY(gotoItem * lineHeight);
+			}
+			else
+			{
+				if (itemY < currScrollY + margin)
+					ImGui::SetScrollY(itemY - margin);
+				if (itemY > currScrollY + currWindowHeight - margin * 2)
+					ImGui::SetScrollY((itemY - currWindowHeight) + margin * 2);
 			}
 		}
 
@@ -1013,9 +1066,6 @@ void DrawCodeAnalysisData(FCodeAnalysisState &state, int windowId)
 	viewState.HighlightAddress = viewState.HoverAddress;
 	viewState.HoverAddress.SetInvalid();
 
-	if (state.Debugger.IsStopped() == false)
-		state.CurrentFrameNo++;
-
 	UpdateItemList(state);
 
 	if (ImGui::ArrowButton("##btn", ImGuiDir_Left))
@@ -1110,7 +1160,7 @@ void DrawCodeAnalysisData(FCodeAnalysisState &state, int windowId)
 
 					tabFlags = (bSwitchTabs && showBank == bank.Id) ? ImGuiTabItemFlags_SetSelected : 0;
 
-					const bool bMapped = bank.MappedPages.empty() == false;
+					const bool bMapped = bank.IsMapped();
 					if (!bMapped)
 						ImGui::PushStyleColor(ImGuiCol_Text, IM_COL32(255, 144, 144, 144));
 					const bool bTabOpen = ImGui::BeginTabItem(bank.Name.c_str(), nullptr, tabFlags);
@@ -1414,6 +1464,8 @@ void GenerateFilteredLabelList(FCodeAnalysisState& state, const FLabelListFilter
 
 void DrawGlobals(FCodeAnalysisState &state, FCodeAnalysisViewState& viewState)
 {
+	UpdateGlobalInfo(state);
+
 	if (ImGui::InputText("Filter", &viewState.FilterText))
 	{
 		viewState.GlobalFunctionsFilter.FilterText = viewState.FilterText;
@@ -1630,6 +1682,12 @@ bool DrawBankInput(FCodeAnalysisState& state, const char* label, int16_t& bankId
 
 // Config Window - Debug?
 
+template <class T, int SlabSize>
+static void DrawSlabArenaOccupancy(const char* pName, const FSlabArena<T, SlabSize>& arena)
+{
+	ImGui::Text("%s: %d used, %d free, %d capacity (%dK)", pName, (int)arena.GetNoAllocated(), (int)arena.GetNoFree(), (int)arena.GetCapacity(), (int)(arena.GetMemoryUsed() / 1024));
+}
+
 void DrawCodeAnalysisConfigWindow(FCodeAnalysisState& state)
 {
 	FCodeAnalysisConfig& config = state.Config;
@@ -1642,4 +1700,17 @@ void DrawCodeAnalysisConfigWindow(FCodeAnalysisState& state)
 	ImGui::SliderFloat("Branch Line Start", &config.BranchLineIndentStart, 0, 200.0f);
 	ImGui::SliderFloat("Branch Line Spacing", &config.BranchSpacing, 0, 20.0f);
 	ImGui::SliderInt("Branch Line No Indents", &config.BranchMaxIndent,1,10);
+
+	if (ImGui::CollapsingHeader("Item Arenas"))
+	{
+		DrawSlabArenaOccupancy("Labels", state.LabelArena);
+		DrawSlabArenaOccupancy("Code Info", state.CodeInfoArena);
+		DrawSlabArenaOccupancy("Comment Blocks", state.CommentBlockArena);
+	}
+
+	if (ImGui::CollapsingHeader("Disassembly Cache"))
+	{
+		const FDisassemblyCache& cache = state.DisassemblyCache;
+		ImGui::Text("%d/%d entries, %d hits, %d misses", (int)cache.GetNoEntries(), (int)cache.GetMaxEntries(), cache.GetNoHits(), cache.GetNoMisses());
+	}
 }
\ No newline at end of file
@@ -4,6 +4,7 @@
 #include "../CodeAnalyserTypes.h"
 
 struct FCodeAnalysisItem;
+struct FCodeAnalysisBank;
 class FCodeAnalysisState;
 struct FCodeAnalysisViewState;
 struct FDataInfo;
@@ -17,6 +18,8 @@ enum class EOperandType;
 class FMemoryRegionDescGenerator
 {
 public:
+	virtual ~FMemoryRegionDescGenerator() = default;
+
 	bool	InRegion(uint16_t addr) const
 	{
 		return addr >= RegionMin && addr <= RegionMax;
@@ -31,7 +34,7 @@ protected:
 
 // UI
 
-bool AddMemoryRegionDescGenerator(FMemoryRegionDescGenerator* pGen);
+bool AddMemoryRegionDescGenerator(FCodeAnalysisState& state, FMemoryRegionDescGenerator* pGen);	// state takes ownership
 
 void ShowCodeAccessorActivity(FCodeAnalysisState& state, const FAddressRef accessorCodeAddr);
 //void DrawCodeAddress(FCodeAnalysisState& state, FCodeAnalysisViewState& viewState, uint16_t addr, bool bFunctionRel = false);
@@ -43,6 +46,8 @@ void DrawCodeAnalysisItem(FCodeAnalysisState& state, FCodeAnalysisViewState& vie
 bool DrawNumberTypeCombo(const char* pLabel, ENumberDisplayMode& numberMode);
 bool DrawOperandTypeCombo(const char* pLabel, EOperandType& operandType);
 
+void UpdateItemListForBank(FCodeAnalysisState& state, FCodeAnalysisBank& bank);
+void UpdateItemList(FCodeAnalysisState& state);
 void DrawCodeAnalysisData(FCodeAnalysisState &state, int windowId);
 void DrawGlobals(FCodeAnalysisState& state, FCodeAnalysisViewState& viewState);
 
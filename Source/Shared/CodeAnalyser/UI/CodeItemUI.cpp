@@ -12,7 +12,8 @@ void ShowCodeAccessorActivity(FCodeAnalysisState& state, const FAddressRef acces
 	const FCodeInfo* pCodeInfo = state.GetCodeInfoForAddress(accessorCodeAddr);
 	if (pCodeInfo != nullptr)
 	{
-		const int framesSinceExecuted = pCodeInfo->FrameLastExecuted != -1 ? state.CurrentFrameNo - pCodeInfo->FrameLastExecuted : 255;
+		const int lastFrameExecuted = state.GetLastFrameExecutedForAddress(accessorCodeAddr);
+		const int framesSinceExecuted = lastFrameExecuted != -1 ? state.CurrentFrameNo - lastFrameExecuted : 255;
 		const int brightVal = (255 - std::min(framesSinceExecuted << 2, 255)) & 0xff;
 		const bool bPCLine = accessorCodeAddr == state.CPUInterface->GetPC();
 
@@ -221,8 +222,8 @@ void DrawCodeInfo(FCodeAnalysisState& state, FCodeAnalysisViewState& viewState,
 		dl->AddRectFilled(ImVec2(pos.x - 12, pos.y), ImVec2(pos.x - 8, pos.y + line_height), 0xFFFF0000);
 	}
 
-	// regenerate code text if it hasn't been generated or SMC
-	if (pCodeInfo->bSelfModifyingCode == true || pCodeInfo->Text.empty())
+	// regenerate code info for SMC
+	if (pCodeInfo->bSelfModifyingCode == true)
 	{
 		//UpdateCodeInfoForAddress(state, pCodeInfo->Address);
 		WriteCodeInfoForAddress(state, physAddress);
@@ -258,8 +259,7 @@ void DrawCodeInfo(FCodeAnalysisState& state, FCodeAnalysisViewState& viewState,
 
 			if (pCodeInfo->bSelfModifyingCode)
 			{
-				FDataInfo* pOperandData = state.GetWriteDataInfoForAddress(physAddress + i);
-				if (pOperandData->Writes.IsEmpty() == false)
+				if (state.GetDataWritesForAddress((uint16_t)(physAddress + i)).IsEmpty() == false)
 				{
 					// Change the colour if this is self modifying code and the byte has been modified.
 					bByteModified = true;
@@ -275,7 +275,7 @@ void DrawCodeInfo(FCodeAnalysisState& state, FCodeAnalysisViewState& viewState,
 		}
 	}
 
-	ImGui::Text("%s", pCodeInfo->Text.c_str());	// draw the disassembly output for this instruction
+	ImGui::Text("%s", GetDisassemblyText(state, physAddress, pCodeInfo).c_str());	// draw the disassembly output for this instruction
 
 	if (pCodeInfo->bNOPped)
 		ImGui::PopStyleColor();
@@ -305,8 +305,7 @@ void DrawCodeDetails(FCodeAnalysisState& state, FCodeAnalysisViewState& viewStat
 	FCodeInfo* pCodeInfo = static_cast<FCodeInfo*>(item.Item);
 	const uint16_t physAddress = item.AddressRef.Address;
 
-	if (DrawOperandTypeCombo("Operand Type", pCodeInfo->OperandType))
-		pCodeInfo->Text.clear();	// clear for a rewrite
+	DrawOperandTypeCombo("Operand Type", pCodeInfo->OperandType);	// disassembly text is keyed on operand type so will be regenerated
 
 	if (state.Config.bShowBanks && pCodeInfo->OperandType == EOperandType::Pointer)
 	{
@@ -346,11 +345,11 @@ void DrawCodeDetails(FCodeAnalysisState& state, FCodeAnalysisViewState& viewStat
 
 		for (int i = 1; i < pCodeInfo->ByteSize; i++)
 		{
-			FDataInfo* pOperandData = state.GetWriteDataInfoForAddress(physAddress + i);
-			if (pOperandData->Writes.IsEmpty() == false)
+			const FItemReferenceTracker& operandWrites = state.GetDataWritesForAddress((uint16_t)(physAddress + i));
+			if (operandWrites.IsEmpty() == false)
 			{
 				ImGui::Text("Operand Writes:");
-				for (const auto& writer : pOperandData->Writes.GetReferences())
+				for (const auto& writer : operandWrites.GetReferences())
 				{
 					DrawCodeAddress(state, viewState, writer);
 				}
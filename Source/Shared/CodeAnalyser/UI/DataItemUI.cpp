@@ -19,7 +19,7 @@ float DrawDataCharMapLine(FCodeAnalysisState& state,uint16_t addr, const FDataIn
 	const float startPos = pos.x;
 	pos.y -= rectSize + 2;
 
-	const FCharacterSet* pCharSet = GetCharacterSetFromAddress(pDataInfo->CharSetAddress);
+	const FCharacterSet* pCharSet = GetCharacterSetFromAddress(state, pDataInfo->CharSetAddress);
 
 	for (int byte = 0; byte < pDataInfo->ByteSize; byte++)
 	{
@@ -254,10 +254,10 @@ void EditWordDataItem(FCodeAnalysisState& state, uint16_t address)
 
 void ShowDataItemActivity(FCodeAnalysisState& state, FAddressRef addr)
 {
-	const FDataInfo* pReadDataInfo = state.GetReadDataInfoForAddress(addr);
-	const FDataInfo* pWriteDataInfo = state.GetWriteDataInfoForAddress(addr);
-	const int framesSinceWritten = pWriteDataInfo->LastFrameWritten == -1 ? 255 : state.CurrentFrameNo - pWriteDataInfo->LastFrameWritten;
-	const int framesSinceRead = pReadDataInfo->LastFrameRead == -1 ? 255 : state.CurrentFrameNo - pReadDataInfo->LastFrameRead;
+	const int lastFrameWritten = state.GetLastFrameWrittenForAddress(addr);
+	const int lastFrameRead = state.GetLastFrameReadForAddress(addr);
+	const int framesSinceWritten = lastFrameWritten == -1 ? 255 : state.CurrentFrameNo - lastFrameWritten;
+	const int framesSinceRead = lastFrameRead == -1 ? 255 : state.CurrentFrameNo - lastFrameRead;
 	const int wBrightVal = (255 - std::min(framesSinceWritten << 2, 255)) & 0xff;
 	const int rBrightVal = (255 - std::min(framesSinceRead << 2, 255)) & 0xff;
 	float offset = 0;
@@ -539,10 +539,13 @@ void DrawDataValueGraphWord(FCodeAnalysisState& state, FAddressRef addressRef)
 }
 
 
-void DrawDataAccesses(FCodeAnalysisState& state, FCodeAnalysisViewState& viewState, FDataInfo* pDataInfo)
+void DrawDataAccesses(FCodeAnalysisState& state, FCodeAnalysisViewState& viewState, FAddressRef addr)
 {
+	const FItemReferenceTracker& reads = state.GetDataReadsForAddress(addr);
+	const FItemReferenceTracker& writes = state.GetDataWritesForAddress(addr);
+
 	// List Data accesses
-	if (pDataInfo->Reads.IsEmpty() == false)
+	if (reads.IsEmpty() == false)
 	{
 		static std::string commentTxt;
 		static bool bOverride = false;
@@ -560,7 +563,7 @@ void DrawDataAccesses(FCodeAnalysisState& state, FCodeAnalysisViewState& viewSta
 		}
 
 		ImGui::Text("Reads:");
-		for (const auto& reader : pDataInfo->Reads.GetReferences())
+		for (const auto& reader : reads.GetReferences())
 		{
 			ShowCodeAccessorActivity(state, reader);
 
@@ -578,9 +581,11 @@ void DrawDataAccesses(FCodeAnalysisState& state, FCodeAnalysisViewState& viewSta
 				}
 			}
 		}
+		if (reads.GetNoOverflowedAccesses() > 0)
+			ImGui::Text("   + %d accesses from untracked instructions", reads.GetNoOverflowedAccesses());
 	}
 
-	if (pDataInfo->Writes.IsEmpty() == false)
+	if (writes.IsEmpty() == false)
 	{
 		static std::string commentTxt;
 		static bool bOverride = false;
@@ -598,7 +603,7 @@ void DrawDataAccesses(FCodeAnalysisState& state, FCodeAnalysisViewState& viewSta
 		}
 
 		ImGui::Text("Writes:");
-		for (const auto& writer : pDataInfo->Writes.GetReferences())
+		for (const auto& writer : writes.GetReferences())
 		{
 			ShowCodeAccessorActivity(state, writer);
 
@@ -616,10 +621,12 @@ void DrawDataAccesses(FCodeAnalysisState& state, FCodeAnalysisViewState& viewSta
 				}
 			}
 		}
+		if (writes.GetNoOverflowedAccesses() > 0)
+			ImGui::Text("   + %d accesses from untracked instructions", writes.GetNoOverflowedAccesses());
 	}
 
 	// last writer to address
-	const FAddressRef lastWriter = pDataInfo->LastWriter;
+	const FAddressRef lastWriter = state.GetLastWriterForAddress(addr);
 	if (lastWriter.IsValid())
 	{
 		ImGui::Text("Last Writer: ");
@@ -690,7 +697,7 @@ void DrawDataDetails(FCodeAnalysisState& state, FCodeAnalysisViewState& viewStat
 			DrawAddressInput(state, "Attribs Address", params.AttribsAddress);
 		}
 
-		FCharacterSet *pCharSet = GetCharacterSetFromAddress(item.AddressRef);
+		FCharacterSet *pCharSet = GetCharacterSetFromAddress(state, item.AddressRef);
 		if (pCharSet != nullptr)
 		{
 			if (ImGui::Button("Update Character Set"))
@@ -785,6 +792,6 @@ void DrawDataDetails(FCodeAnalysisState& state, FCodeAnalysisViewState& viewStat
 		break;
 	}
 
-	DrawDataAccesses(state, viewState, pDataInfo);
+	DrawDataAccesses(state, viewState, item.AddressRef);
 }
 
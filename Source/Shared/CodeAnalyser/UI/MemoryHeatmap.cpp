@@ -0,0 +1,124 @@
+#include "MemoryHeatmap.h"
+
+#include "../CodeAnalyser.h"
+
+#include <algorithm>
+#include <cassert>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define HEATMAP_SSE2 1
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(_M_ARM64)
+#define HEATMAP_NEON 1
+#include <arm_neon.h>
+#endif
+
+// Scalar version - used for the bytes left over after the vector loop & on targets without SIMD
+static inline bool IsRecentFrame(int lastFrame, int currentFrameNo, int frameThreshold)
+{
+	return lastFrame != -1 && currentFrameNo - lastFrame < frameThreshold;
+}
+
+static inline uint8_t GetHeatmapColour(const FCodeAnalysisPage& page, uint16_t pageAddr, int currentFrameNo, int frameThreshold)
+{
+	if (IsRecentFrame(page.LastFrameExecuted[pageAddr], currentFrameNo, frameThreshold))
+		return (uint8_t)EHeatmapColour::Executed;
+	if (IsRecentFrame(page.LastFrameWritten[pageAddr], currentFrameNo, frameThreshold))
+		return (uint8_t)EHeatmapColour::Written;
+	if (IsRecentFrame(page.LastFrameRead[pageAddr], currentFrameNo, frameThreshold))
+		return (uint8_t)EHeatmapColour::Read;
+	return (uint8_t)EHeatmapColour::None;
+}
+
+#if HEATMAP_SSE2
+// Colours for 4 bytes - one per 32 bit lane
+static inline __m128i GetRecentFrameMask(const int32_t* pLastFrame, __m128i currentFrameNo, __m128i frameThreshold)
+{
+	const __m128i lastFrame = _mm_loadu_si128((const __m128i*)pLastFrame);
+	const __m128i bRecent = _mm_cmplt_epi32(_mm_sub_epi32(currentFrameNo, lastFrame), frameThreshold);
+	const __m128i bNeverAccessed = _mm_cmpeq_epi32(lastFrame, _mm_set1_epi32(-1));
+	return _mm_andnot_si128(bNeverAccessed, bRecent);
+}
+
+static inline __m128i SelectColour(__m128i mask, EHeatmapColour colour, __m128i otherColours)
+{
+	return _mm_or_si128(_mm_and_si128(mask, _mm_set1_epi32((int)colour)), _mm_andnot_si128(mask, otherColours));
+}
+
+static inline __m128i GetHeatmapColours4(const FCodeAnalysisPage& page, uint16_t pageAddr, __m128i currentFrameNo, __m128i frameThreshold)
+{
+	__m128i colours = _mm_set1_epi32((int)EHeatmapColour::None);
+	colours = SelectColour(GetRecentFrameMask(&page.LastFrameRead[pageAddr], currentFrameNo, frameThreshold), EHeatmapColour::Read, colours);
+	colours = SelectColour(GetRecentFrameMask(&page.LastFrameWritten[pageAddr], currentFrameNo, frameThreshold), EHeatmapColour::Written, colours);
+	colours = SelectColour(GetRecentFrameMask(&page.LastFrameExecuted[pageAddr], currentFrameNo, frameThreshold), EHeatmapColour::Executed, colours);
+	return colours;
+}
+#elif HEATMAP_NEON
+// Colours for 4 bytes - one per 32 bit lane
+static inline uint32x4_t GetRecentFrameMask(const int32_t* pLastFrame, int32x4_t currentFrameNo, int32x4_t frameThreshold)
+{
+	const int32x4_t lastFrame = vld1q_s32(pLastFrame);
+	const uint32x4_t bRecent = vcltq_s32(vsubq_s32(currentFrameNo, lastFrame), frameThreshold);
+	const uint32x4_t bNeverAccessed = vceqq_s32(lastFrame, vdupq_n_s32(-1));
+	return vbicq_u32(bRecent, bNeverAccessed);
+}
+
+static inline uint16x4_t GetHeatmapColours4(const FCodeAnalysisPage& page, uint16_t pageAddr, int32x4_t currentFrameNo, int32x4_t frameThreshold)
+{
+	uint32x4_t colours = vdupq_n_u32((uint32_t)EHeatmapColour::None);
+	colours = vbslq_u32(GetRecentFrameMask(&page.LastFrameRead[pageAddr], currentFrameNo, frameThreshold), vdupq_n_u32((uint32_t)EHeatmapColour::Read), colours);
+	colours = vbslq_u32(GetRecentFrameMask(&page.LastFrameWritten[pageAddr], currentFrameNo, frameThreshold), vdupq_n_u32((uint32_t)EHeatmapColour::Written), colours);
+	colours = vbslq_u32(GetRecentFrameMask(&page.LastFrameExecuted[pageAddr], currentFrameNo, frameThreshold), vdupq_n_u32((uint32_t)EHeatmapColour::Executed), colours);
+	return vmovn_u32(colours);
+}
+#endif
+
+void GetPageHeatmapColours(const FCodeAnalysisPage& page, uint16_t pageAddr, int noBytes, int currentFrameNo, int frameThreshold, uint8_t* pOutColours)
+{
+	assert(pageAddr + noBytes <= FCodeAnalysisPage::kPageSize);
+	int byteNo = 0;
+
+	// 16 bytes at a time
+#if HEATMAP_SSE2
+	const __m128i currentFrameNoVec = _mm_set1_epi32(currentFrameNo);
+	const __m128i frameThresholdVec = _mm_set1_epi32(frameThreshold);
+	for (; byteNo + 16 <= noBytes; byteNo += 16)
+	{
+		const uint16_t addr = (uint16_t)(pageAddr + byteNo);
+		const __m128i colours0 = GetHeatmapColours4(page, addr, currentFrameNoVec, frameThresholdVec);
+		const __m128i colours1 = GetHeatmapColours4(page, addr + 4, currentFrameNoVec, frameThresholdVec);
+		const __m128i colours2 = GetHeatmapColours4(page, addr + 8, currentFrameNoVec, frameThresholdVec);
+		const __m128i colours3 = GetHeatmapColours4(page, addr + 12, currentFrameNoVec, frameThresholdVec);
+		const __m128i colours = _mm_packus_epi16(_mm_packs_epi32(colours0, colours1), _mm_packs_epi32(colours2, colours3));
+		_mm_storeu_si128((__m128i*)&pOutColours[byteNo], colours);
+	}
+#elif HEATMAP_NEON
+	const int32x4_t currentFrameNoVec = vdupq_n_s32(currentFrameNo);
+	const int32x4_t frameThresholdVec = vdupq_n_s32(frameThreshold);
+	for (; byteNo + 16 <= noBytes; byteNo += 16)
+	{
+		const uint16_t addr = (uint16_t)(pageAddr + byteNo);
+		const uint16x8_t colours01 = vcombine_u16(GetHeatmapColours4(page, addr, currentFrameNoVec, frameThresholdVec), GetHeatmapColours4(page, addr + 4, currentFrameNoVec, frameThresholdVec));
+		const uint16x8_t colours23 = vcombine_u16(GetHeatmapColours4(page, addr + 8, currentFrameNoVec, frameThresholdVec), GetHeatmapColours4(page, addr + 12, currentFrameNoVec, frameThresholdVec));
+		vst1q_u8(&pOutColours[byteNo], vcombine_u8(vmovn_u16(colours01), vmovn_u16(colours23)));
+	}
+#endif
+
+	for (; byteNo < noBytes; byteNo++)
+		pOutColours[byteNo] = GetHeatmapColour(page, (uint16_t)(pageAddr + byteNo), currentFrameNo, frameThreshold);
+}
+
+void GetBankHeatmapColours(const FCodeAnalysisBank& bank, uint16_t bankAddr, int noBytes, int currentFrameNo, int frameThreshold, uint8_t* pOutColours)
+{
+	while (noBytes > 0)
+	{
+		bankAddr &= bank.SizeMask;
+		const uint16_t pageAddr = bankAddr & FCodeAnalysisPage::kPageMask;
+		const int noPageBytes = std::min(noBytes, FCodeAnalysisPage::kPageSize - pageAddr);
+		GetPageHeatmapColours(bank.Pages[bankAddr >> FCodeAnalysisPage::kPageShift], pageAddr, noPageBytes, currentFrameNo, frameThreshold, pOutColours);
+
+		bankAddr += noPageBytes;
+		pOutColours += noPageBytes;
+		noBytes -= noPageBytes;
+	}
+}
@@ -0,0 +1,23 @@
+#pragma once
+
+#include <cstdint>
+
+struct FCodeAnalysisPage;
+struct FCodeAnalysisBank;
+
+// Heatmap palette indices - recently executed code takes priority over writes, writes over reads
+enum class EHeatmapColour : uint8_t
+{
+	Written = 2,	// red
+	Read = 4,		// green
+	Executed = 6,	// yellow
+	None = 7,		// white
+};
+
+// Heatmap colour for a run of bytes in a page, from the page's last access frame arrays
+// An access counts if it happened less than frameThreshold frames ago
+// pageAddr + noBytes must not go past the end of the page
+void GetPageHeatmapColours(const FCodeAnalysisPage& page, uint16_t pageAddr, int noBytes, int currentFrameNo, int frameThreshold, uint8_t* pOutColours);
+
+// As above for a run of bytes in a bank - crosses pages & wraps at the end of the bank
+void GetBankHeatmapColours(const FCodeAnalysisBank& bank, uint16_t bankAddr, int noBytes, int currentFrameNo, int frameThreshold, uint8_t* pOutColours);
@@ -1,137 +1,77 @@
 #include "CodeAnalyserZ80.h"
 #include "../CodeAnalyser.h"
+#include "Z80OpcodeInfo.h"
 #include <cassert>
 
 #include "chips/z80.h"
 
 
-bool CheckPointerIndirectionInstructionZ80(FCodeAnalysisState& state, uint16_t pc, uint16_t* out_addr)
+// Look up the opcode at pc in the table for its prefix
+// operandAddr is set to the address of the first byte after the opcode
+static const FZ80OpcodeInfo& GetOpcodeInfo(FCodeAnalysisState& state, uint16_t pc, uint16_t& operandAddr)
 {
 	const uint8_t instrByte = state.ReadByte(pc);
+	const EZ80OpcodeTable table = GetZ80OpcodeTableForPrefix(instrByte);
 
-	switch (instrByte)
-	{
-		// LD (nnnn),x
-	case 0x22:
-	case 0x32:
-		// LD x,(nnnn)
-	case 0x2A:
-	case 0x3A:
-		*out_addr = state.ReadWord(pc + 1);
-		return true;
-	
-		// extended instructions
-	case 0xED:
+	if (table == EZ80OpcodeTable::Base)
 	{
-		const uint8_t exInstrByte = state.ReadByte(pc + 1);
-		switch (exInstrByte)
-		{
-		case 0x43://ld (**),bc
-		case 0x4B://ld bc,(**)
-		case 0x53://ld (**),de
-		case 0x5B://ld de,(**)
-		case 0x63://ld (**),hl
-		case 0x6B://ld hl,(**)
-		case 0x73://ld (**),sp
-		case 0x7B://ld sp,(**)
-			*out_addr = state.ReadWord(pc + 2);
-			return true;
-		}
-
+		operandAddr = pc + 1;
+		return GetZ80OpcodeInfo(table, instrByte);
 	}
-	return false;
 
-	// IX/IY instructions
-	case 0xDD:
-	case 0xFD:
-	{
-		const uint8_t exInstrByte = state.ReadByte(pc + 1);
-		switch (exInstrByte)
-		{
-		case 0x22://ld (**),ix/iy
-		case 0x2A://ld ix/iy,(**)
-			*out_addr = state.ReadWord(pc + 2);
-			return true;
-		}
-	}
-	}
+	operandAddr = pc + 2;
+	return GetZ80OpcodeInfo(table, state.ReadByte(pc + 1));
+}
 
-	return false;
+bool CheckPointerIndirectionInstructionZ80(FCodeAnalysisState& state, uint16_t pc, uint16_t* out_addr)
+{
+	uint16_t operandAddr;
+	const FZ80OpcodeInfo& opcodeInfo = GetOpcodeInfo(state, pc, operandAddr);
+
+	if (opcodeInfo.Operand != EZ80Operand::IndirectAddress)
+		return false;
+
+	*out_addr = state.ReadWord(operandAddr);
+	return true;
 }
 
 
 bool CheckPointerRefInstructionZ80(FCodeAnalysisState& state, uint16_t pc, uint16_t* out_addr)
 {
-	if (CheckPointerIndirectionInstructionZ80(state, pc, out_addr))
-		return true;
-
-	const uint8_t instrByte = state.ReadByte(pc);
+	uint16_t operandAddr;
+	const FZ80OpcodeInfo& opcodeInfo = GetOpcodeInfo(state, pc, operandAddr);
 
-	switch (instrByte)
-	{
-		// LD x,nnnn
-	case 0x01:
-	case 0x11:
-	case 0x21:
-	case 0x31:
-		*out_addr = state.ReadWord(pc + 1);
-		return true;
+	if (opcodeInfo.Operand != EZ80Operand::IndirectAddress && opcodeInfo.Operand != EZ80Operand::ImmediateWord)
+		return false;
 
-		// IX/IY instructions
-	case 0xDD:
-	case 0xFD:
-		{
-			const uint8_t exInstrByte = state.ReadByte(pc + 1);
-			switch (exInstrByte)
-			{
-			case 0x21://ld ix/iy,**
-				*out_addr = state.ReadWord(pc + 2);
-				return true;
-			}
-		}
-	}
-	return false;
+	*out_addr = state.ReadWord(operandAddr);
+	return true;
 }
 
 bool CheckJumpInstructionZ80(FCodeAnalysisState& state, uint16_t pc, uint16_t* out_addr)
 {
-	const uint8_t instrByte = state.ReadByte(pc);
+	uint16_t operandAddr;
+	const FZ80OpcodeInfo& opcodeInfo = GetOpcodeInfo(state, pc, operandAddr);
 
-	switch (instrByte)
+	switch (opcodeInfo.Operand)
 	{
-		/* CALL nnnn */
-	case 0xCD:
-		/* CALL cc,nnnn */
-	case 0xDC: case 0xFC: case 0xD4: case 0xC4:
-	case 0xF4: case 0xEC: case 0xE4: case 0xCC:
-		/* JP nnnn */
-	case 0xC3:
-		/* JP cc,nnnn */
-	case 0xDA: case 0xFA: case 0xD2: case 0xC2:
-	case 0xF2: case 0xEA: case 0xE2: case 0xCA:
-		*out_addr = state.ReadWord(pc + 1);
+	case EZ80Operand::JumpAddress:
+		*out_addr = state.ReadWord(operandAddr);
 		return true;
-
-		/* DJNZ d */
-	case 0x10:
-		/* JR d */
-	case 0x18:
-		/* JR cc,d */
-	case 0x38: case 0x30: case 0x20: case 0x28:
+	case EZ80Operand::RelativeJump:
 	{
-		const int8_t relJump = (int8_t)state.ReadByte(pc + 1);
-		*out_addr = pc + 2 + relJump;	// +2 because it's relative to the next instruction
+		const int8_t relJump = (int8_t)state.ReadByte(operandAddr);
+		*out_addr = operandAddr + 1 + relJump;	// relative to the next instruction
 	}
 	return true;
-	/* RST */
-	case 0xC7:  *out_addr = 0x00; return true;
-	case 0xCF:  *out_addr = 0x08; return true;
-	case 0xD7:  *out_addr = 0x10; return true;
-	case 0xDF:  *out_addr = 0x18; return true;
-	case 0xE7:  *out_addr = 0x20; return true;
-	case 0xEF:  *out_addr = 0x28; return true;
-	case 0xF7:  *out_addr = 0x30; return true;
-	case 0xFF:  *out_addr = 0x38; return true;
+	default:
+		break;
+	}
+
+	if (opcodeInfo.Flow == EZ80Flow::Rst)
+	{
+		*out_addr = opcodeInfo.RstAddress;
+		return true;
 	}
 
 	return false;
@@ -139,190 +79,58 @@ bool CheckJumpInstructionZ80(FCodeAnalysisState& state, uint16_t pc, uint16_t* o
 
 bool CheckCallInstructionZ80(FCodeAnalysisState& state, uint16_t pc)
 {
-	const uint8_t instrByte = state.ReadByte(pc);
+	uint16_t operandAddr;
+	const FZ80OpcodeInfo& opcodeInfo = GetOpcodeInfo(state, pc, operandAddr);
 
-	switch (instrByte)
-	{
-		/* CALL nnnn */
-	case 0xCD:
-		/* CALL cc,nnnn */
-	case 0xDC: case 0xFC: case 0xD4: case 0xC4:
-	case 0xF4: case 0xEC: case 0xE4: case 0xCC:
-		/* RST */
-	case 0xC7:
-	case 0xCF:
-	case 0xD7:
-	case 0xDF:
-	case 0xE7:
-	case 0xEF:
-	case 0xF7:
-	case 0xFF:
-		return true;
-	}
-	return false;
+	return opcodeInfo.Flow == EZ80Flow::Call || opcodeInfo.Flow == EZ80Flow::Rst;
 }
 
 bool CheckStopInstructionZ80(FCodeAnalysisState& state, uint16_t pc)
 {
-	const uint8_t instrByte = state.ReadByte(pc);
-
-	switch (instrByte)
-	{
-		/* CALL nnnn */
-	case 0xCD:
-		/* CALL cc,nnnn */
-	case 0xDC: case 0xFC: case 0xD4: case 0xC4:
-	case 0xF4: case 0xEC: case 0xE4: case 0xCC:
-		/* RST */
-	case 0xC7:
-	case 0xCF:
-	case 0xD7:
-	case 0xDF:
-	case 0xE7:
-	case 0xEF:
-	case 0xF7:
-	case 0xFF:
-		// ret
-	case 0xC8:
-	case 0xC9:
-	case 0xD8:
-	case 0xE8:
-	case 0xF8:
-
-
-	case 0xc3:// jp
-	case 0xe9:// jp(hl)
-	case 0x18://jr
-		return true;
-	case 0xED:	// extended instructions
-	{
-		const uint8_t extInstrByte = state.ReadByte(pc + 1);
-		switch (extInstrByte)
-		{
-		case 0x4D:	// more RET functions
-		case 0x5D:
-		case 0x6D:
-		case 0x7D:
-		case 0x45:
-		case 0x55:
-		case 0x65:
-		case 0x75:
-			return true;
-		}
-	}
-	return false;
-	// index register instructions
-	case 0xDD:	// IX
-	case 0xFD:	// IY
-	{
-		const uint8_t extInstrByte = state.ReadByte(pc + 1);
-		switch (extInstrByte)
-		{
-		case 0xE9:	// JP(IX)
-			return true;
-		}
-		return false;
-	}
-	default:
-		return false;
-	}
+	uint16_t operandAddr;
+	return GetOpcodeInfo(state, pc, operandAddr).bStopsAnalysis;
 }
 
 bool RegisterCodeExecutedZ80(FCodeAnalysisState& state, uint16_t pc, uint16_t oldpc)
 {
-	const ICPUInterface* pCPUInterface = state.CPUInterface;
 	FDebugger& debugger = state.Debugger;
-	const uint8_t opcode = pCPUInterface->ReadByte(pc);
-	const uint8_t oldOpcode = pCPUInterface->ReadByte(oldpc);
+	const uint8_t opcode = state.ReadByte(pc);
+	const uint8_t oldOpcode = state.ReadByte(oldpc);
 	const z80_t* pCPU = static_cast<z80_t*>(state.CPUInterface->GetCPUEmulator());
 
 	std::vector<FCPUFunctionCall>&	callStack = state.Debugger.GetCallstack();
 
 	//const FZ80InternalState& cpuState = pCPU->internal_state;
 
-	bool bPushInstruction = false;
-	
 	// check current op code
-	switch (opcode)
+	const EZ80OpcodeTable opcodeTable = GetZ80OpcodeTableForPrefix(opcode);
+	const uint16_t operandAddr = opcodeTable == EZ80OpcodeTable::Base ? pc + 1 : pc + 2;
+	const FZ80OpcodeInfo& opcodeInfo = GetZ80OpcodeInfo(opcodeTable, opcodeTable == EZ80OpcodeTable::Base ? opcode : state.ReadByte(pc + 1));
+
+	const bool bPushInstruction = opcodeInfo.StackOp == EZ80StackOp::Push;
+	
+	switch (opcodeInfo.StackOp)
 	{
-		// Stack
-		case 0x31:	// LD SP,NN
-			{
-				const uint16_t newSP = state.ReadWord(pc + 1);
-				debugger.RegisterNewStackPointer(newSP,state.AddressRefFromPhysicalAddress(pc));
-			}
-			break;
-		case 0xF9:	// LD SP,HL
-			debugger.RegisterNewStackPointer(pCPU->hl, state.AddressRefFromPhysicalAddress(pc));
-			break;
-		case 0xc5:	// PUSH BC
-		case 0xd5:	// PUSH DE
-		case 0xe5:	// PUSH HL
-		case 0xf5:	// PUSH AF
-			bPushInstruction = true;
+	case EZ80StackOp::LoadSPImmediate:	// LD SP,NN
+		debugger.RegisterNewStackPointer(state.ReadWord(operandAddr), state.AddressRefFromPhysicalAddress(pc));
 		break;
-
-		
-		
-		// Call functions
-		/* CALL nnnn */
-		case 0xCD:
-			/* CALL cc,nnnn */
-		case 0xDC: case 0xFC: case 0xD4: case 0xC4:
-		case 0xF4: case 0xEC: case 0xE4: case 0xCC:
-			bPushInstruction = true;
-			break;
-
-			// index register opcodes
-		case 0xdd:
-		case 0xfd:
-		{
-			const bool bIX = opcode == 0xDD;
-			const uint8_t indexOpcode = pCPUInterface->ReadByte(pc + 1);
-			switch (indexOpcode)
-			{
-			case 0xF9:	// LD SP,IX/IY
-				debugger.RegisterNewStackPointer(bIX ? pCPU->ix : pCPU->iy, state.AddressRefFromPhysicalAddress(pc));
-				break;
-			case 0xe5:	// PUSH IX/IY
-				bPushInstruction = true;
-				break;
-			default:
-				break;
-			}
-		}
+	case EZ80StackOp::LoadSPHL:	// LD SP,HL
+		debugger.RegisterNewStackPointer(pCPU->hl, state.AddressRefFromPhysicalAddress(pc));
+		break;
+	case EZ80StackOp::LoadSPIndex:	// LD SP,IX/IY
+		debugger.RegisterNewStackPointer(opcode == 0xDD ? pCPU->ix : pCPU->iy, state.AddressRefFromPhysicalAddress(pc));
+		break;
+	case EZ80StackOp::LoadSPIndirect:	// LD SP,(nn)
+		debugger.RegisterNewStackPointer(state.ReadWord(state.ReadWord(operandAddr)), state.AddressRefFromPhysicalAddress(pc));
 		break;
-
-		case 0xed:
-		{
-			const uint8_t extendedOpcode = pCPUInterface->ReadByte(pc + 1);
-
-			switch (extendedOpcode)
-			{
-				case 0x7b:	// LD SP,(nn)
-				{
-					const uint16_t newSP = state.ReadWord(state.ReadWord(pc + 2));	// indirect
-					debugger.RegisterNewStackPointer(newSP, state.AddressRefFromPhysicalAddress(pc));
-				}
-				break;
-			}
-
-		}
-			break;
 	default:
 		break;
 	}
 
-	// TODO: check old opcode for jump/ret instructions
-	switch (oldOpcode)
+	// check old opcode for call/ret instructions
+	const FZ80OpcodeInfo& oldOpcodeInfo = GetZ80OpcodeInfo(EZ80OpcodeTable::Base, oldOpcode);
+	if (oldOpcodeInfo.Flow == EZ80Flow::Call)
 	{
-		// Call instructions
-		/* CALL nnnn */
-	case 0xCD:
-		/* CALL cc,nnnn */
-	case 0xDC: case 0xFC: case 0xD4: case 0xC4:
-	case 0xF4: case 0xEC: case 0xE4: case 0xCC:
-
 		if (pc != oldpc + 3)	// call instructions are 3 bytes
 		{
 			FCPUFunctionCall callInfo;
@@ -331,18 +139,9 @@ bool RegisterCodeExecutedZ80(FCodeAnalysisState& state, uint16_t pc, uint16_t ol
 			callInfo.ReturnAddr = state.AddressRefFromPhysicalAddress(oldpc + 3);
 			callStack.push_back(callInfo);
 		}
-
-		break;
-		// ret
-	case 0xC0:
-	case 0xC8:
-	case 0xC9:
-	case 0xD0:
-	case 0xD8:
-	case 0xE0:
-	case 0xE8:
-	case 0xF0:
-	case 0xF8:
+	}
+	else if (oldOpcodeInfo.Flow == EZ80Flow::Ret)
+	{
 		if (pc != oldpc + 1)	// ret instructions are 1 byte so if we're not on the next instruction, we've returned
 		{
 			if (callStack.empty() == false)
@@ -360,7 +159,6 @@ bool RegisterCodeExecutedZ80(FCodeAnalysisState& state, uint16_t pc, uint16_t ol
 
 			}
 		}
-		break;
 	}
 
 	// Handle push instruction
@@ -392,35 +190,41 @@ bool RegisterCodeExecutedZ80(FCodeAnalysisState& state, uint16_t pc, uint16_t ol
 	return false;
 }
 
-std::vector<FMachineStateZ80*> g_FreeMachineStates;
-std::vector<FMachineStateZ80*> g_AllocatedMachineStates;
-
 // Machine state & capture
-FMachineStateZ80* AllocateMachineStateZ80()
+FMachineStateZ80* AllocateMachineStateZ80(FCodeAnalysisState& state)
 {
 	FMachineStateZ80* pNewState = nullptr;
 	
-	if (g_FreeMachineStates.empty())
+	if (state.FreeMachineStateList.empty())
 	{
 		pNewState = new FMachineStateZ80;
 	}
 	else
 	{
-		pNewState = g_FreeMachineStates.back();
-		g_FreeMachineStates.pop_back();
+		pNewState = static_cast<FMachineStateZ80*>(state.FreeMachineStateList.back());
+		state.FreeMachineStateList.pop_back();
 	}
 
-	g_AllocatedMachineStates.push_back(pNewState);
+	state.AllocatedMachineStates.push_back(pNewState);
 	return pNewState;
 }
 
-void FreeMachineStatesZ80()
+void FreeMachineStatesZ80(FCodeAnalysisState& state)
 {
-	for (FMachineStateZ80* pState : g_AllocatedMachineStates)
+	for (FMachineState* pState : state.AllocatedMachineStates)
 	{
-		g_FreeMachineStates.push_back(pState);
+		state.FreeMachineStateList.push_back(pState);
 	}
-	g_AllocatedMachineStates.clear();
+	state.AllocatedMachineStates.clear();
+}
+
+void DeleteMachineStatesZ80(FCodeAnalysisState& state)
+{
+	FreeMachineStatesZ80(state);
+	for (FMachineState* pState : state.FreeMachineStateList)
+		delete static_cast<FMachineStateZ80*>(pState);
+
+	state.FreeMachineStateList.clear();
 }
 
 void CaptureMachineStateZ80(FMachineState* pMachineState, ICPUInterface* pCPUInterface)
@@ -34,6 +34,7 @@ bool CheckCallInstructionZ80(FCodeAnalysisState& state, uint16_t pc);
 bool CheckStopInstructionZ80(FCodeAnalysisState& state, uint16_t pc);
 bool RegisterCodeExecutedZ80(FCodeAnalysisState& state, uint16_t pc, uint16_t oldpc);
 
-FMachineStateZ80* AllocateMachineStateZ80();
-void FreeMachineStatesZ80();
+FMachineStateZ80* AllocateMachineStateZ80(FCodeAnalysisState& state);
+void FreeMachineStatesZ80(FCodeAnalysisState& state);
+void DeleteMachineStatesZ80(FCodeAnalysisState& state);
 void CaptureMachineStateZ80(FMachineState* pMachineState, ICPUInterface* pCPUInterface);
@@ -486,7 +486,7 @@ public:
     std::string				Text;
 };
 
-IDasmNumberOutput* g_pNumberOutputObj = nullptr;
+thread_local IDasmNumberOutput* g_pNumberOutputObj = nullptr;	// per thread as disassembly can run on several threads
 IDasmNumberOutput* GetNumberOutput()
 {
     return g_pNumberOutputObj;
@@ -583,7 +583,7 @@ public:
         }
     }
 
-    FCodeInfo* pCodeInfoItem = nullptr;
+    const FCodeInfo* pCodeInfoItem = nullptr;
 };
 
 
@@ -605,7 +605,7 @@ static void AnalysisOutputCB(char c, void* pUserData)
 }
 
 // Helper function to generate the disassembly for a code info item
-uint16_t Z80DisassembleCodeInfoItem(uint16_t pc, FCodeAnalysisState& state, FCodeInfo* pCodeInfo)
+uint16_t Z80DisassembleCodeInfoItem(uint16_t pc, FCodeAnalysisState& state, const FCodeInfo* pCodeInfo, std::string& outText)
 {
     FAnalysisDasmState dasmState;
     dasmState.pCodeInfoItem = pCodeInfo;
@@ -613,7 +613,7 @@ uint16_t Z80DisassembleCodeInfoItem(uint16_t pc, FCodeAnalysisState& state, FCod
     dasmState.CurrentAddress = pc;
     SetNumberOutput(&dasmState);
     const uint16_t newPC = z80dasm_op(pc, AnalysisDasmInputCB, AnalysisOutputCB, &dasmState);
-    pCodeInfo->Text = dasmState.Text;
+    outText = std::move(dasmState.Text);
     SetNumberOutput(nullptr);
     return newPC;
 }
@@ -621,7 +621,8 @@ uint16_t Z80DisassembleCodeInfoItem(uint16_t pc, FCodeAnalysisState& state, FCod
 
 struct FStepDasmData
 {
-    std::vector<uint8_t> Data;
+    uint8_t     Opcode = 0;
+    int         NoBytes = 0;
     FCodeAnalysisState* pCodeAnalysis = nullptr;
     uint16_t    PC = 0;
 };
@@ -632,7 +633,8 @@ static uint8_t StepOverDasmInCB(void* userData)
 
     // Get Opcode bytes
     uint8_t opcodeByte = pDasmData->pCodeAnalysis->ReadByte(pDasmData->PC++);
-    pDasmData->Data.push_back(opcodeByte);
+    if (pDasmData->NoBytes++ == 0)
+        pDasmData->Opcode = opcodeByte;
     return opcodeByte;
 }
 
@@ -648,7 +650,7 @@ uint16_t Z80DisassembleGetNextPC(uint16_t pc, FCodeAnalysisState& state, uint8_t
     dasmData.PC = pc;
     dasmData.pCodeAnalysis = &state;
     const uint16_t nextPC = z80dasm_op(pc, StepOverDasmInCB, nullptr, &dasmData);
-    opcode = dasmData.Data[0];
+    opcode = dasmData.Opcode;
     return nextPC;
 }
 
@@ -735,7 +737,7 @@ static uint8_t ExportDasmInputCB(void* pUserData)
 {
     FExportDasmState* pDasmState = (FExportDasmState*)pUserData;
 
-    return pDasmState->CodeAnalysisState->CPUInterface->ReadByte(pDasmState->CurrentAddress++);
+    return pDasmState->CodeAnalysisState->ReadByte(pDasmState->CurrentAddress++);
 }
 
 /* disassembler callback to output a character */
@@ -0,0 +1,182 @@
+#pragma once
+#include <cstdint>
+#include <array>
+
+// Compile time table of the Z80 opcode properties the analyser cares about
+// Indexed by prefix table & opcode byte - everything not listed is a plain instruction with no flow, pointer or stack effect
+
+enum class EZ80Flow : uint8_t
+{
+	None,
+	Jump,			// JP, JR, DJNZ
+	JumpIndirect,	// JP (HL/IX/IY)
+	Call,
+	Rst,
+	Ret,			// RET, RETI, RETN
+};
+
+enum class EZ80Operand : uint8_t
+{
+	None,
+	JumpAddress,		// 16 bit jump/call target
+	RelativeJump,		// 8 bit displacement from the next instruction
+	ImmediateWord,		// 16 bit immediate value - could be a pointer
+	IndirectAddress,	// 16 bit address of a memory operand - LD (nn),x & LD x,(nn)
+};
+
+enum class EZ80StackOp : uint8_t
+{
+	None,
+	Push,			// PUSH, CALL, RST
+	Pop,
+	LoadSPImmediate,// LD SP,nn
+	LoadSPHL,		// LD SP,HL
+	LoadSPIndex,	// LD SP,IX/IY
+	LoadSPIndirect,	// LD SP,(nn)
+};
+
+enum class EZ80OpcodeTable : uint8_t
+{
+	Base,
+	Extended,	// ED prefix
+	Index,		// DD/FD prefix
+
+	Count
+};
+
+struct FZ80OpcodeInfo
+{
+	EZ80Flow	Flow = EZ80Flow::None;
+	EZ80Operand	Operand = EZ80Operand::None;
+	EZ80StackOp	StackOp = EZ80StackOp::None;
+	uint8_t		RstAddress = 0;
+	bool		bConditional = false;
+	bool		bStopsAnalysis = false;	// static analysis doesn't continue to the next instruction
+};
+
+typedef std::array<FZ80OpcodeInfo, 256> FZ80OpcodeTable;
+
+constexpr FZ80OpcodeInfo MakeZ80FlowOpcode(EZ80Flow flow, EZ80Operand operand, bool bConditional, EZ80StackOp stackOp = EZ80StackOp::None)
+{
+	FZ80OpcodeInfo info;
+	info.Flow = flow;
+	info.Operand = operand;
+	info.StackOp = stackOp;
+	info.bConditional = bConditional;
+	// calls stop too - the called function may not return to the next instruction
+	info.bStopsAnalysis = flow == EZ80Flow::Call || flow == EZ80Flow::Rst || (flow != EZ80Flow::None && bConditional == false);
+	return info;
+}
+
+constexpr FZ80OpcodeInfo MakeZ80DataOpcode(EZ80Operand operand, EZ80StackOp stackOp = EZ80StackOp::None)
+{
+	FZ80OpcodeInfo info;
+	info.Operand = operand;
+	info.StackOp = stackOp;
+	return info;
+}
+
+constexpr FZ80OpcodeTable MakeZ80BaseOpcodeTable()
+{
+	FZ80OpcodeTable table = {};
+
+	table[0xC3] = MakeZ80FlowOpcode(EZ80Flow::Jump, EZ80Operand::JumpAddress, false);		// JP nn
+	table[0x18] = MakeZ80FlowOpcode(EZ80Flow::Jump, EZ80Operand::RelativeJump, false);	// JR d
+	table[0x10] = MakeZ80FlowOpcode(EZ80Flow::Jump, EZ80Operand::RelativeJump, true);	// DJNZ d
+	table[0xE9] = MakeZ80FlowOpcode(EZ80Flow::JumpIndirect, EZ80Operand::None, false);	// JP (HL)
+	table[0xCD] = MakeZ80FlowOpcode(EZ80Flow::Call, EZ80Operand::JumpAddress, false, EZ80StackOp::Push);	// CALL nn
+	table[0xC9] = MakeZ80FlowOpcode(EZ80Flow::Ret, EZ80Operand::None, false, EZ80StackOp::Pop);	// RET
+
+	for (int cc = 0; cc < 8; cc++)
+	{
+		table[0xC2 | (cc << 3)] = MakeZ80FlowOpcode(EZ80Flow::Jump, EZ80Operand::JumpAddress, true);	// JP cc,nn
+		table[0xC4 | (cc << 3)] = MakeZ80FlowOpcode(EZ80Flow::Call, EZ80Operand::JumpAddress, true, EZ80StackOp::Push);	// CALL cc,nn
+		table[0xC0 | (cc << 3)] = MakeZ80FlowOpcode(EZ80Flow::Ret, EZ80Operand::None, true, EZ80StackOp::Pop);	// RET cc
+
+		FZ80OpcodeInfo rst = MakeZ80FlowOpcode(EZ80Flow::Rst, EZ80Operand::None, false, EZ80StackOp::Push);	// RST n
+		rst.RstAddress = (uint8_t)(cc << 3);
+		table[0xC7 | (cc << 3)] = rst;
+	}
+
+	for (int cc = 0; cc < 4; cc++)
+		table[0x20 | (cc << 3)] = MakeZ80FlowOpcode(EZ80Flow::Jump, EZ80Operand::RelativeJump, true);	// JR cc,d
+
+	for (int rp = 0; rp < 4; rp++)
+	{
+		table[0x01 | (rp << 4)] = MakeZ80DataOpcode(EZ80Operand::ImmediateWord);	// LD rr,nn
+		table[0xC5 | (rp << 4)] = MakeZ80DataOpcode(EZ80Operand::None, EZ80StackOp::Push);	// PUSH rr
+		table[0xC1 | (rp << 4)] = MakeZ80DataOpcode(EZ80Operand::None, EZ80StackOp::Pop);	// POP rr
+	}
+	table[0x31].StackOp = EZ80StackOp::LoadSPImmediate;	// LD SP,nn
+
+	table[0x22] = MakeZ80DataOpcode(EZ80Operand::IndirectAddress);	// LD (nn),HL
+	table[0x32] = MakeZ80DataOpcode(EZ80Operand::IndirectAddress);	// LD (nn),A
+	table[0x2A] = MakeZ80DataOpcode(EZ80Operand::IndirectAddress);	// LD HL,(nn)
+	table[0x3A] = MakeZ80DataOpcode(EZ80Operand::IndirectAddress);	// LD A,(nn)
+
+	table[0xF9] = MakeZ80DataOpcode(EZ80Operand::None, EZ80StackOp::LoadSPHL);	// LD SP,HL
+
+	return table;
+}
+
+constexpr FZ80OpcodeTable MakeZ80ExtendedOpcodeTable()
+{
+	FZ80OpcodeTable table = {};
+
+	for (int rp = 0; rp < 4; rp++)
+	{
+		table[0x43 | (rp << 4)] = MakeZ80DataOpcode(EZ80Operand::IndirectAddress);	// LD (nn),rr
+		table[0x4B | (rp << 4)] = MakeZ80DataOpcode(EZ80Operand::IndirectAddress);	// LD rr,(nn)
+		table[0x45 | (rp << 4)] = MakeZ80FlowOpcode(EZ80Flow::Ret, EZ80Operand::None, false, EZ80StackOp::Pop);	// RETN
+		table[0x4D | (rp << 4)] = MakeZ80FlowOpcode(EZ80Flow::Ret, EZ80Operand::None, false, EZ80StackOp::Pop);	// RETI
+	}
+	table[0x7B].StackOp = EZ80StackOp::LoadSPIndirect;	// LD SP,(nn)
+
+	return table;
+}
+
+// IX & IY versions are the same
+constexpr FZ80OpcodeTable MakeZ80IndexOpcodeTable()
+{
+	FZ80OpcodeTable table = {};
+
+	table[0x21] = MakeZ80DataOpcode(EZ80Operand::ImmediateWord);		// LD IX,nn
+	table[0x22] = MakeZ80DataOpcode(EZ80Operand::IndirectAddress);		// LD (nn),IX
+	table[0x2A] = MakeZ80DataOpcode(EZ80Operand::IndirectAddress);		// LD IX,(nn)
+	table[0xE9] = MakeZ80FlowOpcode(EZ80Flow::JumpIndirect, EZ80Operand::None, false);	// JP (IX)
+	table[0xE5] = MakeZ80DataOpcode(EZ80Operand::None, EZ80StackOp::Push);	// PUSH IX
+	table[0xE1] = MakeZ80DataOpcode(EZ80Operand::None, EZ80StackOp::Pop);	// POP IX
+	table[0xF9] = MakeZ80DataOpcode(EZ80Operand::None, EZ80StackOp::LoadSPIndex);	// LD SP,IX
+
+	return table;
+}
+
+inline constexpr FZ80OpcodeTable g_Z80OpcodeTables[(int)EZ80OpcodeTable::Count] =
+{
+	MakeZ80BaseOpcodeTable(),
+	MakeZ80ExtendedOpcodeTable(),
+	MakeZ80IndexOpcodeTable(),
+};
+
+static_assert(g_Z80OpcodeTables[(int)EZ80OpcodeTable::Base][0xCF].RstAddress == 0x08, "RST table error");
+static_assert(g_Z80OpcodeTables[(int)EZ80OpcodeTable::Base][0x38].bConditional, "JR table error");
+static_assert(g_Z80OpcodeTables[(int)EZ80OpcodeTable::Extended][0x7D].Flow == EZ80Flow::Ret, "RETI table error");
+
+inline EZ80OpcodeTable GetZ80OpcodeTableForPrefix(uint8_t prefixByte)
+{
+	switch (prefixByte)
+	{
+	case 0xED:
+		return EZ80OpcodeTable::Extended;
+	case 0xDD:
+	case 0xFD:
+		return EZ80OpcodeTable::Index;
+	default:
+		return EZ80OpcodeTable::Base;
+	}
+}
+
+inline const FZ80OpcodeInfo& GetZ80OpcodeInfo(EZ80OpcodeTable table, uint8_t opcode)
+{
+	return g_Z80OpcodeTables[(int)table][opcode];
+}
@@ -3,6 +3,7 @@
 
 #include <stdio.h>
 #include <stdarg.h>
+#include <string>
 #ifdef _WIN32
 #include <Windows.h>
 #endif
@@ -44,12 +45,34 @@
 	fn(buf); 
 #endif
 
+static thread_local LogSinkFunc	t_LogSinkFunc = nullptr;
+static thread_local void*		t_pLogSinkUserData = nullptr;
+
+void SetThreadLogSink(LogSinkFunc sinkFunc, void* pUserData)
+{
+	t_LogSinkFunc = sinkFunc;
+	t_pLogSinkUserData = pUserData;
+}
+
+static void AddToLog(const char* pLevel, const char* str)
+{
+	if (t_LogSinkFunc != nullptr)
+	{
+		const std::string message = std::string(pLevel) + " " + str;
+		t_LogSinkFunc(message.c_str(), t_pLogSinkUserData);
+	}
+	else
+	{
+		g_ImGuiLog.AddLog("%s %s", pLevel, str);
+	}
+}
+
 void LogFatal(const char* str)
 {
 #ifdef WIN32
 	OutputDebugStringA(str);
 #endif
-	g_ImGuiLog.AddLog("[Fatal] %s", str);
+	AddToLog("[Fatal]", str);
 }
 
 void LogError(const char* str)
@@ -57,7 +80,7 @@ void LogError(const char* str)
 #ifdef WIN32
 	OutputDebugStringA(str);
 #endif
-	g_ImGuiLog.AddLog("[Error] %s", str);
+	AddToLog("[Error]", str);
 }
 
 void LogWarning(const char* str)
@@ -65,7 +88,7 @@ void LogWarning(const char* str)
 #ifdef WIN32
 	OutputDebugStringA(str);
 #endif
-	g_ImGuiLog.AddLog("[Warning] %s", str);
+	AddToLog("[Warning]", str);
 }
 
 void LogInfo(const char* str)
@@ -73,7 +96,7 @@ void LogInfo(const char* str)
 #ifdef WIN32
 	OutputDebugStringA(str);
 #endif
-	g_ImGuiLog.AddLog("[Info] %s", str);
+	AddToLog("[Info]", str);
 }
 
 void LogDebug(const char* str)
@@ -81,7 +104,7 @@ void LogDebug(const char* str)
 #ifdef WIN32
 	OutputDebugStringA(str);
 #endif
-	g_ImGuiLog.AddLog("[Debug] %s", str);
+	AddToLog("[Debug]", str);
 }
 
 void _LogFatalfLF(const char* fmt, ...)
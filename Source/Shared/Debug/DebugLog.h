@@ -11,3 +11,6 @@ void _LogDebugfLF(const char* fmt, ...);
 #define LOGINFO(...) 		_LogInfofLF(__VA_ARGS__)
 #define LOGDEBUG(...) 		_LogDebugfLF(__VA_ARGS__)
 
+// Log output can be sent somewhere other than the shared log on a per thread basis - e.g. so batch workers each keep their own log
+typedef void (*LogSinkFunc)(const char* pMessage, void* pUserData);
+void SetThreadLogSink(LogSinkFunc sinkFunc, void* pUserData);	// nullptr goes back to the shared log
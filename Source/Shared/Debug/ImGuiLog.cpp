@@ -1,5 +1,8 @@
 #include "ImGuiLog.h"
 
+#include <stdarg.h>
+#include <stdio.h>
+
 ImGuiLog g_ImGuiLog;
 
 ImGuiLog::ImGuiLog()
@@ -11,6 +14,7 @@ ImGuiLog::ImGuiLog()
 
 void    ImGuiLog::Clear()
 {
+	std::lock_guard<std::mutex> lock(LogMutex);
 	Buf.clear();
 	LineOffsets.clear();
 	LineOffsets.push_back(0);
@@ -18,19 +22,29 @@ void    ImGuiLog::Clear()
 
 void    ImGuiLog::AddLog(const char* fmt, ...)
 {
-	int old_size = Buf.size();
 	va_list args;
 	va_start(args, fmt);
-	Buf.appendfv(fmt, args);
+	va_list argsCopy;
+	va_copy(argsCopy, args);
+	const int len = vsnprintf(nullptr, 0, fmt, argsCopy);
+	va_end(argsCopy);
+
+	std::lock_guard<std::mutex> lock(LogMutex);
+	int old_size = (int)Buf.size();
+	if (len > 0)
+	{
+		Buf.resize(old_size + len + 1);
+		vsnprintf(&Buf[old_size], len + 1, fmt, args);
+		Buf.resize(old_size + len);	// drop the terminator
+	}
 	va_end(args);
-	for (int new_size = Buf.size(); old_size < new_size; old_size++)
+	for (int new_size = (int)Buf.size(); old_size < new_size; old_size++)
 	{
 		if (Buf[old_size] == '\n')
 			LineOffsets.push_back(old_size + 1);
 	}
 
-	if (AutoScroll)
-		ScrollToBottom = true;
+	bLinesAdded = true;
 }
 
 void    ImGuiLog::Draw(const char* title, bool* p_open)
@@ -68,19 +82,21 @@ void    ImGuiLog::Draw(const char* title, bool* p_open)
 	if (copy)
 		ImGui::LogToClipboard();
 
+	std::lock_guard<std::mutex> lock(LogMutex);
+	const int noLines = (int)LineOffsets.size();
 	ImGui::PushStyleVar(ImGuiStyleVar_ItemSpacing, ImVec2(0, 0));
-	const char* buf = Buf.begin();
-	const char* buf_end = Buf.end();
+	const char* buf = Buf.data();
+	const char* buf_end = buf + Buf.size();
 	if (Filter.IsActive())
 	{
 		// In this example we don't use the clipper when Filter is enabled.
 		// This is because we don't have a random access on the result on our filter.
 		// A real application processing logs with ten of thousands of entries may want to store the result of search/filter.
 		// especially if the filtering function is not trivial (e.g. reg-exp).
-		for (int line_no = 0; line_no < LineOffsets.Size; line_no++)
+		for (int line_no = 0; line_no < noLines; line_no++)
 		{
 			const char* line_start = buf + LineOffsets[line_no];
-			const char* line_end = (line_no + 1 < LineOffsets.Size) ? (buf + LineOffsets[line_no + 1] - 1) : buf_end;
+			const char* line_end = (line_no + 1 < noLines) ? (buf + LineOffsets[line_no + 1] - 1) : buf_end;
 			if (Filter.PassFilter(line_start, line_end))
 				ImGui::TextUnformatted(line_start, line_end);
 		}
@@ -97,13 +113,13 @@ void    ImGuiLog::Draw(const char* title, bool* p_open)
 		// When using the filter (in the block of code above) we don't have random access into the data to display anymore, which is why we don't use the clipper.
 		// Storing or skimming through the search result would make it possible (and would be recommended if you want to search through tens of thousands of entries)
 		ImGuiListClipper clipper;
-		clipper.Begin(LineOffsets.Size);
+		clipper.Begin(noLines);
 		while (clipper.Step())
 		{
 			for (int line_no = clipper.DisplayStart; line_no < clipper.DisplayEnd; line_no++)
 			{
 				const char* line_start = buf + LineOffsets[line_no];
-				const char* line_end = (line_no + 1 < LineOffsets.Size) ? (buf + LineOffsets[line_no + 1] - 1) : buf_end;
+				const char* line_end = (line_no + 1 < noLines) ? (buf + LineOffsets[line_no + 1] - 1) : buf_end;
 				ImGui::TextUnformatted(line_start, line_end);
 			}
 		}
@@ -111,6 +127,8 @@ void    ImGuiLog::Draw(const char* title, bool* p_open)
 	}
 	ImGui::PopStyleVar();
 
+	if (bLinesAdded.exchange(false) && AutoScroll)
+		ScrollToBottom = true;
 	if (ScrollToBottom)
 		ImGui::SetScrollHereY(1.0f);
 	ScrollToBottom = false;
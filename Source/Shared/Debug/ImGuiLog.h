@@ -2,6 +2,12 @@
 
 #include "imgui.h"
 
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Log lines can be added from any thread - the text is kept in std containers so adding a line doesn't touch the ImGui context
 class ImGuiLog
 {
 
@@ -14,11 +20,13 @@ public:
 	void    Draw(const char* title, bool* p_open = NULL);
 
 	private:
-		ImGuiTextBuffer     Buf;
+		std::mutex          LogMutex;           // guards Buf & LineOffsets
+		std::string         Buf;
 		ImGuiTextFilter     Filter;
-		ImVector<int>       LineOffsets;        // Index to lines offset. We maintain this with AddLog() calls, allowing us to have a random access on lines
+		std::vector<int>    LineOffsets;        // Index to lines offset. We maintain this with AddLog() calls, allowing us to have a random access on lines
 		bool                AutoScroll;
 		bool                ScrollToBottom;
+		std::atomic<bool>   bLinesAdded = false;	// set by AddLog() so Draw() can auto scroll
 };
 
 extern ImGuiLog g_ImGuiLog;
\ No newline at end of file
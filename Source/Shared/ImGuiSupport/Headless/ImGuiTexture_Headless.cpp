@@ -0,0 +1,21 @@
+#include "../ImGuiTexture.h"
+
+// Null texture backend for targets that run without a window (e.g. the batch analyser)
+// Textures are never drawn so nothing needs to be created
+
+ImTextureID ImGui_CreateTextureRGBA(const void* pixels, int width, int height)
+{
+	return nullptr;
+}
+
+void ImGui_FreeTexture(ImTextureID texture)
+{
+}
+
+void ImGui_UpdateTextureRGBA(ImTextureID texture, const void* pixels)
+{
+}
+
+void ImGui_UpdateTextureRGBA(ImTextureID texture, const void* pixels, int srcWidth, int srcHeight)
+{
+}
@@ -169,57 +169,54 @@ void DisplayTextureInspector(const ImTextureID texture, float width, float heigh
 
 // Character sets
 
-static std::vector<FCharacterSet*>	g_CharacterSets;
-static std::vector<FCharacterMap*>	g_CharacterMaps;
-
 void UpdateCharacterSetImage(FCodeAnalysisState& state, FCharacterSet& characterSet);
 
 
-void InitCharacterSets()
+void InitCharacterSets(FCodeAnalysisState& state)
 {
 	// char sets
-	for (auto& it : g_CharacterSets)
+	for (auto& it : state.CharacterSets)
 		delete it;
 
-	g_CharacterSets.clear();
+	state.CharacterSets.clear();
 
 	// char maps
-	for (auto& it : g_CharacterMaps)
+	for (auto& it : state.CharacterMaps)
 		delete it;
 
-	g_CharacterMaps.clear();
+	state.CharacterMaps.clear();
 }
 
 void UpdateCharacterSets(FCodeAnalysisState& state)
 {
-	for (auto& it : g_CharacterSets)
+	for (auto& it : state.CharacterSets)
 	{
 		if(it->Params.bDynamic)
 			UpdateCharacterSetImage(state, *it);
 	}
 }
 
-int GetNoCharacterSets()
+int GetNoCharacterSets(const FCodeAnalysisState& state)
 {
-	return (int)g_CharacterSets.size();
+	return (int)state.CharacterSets.size();
 }
 
-void DeleteCharacterSet(int index)
+void DeleteCharacterSet(FCodeAnalysisState& state, int index)
 {
-	g_CharacterSets.erase(g_CharacterSets.begin() + index);
+	state.CharacterSets.erase(state.CharacterSets.begin() + index);
 }
 
-FCharacterSet* GetCharacterSetFromIndex(int index)
+FCharacterSet* GetCharacterSetFromIndex(const FCodeAnalysisState& state, int index)
 {
-	if (index >= 0 && index < GetNoCharacterSets())
-		return g_CharacterSets[index];
+	if (index >= 0 && index < GetNoCharacterSets(state))
+		return state.CharacterSets[index];
 	else
 		return nullptr;
 }
 
-FCharacterSet* GetCharacterSetFromAddress(FAddressRef address)
+FCharacterSet* GetCharacterSetFromAddress(const FCodeAnalysisState& state, FAddressRef address)
 {
-	for (auto& it : g_CharacterSets)
+	for (auto& it : state.CharacterSets)
 	{
 		if (it->Params.Address == address)
 			return it;
@@ -306,14 +303,14 @@ void UpdateCharacterSet(FCodeAnalysisState& state, FCharacterSet& characterSet,
 
 bool CreateCharacterSetAt(FCodeAnalysisState& state, const FCharSetCreateParams& params)
 {
-	if (params.Address.IsValid() == false || GetCharacterSetFromAddress(params.Address) != nullptr)
+	if (params.Address.IsValid() == false || GetCharacterSetFromAddress(state, params.Address) != nullptr)
 		return false;
 
 	FCharacterSet* pNewCharSet = new FCharacterSet;
 	pNewCharSet->Image = new FGraphicsView(128, 128);
 	UpdateCharacterSet(state, *pNewCharSet, params);
 
-	g_CharacterSets.push_back(pNewCharSet);
+	state.CharacterSets.push_back(pNewCharSet);
 	return true;
 }
 
@@ -322,27 +319,27 @@ bool CreateCharacterSetAt(FCodeAnalysisState& state, const FCharSetCreateParams&
 
 
 
-int GetNoCharacterMaps()
+int GetNoCharacterMaps(const FCodeAnalysisState& state)
 {
-	return (int)g_CharacterMaps.size();
+	return (int)state.CharacterMaps.size();
 }
 
-void DeleteCharacterMap(int index)
+void DeleteCharacterMap(FCodeAnalysisState& state, int index)
 {
-	g_CharacterMaps.erase(g_CharacterMaps.begin() + index);
+	state.CharacterMaps.erase(state.CharacterMaps.begin() + index);
 }
 
-FCharacterMap* GetCharacterMapFromIndex(int index)
+FCharacterMap* GetCharacterMapFromIndex(const FCodeAnalysisState& state, int index)
 {
-	if (index >= 0 && index < GetNoCharacterMaps())
-		return g_CharacterMaps[index];
+	if (index >= 0 && index < GetNoCharacterMaps(state))
+		return state.CharacterMaps[index];
 	else
 		return nullptr;
 }
 
-FCharacterMap* GetCharacterMapFromAddress(FAddressRef address)
+FCharacterMap* GetCharacterMapFromAddress(const FCodeAnalysisState& state, FAddressRef address)
 {
-	for (auto& it : g_CharacterMaps)
+	for (auto& it : state.CharacterMaps)
 	{
 		if (it->Params.Address == address)
 			return it;
@@ -353,7 +350,7 @@ FCharacterMap* GetCharacterMapFromAddress(FAddressRef address)
 
 bool CreateCharacterMap(FCodeAnalysisState& state, const FCharMapCreateParams& params)
 {
-	if (params.Address.IsValid() == false || GetCharacterMapFromAddress(params.Address) != nullptr)
+	if (params.Address.IsValid() == false || GetCharacterMapFromAddress(state, params.Address) != nullptr)
 		return false;
 
 	FLabelInfo* pLabel = state.GetLabelForAddress(params.Address);
@@ -363,6 +360,6 @@ bool CreateCharacterMap(FCodeAnalysisState& state, const FCharMapCreateParams& p
 	FCharacterMap* pNewCharMap = new FCharacterMap;
 	pNewCharMap->Params = params;
 
-	g_CharacterMaps.push_back(pNewCharMap);
+	state.CharacterMaps.push_back(pNewCharMap);
 	return true;
 }
\ No newline at end of file
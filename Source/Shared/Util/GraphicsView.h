@@ -116,19 +116,19 @@ struct FCharacterMap
 uint32_t GetColFromAttr(uint8_t colBits, const uint32_t* colourLUT, bool bBright = true);
 
 // Character sets
-void InitCharacterSets();
+void InitCharacterSets(FCodeAnalysisState& state);
 void UpdateCharacterSets(FCodeAnalysisState& state);
-int GetNoCharacterSets();
-void DeleteCharacterSet(int index);
-FCharacterSet* GetCharacterSetFromIndex(int index);
-FCharacterSet* GetCharacterSetFromAddress(FAddressRef address);
+int GetNoCharacterSets(const FCodeAnalysisState& state);
+void DeleteCharacterSet(FCodeAnalysisState& state, int index);
+FCharacterSet* GetCharacterSetFromIndex(const FCodeAnalysisState& state, int index);
+FCharacterSet* GetCharacterSetFromAddress(const FCodeAnalysisState& state, FAddressRef address);
 void UpdateCharacterSet(FCodeAnalysisState& state, FCharacterSet& characterSet, const FCharSetCreateParams& params);
 bool CreateCharacterSetAt(FCodeAnalysisState& state, const FCharSetCreateParams& params);
 
 // Character Maps
-int GetNoCharacterMaps();
-void DeleteCharacterMap(int index);
-FCharacterMap* GetCharacterMapFromIndex(int index);
-FCharacterMap* GetCharacterMapFromAddress(FAddressRef address);
+int GetNoCharacterMaps(const FCodeAnalysisState& state);
+void DeleteCharacterMap(FCodeAnalysisState& state, int index);
+FCharacterMap* GetCharacterMapFromIndex(const FCodeAnalysisState& state, int index);
+FCharacterMap* GetCharacterMapFromAddress(const FCodeAnalysisState& state, FAddressRef address);
 bool CreateCharacterMap(FCodeAnalysisState& state, const FCharMapCreateParams& params);
 
@@ -3,12 +3,17 @@
 #include <cassert>
 #include <sstream>
 #include <vector>
+#include <atomic>
 
-static ENumberDisplayMode g_NumDispMode = ENumberDisplayMode::HexAitch;
+// display mode is a user setting shared by all threads, exporters can override it on their own thread
+static std::atomic<ENumberDisplayMode> g_NumDispMode = ENumberDisplayMode::HexAitch;
+static thread_local ENumberDisplayMode g_ThreadNumDispMode = ENumberDisplayMode::None;
+
+// each thread gets its own strings so analysis can run on several threads
 static const int kTextLength = 24;
 static const int kNoStrings = 8;
-int g_StringIndex = 0;
-static char g_TextWorkspace[kNoStrings][kTextLength];
+static thread_local int g_StringIndex = 0;
+static thread_local char g_TextWorkspace[kNoStrings][kTextLength];
 
 char* GetStrPtr()
 {
@@ -24,8 +29,16 @@ void SetNumberDisplayMode(ENumberDisplayMode mode)
 	g_NumDispMode = mode;
 }
 
+void SetThreadNumberDisplayMode(ENumberDisplayMode mode)
+{
+	g_ThreadNumDispMode = mode;
+}
+
 ENumberDisplayMode GetNumberDisplayMode()
 {
+	if (g_ThreadNumDispMode != ENumberDisplayMode::None)
+		return g_ThreadNumDispMode;
+
 	return g_NumDispMode;
 }
 
@@ -70,7 +83,7 @@ const char* NumStr(uint8_t num, ENumberDisplayMode numDispMode)
 
 const char* NumStr(uint8_t num)
 {
-	return NumStr(num, g_NumDispMode);
+	return NumStr(num, GetNumberDisplayMode());
 }
 
 const char* NumStr(uint16_t num, ENumberDisplayMode numDispMode)
@@ -103,7 +116,7 @@ const char* NumStr(uint16_t num, ENumberDisplayMode numDispMode)
 
 const char* NumStr(uint16_t num)
 {
-	return NumStr(num, g_NumDispMode);
+	return NumStr(num, GetNumberDisplayMode());
 }
 
 
@@ -2,6 +2,9 @@
 #include <cstdint>
 #include <string>
 #include <vector>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
 
 // note - config relies on these being a consistent numerical value
 enum class ENumberDisplayMode
@@ -14,9 +17,33 @@ enum class ENumberDisplayMode
 };
 
 void SetNumberDisplayMode(ENumberDisplayMode mode);
+void SetThreadNumberDisplayMode(ENumberDisplayMode mode);	// override for the calling thread only, None to clear
 ENumberDisplayMode GetNumberDisplayMode();
 const char* NumStr(uint8_t num, ENumberDisplayMode numDispMode);
 const char* NumStr(uint8_t);
 const char* NumStr(uint16_t num, ENumberDisplayMode numDispMode);
 const char* NumStr(uint16_t);
 void Tokenize(const std::string& stringToSplit, const char token, std::vector<std::string>& splitStrings);
+
+// index of the lowest/highest set bit - bits must be non-zero
+inline int LowestSetBit(uint64_t bits)
+{
+#ifdef _MSC_VER
+	unsigned long index;
+	_BitScanForward64(&index, bits);
+	return (int)index;
+#else
+	return __builtin_ctzll(bits);
+#endif
+}
+
+inline int HighestSetBit(uint64_t bits)
+{
+#ifdef _MSC_VER
+	unsigned long index;
+	_BitScanReverse64(&index, bits);
+	return (int)index;
+#else
+	return 63 - __builtin_clzll(bits);
+#endif
+}
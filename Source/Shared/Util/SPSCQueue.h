@@ -0,0 +1,42 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+
+// Lock free single producer/single consumer ring buffer
+// One thread pushes & another pops - e.g. UI sending commands to the emulation thread
+// Holds up to (Size - 1) items
+template <class T, size_t Size>
+class FSPSCQueue
+{
+public:
+	bool	Push(const T& item)
+	{
+		const size_t head = Head.load(std::memory_order_relaxed);
+		const size_t nextHead = (head + 1) % Size;
+		if (nextHead == Tail.load(std::memory_order_acquire))
+			return false;	// full
+
+		Items[head] = item;
+		Head.store(nextHead, std::memory_order_release);
+		return true;
+	}
+
+	bool	Pop(T& outItem)
+	{
+		const size_t tail = Tail.load(std::memory_order_relaxed);
+		if (tail == Head.load(std::memory_order_acquire))
+			return false;	// empty
+
+		outItem = Items[tail];
+		Tail.store((tail + 1) % Size, std::memory_order_release);
+		return true;
+	}
+
+	bool	IsEmpty() const { return Tail.load(std::memory_order_acquire) == Head.load(std::memory_order_acquire); }
+
+private:
+	T						Items[Size];
+	std::atomic<size_t>		Head = 0;	// written by producer
+	std::atomic<size_t>		Tail = 0;	// written by consumer
+};
@@ -0,0 +1,132 @@
+#pragma once
+
+#include <algorithm>
+#include <functional>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <vector>
+
+// Allocates objects in fixed size slabs - keeps them close together in memory & lets them all be freed in one go
+// Each object has a stable 32 bit index which can be used as a handle instead of a pointer.
+// Freed objects stay constructed until Reset() so stale pointers to them are still safe to read,
+// they are put back to their default state when they're reused.
+// Freeing an object that is already free is ignored so it can't end up with two owners.
+// T needs to be default constructible & assignable - classes with private constructors can make FSlabArena a friend.
+template <class T, int SlabSize = 1024>
+class FSlabArena
+{
+public:
+	static constexpr uint32_t kInvalidIndex = 0xffffffff;
+
+	FSlabArena() = default;
+	FSlabArena(const FSlabArena&) = delete;
+	FSlabArena& operator=(const FSlabArena&) = delete;
+
+	~FSlabArena()
+	{
+		Reset();
+		for (T* pSlab : Slabs)
+			::operator delete(pSlab, std::align_val_t(alignof(T)));
+	}
+
+	T*	Allocate()
+	{
+		NoAllocated++;
+
+		if (FreeList.empty() == false)
+		{
+			const uint32_t index = FreeList.back();
+			T* pObject = Get(index);
+			FreeList.pop_back();
+			Allocated[index] = true;
+			*pObject = T();
+			return pObject;
+		}
+
+		if (NoConstructed == Slabs.size() * SlabSize)
+			AddSlab();
+
+		T* pObject = new (&Slabs[NoConstructed / SlabSize][NoConstructed % SlabSize]) T();
+		Allocated[NoConstructed] = true;
+		NoConstructed++;
+		return pObject;
+	}
+
+	void	Free(T* pObject)
+	{
+		const uint32_t index = GetIndex(pObject);
+		if (index == kInvalidIndex)
+			return;
+
+		if (Allocated[index] == false)	// already free
+			return;
+
+		Allocated[index] = false;
+		FreeList.push_back(index);
+		NoAllocated--;
+	}
+
+	// Destroy all objects - slabs are kept for reuse
+	void	Reset()
+	{
+		for (size_t index = 0; index < NoConstructed; index++)
+			Get((uint32_t)index)->~T();
+
+		NoConstructed = 0;
+		NoAllocated = 0;
+		FreeList.clear();
+		std::fill(Allocated.begin(), Allocated.end(), false);
+	}
+
+	T*	Get(uint32_t index) const { return &Slabs[index / SlabSize][index % SlabSize]; }
+
+	// binary search of the slabs by address
+	uint32_t	GetIndex(const T* pObject) const
+	{
+		auto slabIt = std::upper_bound(SortedSlabs.begin(), SortedSlabs.end(), pObject, [](const T* pObj, const FSlabRef& slab) { return std::less<const T*>()(pObj, slab.pSlab); });
+		if (slabIt == SortedSlabs.begin())
+			return kInvalidIndex;
+
+		--slabIt;
+		if (std::less<const T*>()(pObject, slabIt->pSlab + SlabSize) == false)
+			return kInvalidIndex;
+
+		return (uint32_t)(slabIt->SlabNo * SlabSize + (pObject - slabIt->pSlab));
+	}
+
+	bool	IsAllocated(const T* pObject) const
+	{
+		const uint32_t index = GetIndex(pObject);
+		return index != kInvalidIndex && Allocated[index];
+	}
+
+	// Occupancy
+	size_t	GetNoAllocated() const { return NoAllocated; }
+	size_t	GetNoFree() const { return FreeList.size(); }
+	size_t	GetCapacity() const { return Slabs.size() * SlabSize; }
+	size_t	GetMemoryUsed() const { return Slabs.size() * SlabSize * sizeof(T); }	// slabs only - not what the objects allocate
+
+private:
+	struct FSlabRef
+	{
+		T*		pSlab;
+		size_t	SlabNo;
+	};
+
+	void	AddSlab()
+	{
+		T* pSlab = static_cast<T*>(::operator new(sizeof(T) * SlabSize, std::align_val_t(alignof(T))));
+		const FSlabRef slabRef = { pSlab, Slabs.size() };
+		SortedSlabs.insert(std::upper_bound(SortedSlabs.begin(), SortedSlabs.end(), pSlab, [](const T* pObj, const FSlabRef& slab) { return std::less<const T*>()(pObj, slab.pSlab); }), slabRef);
+		Slabs.push_back(pSlab);
+		Allocated.resize(Slabs.size() * SlabSize, false);
+	}
+
+	std::vector<T*>			Slabs;
+	std::vector<FSlabRef>	SortedSlabs;	// slabs in address order for GetIndex()
+	std::vector<bool>		Allocated;		// per slot
+	std::vector<uint32_t>	FreeList;
+	size_t					NoConstructed = 0;	// objects are constructed in order so these are the first NoConstructed slots
+	size_t					NoAllocated = 0;
+};
@@ -0,0 +1,84 @@
+#include "WorkerPool.h"
+
+#include <algorithm>
+
+FWorkerPool::FWorkerPool(int noWorkers)
+{
+	for (int workerNo = 0; workerNo < noWorkers; workerNo++)
+		Workers.emplace_back(&FWorkerPool::WorkerMain, this);
+}
+
+FWorkerPool::~FWorkerPool()
+{
+	{
+		std::lock_guard<std::mutex> lock(Mutex);
+		bShutdown = true;
+	}
+	JobStartCV.notify_all();
+
+	for (std::thread& worker : Workers)
+		worker.join();
+}
+
+FWorkerPool& FWorkerPool::Get()
+{
+	static FWorkerPool pool(std::max((int)std::thread::hardware_concurrency() - 1, 0));
+	return pool;
+}
+
+void FWorkerPool::ParallelFor(int count, const std::function<void(int index)>& job)
+{
+	std::unique_lock<std::mutex> jobLock(JobMutex, std::try_to_lock);
+	if (jobLock.owns_lock() == false || Workers.empty())
+	{
+		for (int index = 0; index < count; index++)
+			job(index);
+		return;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(Mutex);
+		pJob = &job;
+		JobCount = count;
+		NextIndex = 0;
+		NoWorkersBusy = (int)Workers.size();
+		JobNo++;
+	}
+	JobStartCV.notify_all();
+
+	RunJob(job, count);
+
+	// every worker has to finish with the job before it goes out of scope
+	std::unique_lock<std::mutex> lock(Mutex);
+	JobDoneCV.wait(lock, [this] { return NoWorkersBusy == 0; });
+	pJob = nullptr;
+}
+
+void FWorkerPool::RunJob(const std::function<void(int index)>& job, int count)
+{
+	for (int index = NextIndex++; index < count; index = NextIndex++)
+		job(index);
+}
+
+void FWorkerPool::WorkerMain()
+{
+	uint32_t lastJobNo = 0;
+	std::unique_lock<std::mutex> lock(Mutex);
+	while (true)
+	{
+		JobStartCV.wait(lock, [&] { return bShutdown || JobNo != lastJobNo; });
+		if (bShutdown)
+			return;
+
+		lastJobNo = JobNo;
+		const std::function<void(int index)>& job = *pJob;
+		const int count = JobCount;
+		lock.unlock();
+
+		RunJob(job, count);
+
+		lock.lock();
+		if (--NoWorkersBusy == 0)
+			JobDoneCV.notify_one();
+	}
+}
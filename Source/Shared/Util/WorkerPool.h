@@ -0,0 +1,45 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Small pool of worker threads for splitting a loop across cores
+// The threads are created once & sleep between jobs so a job doesn't pay for starting threads.
+// Only one job runs at a time - if another caller's job is running ParallelFor() runs the loop on the calling thread instead of waiting.
+class FWorkerPool
+{
+public:
+	explicit FWorkerPool(int noWorkers);
+	~FWorkerPool();
+	FWorkerPool(const FWorkerPool&) = delete;
+	FWorkerPool& operator=(const FWorkerPool&) = delete;
+
+	int		GetNoWorkers() const { return (int)Workers.size(); }
+
+	// calls job(index) for every index from 0 to count - 1, the calling thread helps out
+	void	ParallelFor(int count, const std::function<void(int index)>& job);
+
+	static FWorkerPool&	Get();	// shared pool - a worker for each core apart from the calling thread's
+
+private:
+	void	WorkerMain();
+	void	RunJob(const std::function<void(int index)>& job, int count);
+
+	std::vector<std::thread>	Workers;
+	std::mutex					JobMutex;	// held by the caller while its job runs
+
+	std::mutex					Mutex;		// guards the job state below
+	std::condition_variable		JobStartCV;
+	std::condition_variable		JobDoneCV;
+	const std::function<void(int index)>*	pJob = nullptr;
+	int							JobCount = 0;
+	uint32_t					JobNo = 0;	// workers wake up when this changes
+	int							NoWorkersBusy = 0;
+	bool						bShutdown = false;
+
+	std::atomic<int>			NextIndex = 0;
+};
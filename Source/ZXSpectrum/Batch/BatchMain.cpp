@@ -0,0 +1,310 @@
+// Headless batch analyser
+// Runs games for a number of frames without a window or UI then writes out the analysis
+// Usage: SpectrumAnalyserBatch [-128] (-game <name> | -snapshot <file> | -all) [-frames <n>] [-jobs <n>]
+// -all analyses every snapshot in the snapshot folder, spread over -jobs worker threads (defaults to one per core)
+// Emulators are set up & deleted on the main thread as that touches shared data (game configs, ImGui),
+// workers only run the emulation & write out the analysis
+
+#include "../SpectrumEmu.h"
+#include "../GlobalConfig.h"
+#include "../GameConfig.h"
+#include "../ZXChipsImpl.h"
+#include "../SnapshotLoaders/GamesList.h"
+
+#include <imgui.h>
+#include "CodeAnalyser/CodeAnalysisJson.h"
+#include "CodeAnalyser/CodeAnalysisState.h"
+#include "Debug/DebugLog.h"
+#include "Util/FileUtil.h"
+
+#define SOKOL_IMPL
+#include <sokol_audio.h>
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// needed to get it compiling - there's no window
+void SetWindowTitle(const char* pTitle) {}
+void SetWindowIcon(const char* pIconFile) {}
+
+static const int kDefaultNoFrames = 50 * 60;	// a minute of emulated time
+
+struct FBatchJob
+{
+	FSpectrumConfig	Config;
+	std::string		Name;		// for reporting
+	FSpectrumEmu*	pSpectrumEmu = nullptr;
+	std::string		Log;		// log messages from the job, printed when it's finished
+	bool			bSuccess = false;
+	double			Seconds = 0.0;
+};
+
+static void AddToJobLog(const char* pMessage, void* pUserData)
+{
+	FBatchJob* pJob = (FBatchJob*)pUserData;
+	pJob->Log += pMessage;
+}
+
+// Main thread only
+static bool SetupBatchJob(FBatchJob& job)
+{
+	SetThreadLogSink(AddToJobLog, &job);
+	job.pSpectrumEmu = new FSpectrumEmu;
+	job.pSpectrumEmu->Init(job.Config);
+	SetThreadLogSink(nullptr, nullptr);
+
+	if (job.pSpectrumEmu->pActiveGame == nullptr)
+	{
+		fprintf(stderr, "'%s' : failed to start game\n%s", job.Name.c_str(), job.Log.c_str());
+		delete job.pSpectrumEmu;
+		job.pSpectrumEmu = nullptr;
+		return false;
+	}
+
+	job.Name = job.pSpectrumEmu->pActiveGame->pConfig->Name;
+	return true;
+}
+
+// Main thread only
+static void FinishBatchJob(FBatchJob& job)
+{
+	delete job.pSpectrumEmu;
+	job.pSpectrumEmu = nullptr;
+
+	printf("%s : %s (%.3f seconds)\n", job.Name.c_str(), job.bSuccess ? "OK" : "Failed", job.Seconds);
+	if (job.Log.empty() == false)
+		printf("%s", job.Log.c_str());
+}
+
+// Runs on a worker thread
+static void RunBatchJob(FBatchJob& job, int noFrames, const std::string& root)
+{
+	SetThreadLogSink(AddToJobLog, &job);
+
+	FSpectrumEmu* pSpectrumEmu = job.pSpectrumEmu;
+	const FGameConfig* pGameConfig = pSpectrumEmu->pActiveGame->pConfig;
+	FCodeAnalysisState& state = pSpectrumEmu->CodeAnalysis;
+
+	// run each frame for exactly one machine frame's worth of time
+	const uint32_t frameMicroSeconds = pSpectrumEmu->GetFrameMicroSeconds();
+
+	state.Debugger.Continue();
+
+	const auto startTime = std::chrono::high_resolution_clock::now();
+	for (int frameNo = 0; frameNo < noFrames; frameNo++)
+	{
+		// breakpoints from the saved analysis would halt the run
+		if (state.Debugger.IsStopped())
+			state.Debugger.Continue();
+
+		pSpectrumEmu->TickEmulation(frameMicroSeconds);
+	}
+	const auto endTime = std::chrono::high_resolution_clock::now();
+	job.Seconds = std::chrono::duration<double>(endTime - startTime).count();
+
+	// write out analysis - we don't call Shutdown() as that would overwrite the game's save state & global config
+	const std::string analysisJsonFName = root + "AnalysisJson/" + pGameConfig->Name + ".json";
+	const std::string analysisStateFName = root + "AnalysisState/" + pGameConfig->Name + ".astate";
+
+	job.bSuccess = true;
+	if (ExportAnalysisJson(state, analysisJsonFName.c_str()) == false)
+	{
+		fprintf(stderr, "Failed to write '%s'\n", analysisJsonFName.c_str());
+		job.bSuccess = false;
+	}
+	if (ExportAnalysisState(state, analysisStateFName.c_str()) == false)
+	{
+		fprintf(stderr, "Failed to write '%s'\n", analysisStateFName.c_str());
+		job.bSuccess = false;
+	}
+
+	SetThreadLogSink(nullptr, nullptr);
+}
+
+// Summary of all the jobs, written as CSV so it can be compared between analyser versions
+static bool WriteBatchReport(const std::vector<FBatchJob>& jobs, int noFrames, const char* pFileName)
+{
+	FILE* fp = fopen(pFileName, "wt");
+	if (fp == nullptr)
+		return false;
+
+	fprintf(fp, "Game,Result,Frames,Seconds,FramesPerSecond\n");
+	for (const FBatchJob& job : jobs)
+	{
+		const double framesPerSecond = job.Seconds > 0.0 ? noFrames / job.Seconds : 0.0;
+		fprintf(fp, "\"%s\",%s,%d,%.3f,%.1f\n", job.Name.c_str(), job.bSuccess ? "OK" : "Failed", noFrames, job.Seconds, framesPerSecond);
+	}
+
+	fclose(fp);
+	return true;
+}
+
+int main(int argc, char** argv)
+{
+	FSpectrumConfig config;
+	config.ParseCommandline(argc, argv);
+
+	int noFrames = kDefaultNoFrames;
+	int noJobs = std::max((int)std::thread::hardware_concurrency(), 1);
+	bool bAllGames = false;
+	for (int arg = 1; arg < argc; arg++)
+	{
+		const std::string argStr(argv[arg]);
+		if (argStr == "-all")
+			bAllGames = true;
+		else if (argStr == "-frames" && arg + 1 < argc)
+			noFrames = std::max(atoi(argv[arg + 1]), 1);
+		else if (argStr == "-jobs" && arg + 1 < argc)
+			noJobs = std::max(atoi(argv[arg + 1]), 1);
+	}
+
+	if (bAllGames == false && config.SpecificGame.empty() && config.SpecificSnapshot.empty())
+	{
+		fprintf(stderr, "No game specified, use -game <name>, -snapshot <file> or -all\n");
+		return 1;
+	}
+
+	// global config is shared by every job so it's set up once, before any workers start
+	LoadGlobalConfig(kGlobalConfigFilename);
+	GetGlobalConfig().bEnableAudio = false;
+	config.bLoadGlobalConfig = false;
+	const FGlobalConfig& globalConfig = GetGlobalConfig();
+
+	// build job list
+	std::vector<FBatchJob> jobs;
+	if (bAllGames)
+	{
+		const std::string& snapshotFolder = config.Model == ESpectrumModel::Spectrum128K ? globalConfig.SnapshotFolder128 : globalConfig.SnapshotFolder;
+		FGamesList gamesList;
+		gamesList.EnumerateGames(snapshotFolder.c_str());
+		for (int gameNo = 0; gameNo < gamesList.GetNoGames(); gameNo++)
+		{
+			FBatchJob& job = jobs.emplace_back();
+			job.Config = config;
+			job.Config.SpecificGame.clear();
+			job.Config.SpecificSnapshot = gamesList.GetGame(gameNo).FileName;
+			job.Name = gamesList.GetGame(gameNo).DisplayName;
+		}
+
+		if (jobs.empty())
+		{
+			fprintf(stderr, "No snapshots found in '%s'\n", snapshotFolder.c_str());
+			return 1;
+		}
+	}
+	else
+	{
+		FBatchJob& job = jobs.emplace_back();
+		job.Config = config;
+		job.Name = config.SpecificGame.empty() ? config.SpecificSnapshot : config.SpecificGame;
+	}
+	noJobs = std::min(noJobs, (int)jobs.size());
+
+	const std::string root = globalConfig.WorkspaceRoot;
+	EnsureDirectoryExists(std::string(root + "AnalysisJson").c_str());
+	EnsureDirectoryExists(std::string(root + "AnalysisState").c_str());
+
+	// the UI is never drawn but some of the viewers query ImGui when they are set up
+	ImGui::CreateContext();
+
+	printf("Analysing %d game(s) for %d frames using %d thread(s)\n", (int)jobs.size(), noFrames, noJobs);
+
+	// the main thread sets up emulators for workers to run & deletes them when they're done
+	// a few more than there are workers are kept set up so workers don't wait
+	const int maxJobsInFlight = noJobs * 2;
+	std::mutex queueMutex;
+	std::condition_variable queueCV;
+	std::deque<int> readyJobs;		// set up, waiting for a worker
+	std::vector<int> finishedJobs;	// run, waiting to be deleted
+	bool bAllJobsQueued = false;
+
+	auto workerMain = [&]()
+	{
+		while (true)
+		{
+			int jobNo;
+			{
+				std::unique_lock<std::mutex> lock(queueMutex);
+				queueCV.wait(lock, [&] { return readyJobs.empty() == false || bAllJobsQueued; });
+				if (readyJobs.empty())
+					return;
+				jobNo = readyJobs.front();
+				readyJobs.pop_front();
+			}
+
+			RunBatchJob(jobs[jobNo], noFrames, root);
+
+			{
+				std::lock_guard<std::mutex> lock(queueMutex);
+				finishedJobs.push_back(jobNo);
+			}
+			queueCV.notify_all();
+		}
+	};
+
+	const auto startTime = std::chrono::high_resolution_clock::now();
+	std::vector<std::thread> workers;
+	for (int workerNo = 0; workerNo < noJobs; workerNo++)
+		workers.emplace_back(workerMain);
+
+	int nextJob = 0;
+	int noJobsInFlight = 0;
+	std::unique_lock<std::mutex> queueLock(queueMutex);
+	while (nextJob < (int)jobs.size() || noJobsInFlight > 0)
+	{
+		queueCV.wait(queueLock, [&] { return finishedJobs.empty() == false || (nextJob < (int)jobs.size() && noJobsInFlight < maxJobsInFlight); });
+		std::vector<int> jobsToFinish;
+		jobsToFinish.swap(finishedJobs);
+		const bool bSetupJob = nextJob < (int)jobs.size() && noJobsInFlight < maxJobsInFlight;
+		queueLock.unlock();
+
+		for (int jobNo : jobsToFinish)
+			FinishBatchJob(jobs[jobNo]);
+
+		const int setupJobNo = bSetupJob ? nextJob++ : -1;
+		const bool bSetupSucceeded = setupJobNo != -1 && SetupBatchJob(jobs[setupJobNo]);
+
+		queueLock.lock();
+		noJobsInFlight -= (int)jobsToFinish.size();
+		if (bSetupSucceeded)
+		{
+			readyJobs.push_back(setupJobNo);
+			noJobsInFlight++;
+		}
+		queueCV.notify_all();
+	}
+	bAllJobsQueued = true;
+	queueLock.unlock();
+	queueCV.notify_all();
+
+	for (std::thread& worker : workers)
+		worker.join();
+	const auto endTime = std::chrono::high_resolution_clock::now();
+
+	int noSucceeded = 0;
+	for (const FBatchJob& job : jobs)
+	{
+		if (job.bSuccess)
+			noSucceeded++;
+	}
+
+	const double seconds = std::chrono::duration<double>(endTime - startTime).count();
+	const double framesPerSecond = seconds > 0.0 ? ((double)noFrames * jobs.size()) / seconds : 0.0;
+	printf("Analysed %d of %d game(s) in %.3f seconds : %.1f frames/sec (%.1fx real time)\n", noSucceeded, (int)jobs.size(), seconds, framesPerSecond, framesPerSecond / 50.0);
+
+	const std::string reportFName = root + "BatchReport.csv";
+	if (WriteBatchReport(jobs, noFrames, reportFName.c_str()) == false)
+		fprintf(stderr, "Failed to write '%s'\n", reportFName.c_str());
+
+	ImGui::DestroyContext();
+
+	return noSucceeded == (int)jobs.size() ? 0 : 1;
+}
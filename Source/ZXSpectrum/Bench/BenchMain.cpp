@@ -0,0 +1,253 @@
+// Emulation throughput benchmark
+// Runs snapshots headless with different levels of analysis enabled & reports emulated T-states per second
+// Usage: SpectrumAnalyserBench [-snapshot <file>]... [-rzx <file>] [-frames <n>] [-out <file.json>]
+// Run from the Data/SpectrumAnalyser directory so the default snapshots can be found
+
+#include "../SpectrumEmu.h"
+#include "../GlobalConfig.h"
+#include "../GameConfig.h"
+#include "../ZXChipsImpl.h"
+#include "../SnapshotLoaders/GamesList.h"
+
+#include <imgui.h>
+#include "Util/FileUtil.h"
+#include "json.hpp"
+
+#define SOKOL_IMPL
+#include <sokol_audio.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <string>
+#include <vector>
+
+using json = nlohmann::json;
+
+// needed to get it compiling - there's no window
+void SetWindowTitle(const char* pTitle) {}
+void SetWindowIcon(const char* pIconFile) {}
+
+static const int kDefaultNoFrames = 500;
+static const int kNoWarmUpFrames = 50;	// not timed - lets analysis of the startup code settle
+
+enum class EBenchConfig
+{
+	Raw,			// just the emulator, no debug callback
+	DebugCallback,	// per tick callback with code analysis but no data accesses or events
+	DataAccesses,	// + data read/write registration
+	FrameTrace,		// everything on + display update & frame trace capture
+	RZXPlayback,	// as FrameTrace, playing back an RZX recording
+
+	Count
+};
+
+static const char* g_BenchConfigNames[(int)EBenchConfig::Count] =
+{
+	"Raw",
+	"DebugCallback",
+	"DataAccesses",
+	"FrameTrace",
+	"RZXPlayback",
+};
+
+struct FBenchResult
+{
+	std::string		Snapshot;
+	EBenchConfig	Config = EBenchConfig::Raw;
+	int				NoFrames = 0;
+	uint64_t		TStates = 0;
+	double			Seconds = 0.0;
+};
+
+static FSpectrumEmu* CreateEmulator(const char* pSnapshotFile, bool bRZX)
+{
+	FSpectrumConfig config;
+	config.bLoadGlobalConfig = false;	// loaded in main()
+	if (bRZX)
+		config.SpecificGame = "ROM";	// RZX files are started below
+	else
+		config.SpecificSnapshot = pSnapshotFile;
+
+	FSpectrumEmu* pEmu = new FSpectrumEmu;
+	pEmu->Init(config);
+
+	if (bRZX)
+	{
+		FGameSnapshot snapshot;
+		snapshot.Type = ESnapshotType::RZX;
+		snapshot.DisplayName = GetFileFromPath(pSnapshotFile);
+		snapshot.FileName = pSnapshotFile;
+
+		if (pEmu->RZXManager.Load(pSnapshotFile) == false)
+		{
+			delete pEmu;
+			return nullptr;
+		}
+
+		FGameConfig* pNewConfig = CreateNewGameConfigFromSnapshot(snapshot);
+		if (pNewConfig == nullptr)
+		{
+			delete pEmu;
+			return nullptr;
+		}
+		pEmu->StartGame(pNewConfig);
+	}
+	else if (pEmu->pActiveGame == nullptr)
+	{
+		delete pEmu;
+		return nullptr;
+	}
+
+	pEmu->CodeAnalysis.Debugger.Continue();
+	return pEmu;
+}
+
+static void RunFrame(FSpectrumEmu* pEmu, EBenchConfig config, uint32_t frameMicroSeconds)
+{
+	// breakpoints from saved analysis would halt the run
+	if (pEmu->CodeAnalysis.Debugger.IsStopped())
+		pEmu->CodeAnalysis.Debugger.Continue();
+
+	if (config == EBenchConfig::Raw)
+	{
+		pEmu->EmulatedTicks += ZXExeEmu_Features(&pEmu->ZXEmuState, frameMicroSeconds, ZX_TICK_FLOATINGBUS);
+	}
+	else
+	{
+		pEmu->TickEmulation(frameMicroSeconds, config == EBenchConfig::FrameTrace || config == EBenchConfig::RZXPlayback);
+	}
+}
+
+static bool RunBenchmark(const char* pSnapshotFile, EBenchConfig config, int noFrames, FBenchResult& result)
+{
+	FSpectrumEmu* pEmu = CreateEmulator(pSnapshotFile, config == EBenchConfig::RZXPlayback);
+	if (pEmu == nullptr)
+	{
+		fprintf(stderr, "Failed to start '%s'\n", pSnapshotFile);
+		return false;
+	}
+
+	pEmu->CodeAnalysis.bRegisterDataAccesses = config != EBenchConfig::DebugCallback;
+	pEmu->bCaptureEvents = config == EBenchConfig::FrameTrace || config == EBenchConfig::RZXPlayback;
+
+	const uint32_t frameMicroSeconds = pEmu->GetFrameMicroSeconds();
+
+	for (int frameNo = 0; frameNo < kNoWarmUpFrames; frameNo++)
+		RunFrame(pEmu, config, frameMicroSeconds);
+
+	pEmu->EmulatedTicks = 0;
+	const auto startTime = std::chrono::high_resolution_clock::now();
+	for (int frameNo = 0; frameNo < noFrames; frameNo++)
+		RunFrame(pEmu, config, frameMicroSeconds);
+	const auto endTime = std::chrono::high_resolution_clock::now();
+
+	result.Snapshot = pSnapshotFile;
+	result.Config = config;
+	result.NoFrames = noFrames;
+	result.TStates = pEmu->EmulatedTicks;
+	result.Seconds = std::chrono::duration<double>(endTime - startTime).count();
+
+	delete pEmu;
+	return true;
+}
+
+static bool WriteResultsJson(const std::vector<FBenchResult>& results, const char* pFileName)
+{
+	json jsonResults;
+
+	for (const FBenchResult& result : results)
+	{
+		const double tStatesPerSecond = result.Seconds > 0.0 ? result.TStates / result.Seconds : 0.0;
+		const double framesPerSecond = result.Seconds > 0.0 ? result.NoFrames / result.Seconds : 0.0;
+
+		json resultJson;
+		resultJson["Snapshot"] = result.Snapshot;
+		resultJson["Config"] = g_BenchConfigNames[(int)result.Config];
+		resultJson["Frames"] = result.NoFrames;
+		resultJson["TStates"] = result.TStates;
+		resultJson["Seconds"] = result.Seconds;
+		resultJson["TStatesPerSecond"] = tStatesPerSecond;
+		resultJson["RealTimeMultiple"] = framesPerSecond / 50.0;
+		jsonResults["Results"].push_back(resultJson);
+	}
+
+	std::ofstream outFileStream(pFileName);
+	if (outFileStream.is_open() == false)
+		return false;
+
+	outFileStream << std::setw(4) << jsonResults << std::endl;
+	return true;
+}
+
+int main(int argc, char** argv)
+{
+	std::vector<std::string> snapshots;
+	std::string rzxFile;
+	std::string outFile = "BenchmarkResults.json";
+	int noFrames = kDefaultNoFrames;
+
+	for (int arg = 1; arg < argc - 1; arg++)
+	{
+		const std::string argStr(argv[arg]);
+		if (argStr == "-snapshot")
+			snapshots.push_back(argv[++arg]);
+		else if (argStr == "-rzx")
+			rzxFile = argv[++arg];
+		else if (argStr == "-frames")
+			noFrames = std::max(atoi(argv[++arg]), 1);
+		else if (argStr == "-out")
+			outFile = argv[++arg];
+	}
+
+	if (snapshots.empty())
+	{
+		snapshots.push_back("Tests/TestMinimal.sna");
+		snapshots.push_back("../../Z80Src/OpcodeZoo/Opcode_Zoo.sna");
+	}
+
+	LoadGlobalConfig(kGlobalConfigFilename);
+	GetGlobalConfig().bEnableAudio = false;
+
+	// the UI is never drawn but some of the viewers query ImGui when they are set up
+	ImGui::CreateContext();
+
+	std::vector<FBenchResult> results;
+	bool bSuccess = true;
+
+	auto runBenchmark = [&](const char* pFileName, EBenchConfig config)
+	{
+		FBenchResult result;
+		if (RunBenchmark(pFileName, config, noFrames, result) == false)
+		{
+			bSuccess = false;
+			return;
+		}
+
+		const double tStatesPerSecond = result.Seconds > 0.0 ? result.TStates / result.Seconds : 0.0;
+		printf("%-40s %-14s %10.2f MT/s\n", pFileName, g_BenchConfigNames[(int)config], tStatesPerSecond / 1000000.0);
+		results.push_back(result);
+	};
+
+	for (const std::string& snapshot : snapshots)
+	{
+		for (int config = 0; config < (int)EBenchConfig::RZXPlayback; config++)
+			runBenchmark(snapshot.c_str(), (EBenchConfig)config);
+	}
+
+	if (rzxFile.empty() == false)
+		runBenchmark(rzxFile.c_str(), EBenchConfig::RZXPlayback);
+
+	if (WriteResultsJson(results, outFile.c_str()) == false)
+	{
+		fprintf(stderr, "Failed to write '%s'\n", outFile.c_str());
+		bSuccess = false;
+	}
+
+	ImGui::DestroyContext();
+
+	return bSuccess ? 0 : 1;
+}
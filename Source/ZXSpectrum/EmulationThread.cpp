@@ -0,0 +1,72 @@
+#include "EmulationThread.h"
+
+#include "SpectrumEmu.h"
+
+#include <algorithm>
+#include <chrono>
+
+void FEmulationThread::Start(FSpectrumEmu* pEmu)
+{
+	if (bRunning)
+		return;
+
+	pSpectrumEmu = pEmu;
+	bRunning = true;
+	Thread = std::thread(&FEmulationThread::ThreadMain, this);
+}
+
+void FEmulationThread::Stop()
+{
+	if (bRunning == false)
+		return;
+
+	bRunning = false;
+	Thread.join();
+}
+
+void FEmulationThread::ThreadMain()
+{
+	using FClock = std::chrono::steady_clock;
+
+	FDebugger& debugger = pSpectrumEmu->CodeAnalysis.Debugger;
+	auto nextFrameTime = FClock::now();
+
+	while (bRunning)
+	{
+		uint32_t frameMicroSeconds = 0;
+		bool bTurbo = false;
+		{
+			bFrameWaiting = true;
+			std::lock_guard<std::mutex> lock(EmulationLock);
+			bFrameWaiting = false;
+
+			frameMicroSeconds = pSpectrumEmu->GetFrameMicroSeconds();
+			bTurbo = pSpectrumEmu->bTurboMode;
+			debugger.ProcessCommands();
+			if (bTurbo)
+			{
+				pSpectrumEmu->TickTurbo(pSpectrumEmu->TurboTimeBudgetMS);
+			}
+			else if (debugger.IsStopped() == false)
+			{
+				const uint32_t microSeconds = std::max(static_cast<uint32_t>(frameMicroSeconds * pSpectrumEmu->ExecSpeedScale), uint32_t(1));
+				pSpectrumEmu->TickEmulation(microSeconds);
+			}
+		}
+
+		// in turbo mode just give the UI a chance to get the lock
+		if (bTurbo)
+		{
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+			nextFrameTime = FClock::now();
+			continue;
+		}
+
+		// run at the machine's frame rate - don't try to catch up if we've fallen a long way behind
+		const auto now = FClock::now();
+		nextFrameTime += std::chrono::microseconds(frameMicroSeconds);
+		if (nextFrameTime < now - std::chrono::milliseconds(100))
+			nextFrameTime = now;
+		std::this_thread::sleep_until(nextFrameTime);
+	}
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <atomic>
+#include <mutex>
+#include <thread>
+
+class FSpectrumEmu;
+
+// Runs the emulator & analysis on its own thread at the machine's frame rate
+// The UI takes the lock with LockForUI() for each piece of work that reads or changes the emulator or analysis state,
+// so a slow UI frame only holds up the emulation for as long as its slowest window takes to draw.
+// Debugger commands go through FDebugger::QueueCommand()
+class FEmulationThread
+{
+public:
+	void	Start(FSpectrumEmu* pEmu);
+	void	Stop();
+
+	bool			IsRunning() const { return bRunning; }
+
+	// empty lock if the thread isn't running - the UI thread then owns the emulator
+	std::unique_lock<std::mutex>	LockForUI()
+	{
+		if (IsRunning() == false)
+			return std::unique_lock<std::mutex>();
+
+		// a waiting frame goes first so the UI taking the lock for window after window can't starve it
+		while (bFrameWaiting)
+			std::this_thread::yield();
+		return std::unique_lock<std::mutex>(EmulationLock);
+	}
+
+private:
+	void	ThreadMain();
+
+	FSpectrumEmu*		pSpectrumEmu = nullptr;
+	std::thread			Thread;
+	std::atomic<bool>	bRunning = false;
+	std::mutex			EmulationLock;	// held while a frame is being emulated
+	std::atomic<bool>	bFrameWaiting = false;	// emulation thread is waiting for the lock
+};
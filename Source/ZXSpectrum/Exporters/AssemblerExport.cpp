@@ -54,8 +54,7 @@ bool ExportAssembler(FCodeAnalysisState& state, const char* pTextFileName, uint1
 
 	ENumberDisplayMode hexMode = ENumberDisplayMode::HexDollar;
 
-	ENumberDisplayMode oldMode = GetNumberDisplayMode();
-	SetNumberDisplayMode(hexMode);
+	SetThreadNumberDisplayMode(hexMode);
 
 	// TODO: write screen memory regions
 
@@ -206,6 +205,6 @@ bool ExportAssembler(FCodeAnalysisState& state, const char* pTextFileName, uint1
 	fclose(fp);
 
 
-	SetNumberDisplayMode(oldMode);
+	SetThreadNumberDisplayMode(ENumberDisplayMode::None);
 	return true;
 }
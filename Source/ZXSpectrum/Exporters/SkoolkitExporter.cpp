@@ -196,7 +196,7 @@ public:
 			if (pCodeInfo != nullptr)
 			{
 				UpdateCodeInfoForAddress(State, addr.Address); // what does this do again?
-				operationText = pCodeInfo->Text;
+				operationText = GetDisassemblyText(State, addr.Address, pCodeInfo);
 				pItem = pCodeInfo;
 			}
 			else if (pDataInfo != nullptr)
@@ -422,12 +422,10 @@ bool ExportSkoolFile(FCodeAnalysisState& state, const char* pTextFileName, FSkoo
 
 	FSkoolKitExporter exporter = FSkoolKitExporter(state, pSkoolInfo);
 
-	const ENumberDisplayMode previousDisplayMode = GetNumberDisplayMode();
-
 	if (base == FSkoolFile::Base::Hexadecimal)
-		SetNumberDisplayMode(ENumberDisplayMode::HexDollar);
+		SetThreadNumberDisplayMode(ENumberDisplayMode::HexDollar);
 	else
-		SetNumberDisplayMode(ENumberDisplayMode::Decimal);
+		SetThreadNumberDisplayMode(ENumberDisplayMode::Decimal);
 
 	bool bExportedOk = exporter.Export(pTextFileName, startAddr, endAddr, base);
 
@@ -436,7 +434,7 @@ bool ExportSkoolFile(FCodeAnalysisState& state, const char* pTextFileName, FSkoo
 	else
 		LOGINFO("Failed to export '%s'", pTextFileName);
 
-	SetNumberDisplayMode(previousDisplayMode);
+	SetThreadNumberDisplayMode(ENumberDisplayMode::None);
 	state.SetAddressRangeDirty();	
 
 	std::chrono::duration<double, std::milli> ms_double = std::chrono::high_resolution_clock::now() - t1;
@@ -176,6 +176,9 @@ int main(int argc, char** argv)
     g_AppState.pSpectrumEmu = pSpectrumEmulator;
 
     FGlobalConfig& globalConfig = GetGlobalConfig();
+    if (globalConfig.bThreadedEmulation)
+        pSpectrumEmulator->EmulationThread.Start(pSpectrumEmulator);
+
     if (!globalConfig.Font.empty())
     {
         std::string fontPath = "./Fonts/" + globalConfig.Font;
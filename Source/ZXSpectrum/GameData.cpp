@@ -141,6 +141,15 @@ void SaveLabelsBin(const FCodeAnalysisState& state, FILE* fp, uint16_t startAddr
 	}
 }
 #endif
+
+// comment strings are only allocated for items that have a comment
+static void ReadCommentFromFile(FItemComment& comment, FILE* fp)
+{
+	std::string commentText;
+	ReadStringFromFile(commentText, fp);
+	comment = commentText;
+}
+
 void LoadLabelsBin(FCodeAnalysisState& state, FILE* fp, int versionNo, uint16_t startAddress, uint16_t endAddress)
 {
 	int recordCount = 0;
@@ -151,7 +160,7 @@ void LoadLabelsBin(FCodeAnalysisState& state, FILE* fp, int versionNo, uint16_t
 
 	for (int i = 0; i < recordCount; i++)
 	{
-		FLabelInfo* pLabel = FLabelInfo::Allocate();
+		FLabelInfo* pLabel = FLabelInfo::Allocate(state);
 
 		std::string enumVal;
 		ReadStringFromFile(enumVal, fp);
@@ -163,7 +172,7 @@ void LoadLabelsBin(FCodeAnalysisState& state, FILE* fp, int versionNo, uint16_t
 		fread(&addr, sizeof(addr), 1, fp);
 		fread(&pLabel->ByteSize, sizeof(pLabel->ByteSize), 1, fp);
 		ReadStringFromFile(pLabel->Name, fp);
-		ReadStringFromFile(pLabel->Comment, fp);
+		ReadCommentFromFile(pLabel->Comment, fp);
 
 		if (versionNo > 2)
 			fread(&pLabel->Global, sizeof(bool), 1, fp);
@@ -227,7 +236,7 @@ void LoadCodeInfoBin(FCodeAnalysisState& state, FILE* fp, int versionNo, uint16_
 
 	for (int i = 0; i < recordCount; i++)
 	{
-		FCodeInfo* pCodeInfo = FCodeInfo::Allocate();
+		FCodeInfo* pCodeInfo = FCodeInfo::Allocate(state);
 
 		if (versionNo > 8)
 			fread(&pCodeInfo->OperandType, sizeof(pCodeInfo->OperandType), 1, fp);
@@ -246,7 +255,7 @@ void LoadCodeInfoBin(FCodeAnalysisState& state, FILE* fp, int versionNo, uint16_
 			ReadStringFromFile(tmp, fp);
 		}
 		//ReadStringFromFile(pCodeInfo->Text, fp);
-		ReadStringFromFile(pCodeInfo->Comment, fp);
+		ReadCommentFromFile(pCodeInfo->Comment, fp);
 		state.SetCodeInfoForAddress(addr, pCodeInfo);
 		for (int codeByte = 1; codeByte < pCodeInfo->ByteSize; codeByte++)	
 		{
@@ -255,6 +264,7 @@ void LoadCodeInfoBin(FCodeAnalysisState& state, FILE* fp, int versionNo, uint16_
 			pOperandData->ByteSize = 1;
 			pOperandData->InstructionAddress = state.AddressRefFromPhysicalAddress(addr);
 		}
+		state.UpdateCodeBitsForAddressRange(addr, pCodeInfo->ByteSize);
 	}
 }
 
@@ -293,7 +303,7 @@ void SaveDataInfoBin(const FCodeAnalysisState& state, FILE* fp, uint16_t startAd
 			int noReads = 0;
 			const long noReadsFilePos = ftell(fp);
 			fwrite(&noReads, sizeof(int), 1, fp);
-			for (const auto& ref : pDataInfo->Reads.GetReferences())
+			for (const auto& ref : state.GetDataReadsForAddress((uint16_t)i).GetReferences())
 			{
 				const uint16_t refAddr = ref.Address;
 				if (refAddr >= startAddress && refAddr <= endAddress)
@@ -312,7 +322,7 @@ void SaveDataInfoBin(const FCodeAnalysisState& state, FILE* fp, uint16_t startAd
 			int noWrites = 0;
 			const long noWritesFilePos = ftell(fp);
 			fwrite(&noWrites, sizeof(int), 1, fp);
-			for (const auto& ref : pDataInfo->Writes.GetReferences())
+			for (const auto& ref : state.GetDataWritesForAddress((uint16_t)i).GetReferences())
 			{
 				const uint16_t refAddr = ref.Address;
 				if (refAddr >= startAddress && refAddr <= endAddress)
@@ -378,7 +388,7 @@ void LoadDataInfoBin(FCodeAnalysisState& state, FILE* fp, int versionNo, uint16_
 			fread(&pDataInfo->EmptyCharNo, sizeof(pDataInfo->EmptyCharNo), 1, fp);
 		}
 
-		ReadStringFromFile(pDataInfo->Comment, fp);
+		ReadCommentFromFile(pDataInfo->Comment, fp);
 
 		// References?
 		if (versionNo > 1)
@@ -390,7 +400,7 @@ void LoadDataInfoBin(FCodeAnalysisState& state, FILE* fp, int versionNo, uint16_
 				uint16_t dataAddr;
 				fread(&dataAddr, sizeof(uint16_t), 1, fp);
 				if (dataAddr >= startAddress && dataAddr <= endAddress)
-					pDataInfo->Reads.RegisterAccess(state.AddressRefFromPhysicalAddress(dataAddr));
+					state.GetOrCreateDataReadsForAddress(address).RegisterAccess(state.AddressRefFromPhysicalAddress(dataAddr));
 				else
 					LOGWARNING("LoadDataInfoBin: Address %x outside of range", dataAddr);
 			}
@@ -404,7 +414,7 @@ void LoadDataInfoBin(FCodeAnalysisState& state, FILE* fp, int versionNo, uint16_
 				uint16_t dataAddr;
 				fread(&dataAddr, sizeof(uint16_t), 1, fp);
 				if (dataAddr >= startAddress && dataAddr <= endAddress)
-					pDataInfo->Writes.RegisterAccess(state.AddressRefFromPhysicalAddress(dataAddr));
+					state.GetOrCreateDataWritesForAddress(address).RegisterAccess(state.AddressRefFromPhysicalAddress(dataAddr));
 				else
 					LOGWARNING("LoadDataInfoBin: Address %x outside of range", dataAddr);
 			}
@@ -446,10 +456,10 @@ void LoadCommentBlocksBin(FCodeAnalysisState& state, FILE* fp, int versionNo, ui
 
 	for (int i = 0; i < recordCount; i++)
 	{
-		FCommentBlock* pCommentBlock = FCommentBlock::Allocate();
+		FCommentBlock* pCommentBlock = FCommentBlock::Allocate(state);
 		uint16_t address;
 		fread(&address, sizeof(address), 1, fp);
-		ReadStringFromFile(pCommentBlock->Comment, fp);
+		ReadCommentFromFile(pCommentBlock->Comment, fp);
 		state.SetCommentBlockForAddress(state.AddressRefFromPhysicalAddress(address), pCommentBlock);
 	}
 }
@@ -505,9 +515,9 @@ void SaveGameDataBin(const FCodeAnalysisState& state, FILE *fp, uint16_t addrSta
 		const long noCharSetsPos = ftell(fp);
 		fwrite(&noCharSets, sizeof(noCharSets), 1, fp);
 
-		for (int i = 0; i < GetNoCharacterSets(); i++)
+		for (int i = 0; i < GetNoCharacterSets(state); i++)
 		{
-			const FCharacterSet* pCharSet = GetCharacterSetFromIndex(i);
+			const FCharacterSet* pCharSet = GetCharacterSetFromIndex(state, i);
 			const uint16_t addr = pCharSet->Params.Address.Address;
 			if (addr >= addrStart && addr <= addrEnd)
 			{
@@ -533,9 +543,9 @@ void SaveGameDataBin(const FCodeAnalysisState& state, FILE *fp, uint16_t addrSta
 		const long noCharMapsPos = ftell(fp);
 		fwrite(&noCharMaps, sizeof(noCharMaps), 1, fp);
 
-		for (int i = 0; i < GetNoCharacterMaps(); i++)
+		for (int i = 0; i < GetNoCharacterMaps(state); i++)
 		{
-			const FCharacterMap* pCharMap = GetCharacterMapFromIndex(i);
+			const FCharacterMap* pCharMap = GetCharacterMapFromIndex(state, i);
 			const uint16_t addr = pCharMap->Params.Address.Address;
 			if (addr >= addrStart && addr <= addrEnd)
 			{
@@ -665,6 +675,7 @@ void SaveMachineState(FSpectrumEmu* pSpectrumEmu, FILE *fp)
 			if (cheat.bEnabled)	// cheat activated so revert
 			{
 				pSpectrumEmu->WriteByte(entry.Address, entry.OldValue);
+				state.InvalidateDecodedInstruction(entry.Address);
 				cheat.bEnabled = false;
 			}
 		}
@@ -681,6 +692,7 @@ void SaveMachineState(FSpectrumEmu* pSpectrumEmu, FILE *fp)
 				state.CPUInterface->WriteByte(addr + i, pCodeInfo->OpcodeBkp[i]);
 
 			pCodeInfo->bNOPped = false;
+			pCodeInfo->Decoded.bValid = false;
 		}
 	}
 
@@ -347,8 +347,7 @@ void FormatSmallPlatformMemory(FSpectrumEmu* pEmu, int platformNo)
 	//if (state.GetLabelForAddress(kPlatformAddr) == nullptr)
 	{
 		sprintf(labelName, "SmallPlatform_%d", platformNo);
-		FLabelInfo* pLabel = AddLabel(state, kPlatformAddr, labelName, ELabelType::Data);
-		pLabel->Global = true;
+		AddLabel(state, kPlatformAddr, labelName, ELabelType::Data, true);
 	}
 	// Format Mask - 6 bytes bitmap
 	FDataFormattingOptions format;
@@ -375,8 +374,7 @@ void FormatSmallPlatformMemory(FSpectrumEmu* pEmu, int platformNo)
 	if(noPlatformChars > 0)
 	{
 		sprintf(labelName, "SmallPlatform_%d_Attributes", platformNo);
-		FLabelInfo* pLabel = AddLabel(state, kPlatformAddr - noPlatformChars, labelName, ELabelType::Data);
-		pLabel->Global = true;
+		AddLabel(state, kPlatformAddr - noPlatformChars, labelName, ELabelType::Data, true);
 
 		format.StartAddress = kPlatformAddr - noPlatformChars;
 
@@ -398,8 +396,7 @@ void FormatSmallPlatformMemory(FSpectrumEmu* pEmu, int platformNo)
 	for (int platChar = 0; platChar < noPlatformChars; platChar++)
 	{
 		sprintf(labelName, "SmallPlatform_%d_Char_%d", platformNo, platChar);
-		FLabelInfo* pLabel = AddLabel(state, platCharAddr, labelName, ELabelType::Data);
-		pLabel->Global = true;
+		AddLabel(state, platCharAddr, labelName, ELabelType::Data, true);
 
 		format.SetupForBitmap(platCharAddr, 8, 8);
 		FormatData(state, format);
@@ -418,8 +415,7 @@ void FormatBigPlatformMemory(FSpectrumEmu* pEmu, int platformNo)
 
 	// Label
 	sprintf(labelName, "BigPlatform_%d", platformNo);
-	FLabelInfo* pLabel = AddLabel(state, kBigPlatformData, labelName, ELabelType::Data);
-	pLabel->Global = true;
+	AddLabel(state, kBigPlatformData, labelName, ELabelType::Data, true);
 
 	// Format Charmap 2x2
 	FDataFormattingOptions format;
@@ -436,8 +432,7 @@ void FormatScreenMemory(FSpectrumEmu* pEmu, int screenNo)
 
 	// Label
 	sprintf(labelName, "Screen_%d", screenNo);
-	FLabelInfo* pLabel = AddLabel(state, kScreenData, labelName, ELabelType::Data);
-	pLabel->Global = true;
+	AddLabel(state, kScreenData, labelName, ELabelType::Data, true);
 
 	// Format Charmap 4x3
 	FDataFormattingOptions format;
@@ -454,8 +449,7 @@ void FormatPlatformMemory(FSpectrumEmu* pEmu, int platformNo)
 
 	// Label
 	sprintf(labelName, "Platform_%d", platformNo);
-	FLabelInfo* pLabel = AddLabel(state, platformAddr, labelName, ELabelType::Data);
-	pLabel->Global = true;
+	AddLabel(state, platformAddr, labelName, ELabelType::Data, true);
 
 	// Format Bitmap 16x8
 	FDataFormattingOptions format;
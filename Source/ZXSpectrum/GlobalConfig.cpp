@@ -31,6 +31,8 @@ bool LoadGlobalConfig(const char* fileName)
 
 	config.bEnableAudio = jsonConfigFile["EnableAudio"];
 	config.bShowScanLineIndicator = jsonConfigFile["ShowScanlineIndicator"];
+	if (jsonConfigFile.contains("ThreadedEmulation"))
+		config.bThreadedEmulation = jsonConfigFile["ThreadedEmulation"];
 	if(jsonConfigFile.contains("ShowOpcodeValues"))
 		config.bShowOpcodeValues = jsonConfigFile["ShowOpcodeValues"];
 	config.LastGame = jsonConfigFile["LastGame"];
@@ -74,6 +76,7 @@ bool SaveGlobalConfig(const char* fileName)
 
 	jsonConfigFile["EnableAudio"] = config.bEnableAudio;
 	jsonConfigFile["ShowScanlineIndicator"] = config.bShowScanLineIndicator;
+	jsonConfigFile["ThreadedEmulation"] = config.bThreadedEmulation;
 	jsonConfigFile["ShowOpcodeValues"] = config.bShowOpcodeValues;
 	jsonConfigFile["LastGame"] = config.LastGame;
 	jsonConfigFile["NumberMode"] = (int)config.NumberDisplayMode;
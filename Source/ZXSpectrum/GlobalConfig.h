@@ -6,6 +6,7 @@
 struct FGlobalConfig
 {
 	bool				bEnableAudio;
+	bool				bThreadedEmulation = true;	// run the emulator on its own thread
 	bool				bShowScanLineIndicator = false;
 	bool				bShowOpcodeValues = false;
 	ENumberDisplayMode	NumberDisplayMode = ENumberDisplayMode::HexAitch;
@@ -352,7 +352,7 @@ bool ImportSkoolKitFile(FCodeAnalysisState& state, const char* pTextFileName, FS
 				if (LastItem.Item->Comment.back() != '\n')
 					LastItem.Item->Comment += "\n";
 				LastItem.Item->Comment += trimmed.substr(2);
-				RemoveCarriageReturn(LastItem.Item->Comment);
+				RemoveCarriageReturn(LastItem.Item->Comment.Edit());
 			}
 			continue;
 		}
@@ -437,10 +437,12 @@ bool ImportSkoolKitFile(FCodeAnalysisState& state, const char* pTextFileName, FS
 			FCodeInfo* pCodeInfo = state.GetCodeInfoForAddress(instruction.Address);
 			if (pCodeInfo)
 			{
-				LOGWARNING("Item at $%02X was set to code: %s",instruction.Address, pCodeInfo->Text.c_str());
+				LOGWARNING("Item at $%02X was set to code: %s",instruction.Address, GetDisassemblyText(state, instruction.Address, pCodeInfo).c_str());
 				LOGWARNING("Code item removed and replace as data");
 				// remove the code item
-				state.SetCodeInfoForAddress(instruction.Address, nullptr);	// memory will get cleared up 
+				state.SetCodeInfoForAddress(instruction.Address, nullptr);
+				state.FreeItemLater(pCodeInfo);
+				state.UpdateCodeBitsForAddressRange(instruction.Address, 1);
 			}
 			if (pDataInfo)
 			{
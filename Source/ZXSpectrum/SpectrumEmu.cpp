@@ -25,6 +25,7 @@
 
 #include "zx-roms.h"
 #include <algorithm>
+#include <chrono>
 #include <sokol_audio.h>
 #include "Exporters/SkoolkitExporter.h"
 #include "Importers/SkoolkitImporter.h"
@@ -217,7 +218,7 @@ void gfx_destroy_texture(void* h)
 static void PushAudio(const float* samples, int num_samples, void* user_data)
 {
 	FSpectrumEmu* pEmu = (FSpectrumEmu*)user_data;
-	if(GetGlobalConfig().bEnableAudio)
+	if(GetGlobalConfig().bEnableAudio && pEmu->bTurboMode == false)
 		saudio_push(samples, num_samples);
 }
 
@@ -249,19 +250,23 @@ int UIEvalBreakpoint(ui_dbg_t* dbg_win, uint16_t pc, int ticks, uint64_t pins, v
 	return 0;
 }
 
-uint64_t FSpectrumEmu::Z80Tick(int num, uint64_t pins)
+// Per tick analysis - specialised for each combination of features so the unused parts compile out
+template <uint32_t kFeatures>
+uint64_t FSpectrumEmu::Z80TickSpecialised(uint64_t pins)
 {
 	FCodeAnalysisState &state = CodeAnalysis;
 	FDebugger& debugger = CodeAnalysis.Debugger;
 	z80_t& cpu = ZXEmuState.cpu;
 	const uint16_t pc = GetPC().Address;
-	static uint64_t lastTickPins = 0;
-	const uint64_t risingPins = pins & (pins ^ lastTickPins);
-	lastTickPins = pins;
+	const uint64_t risingPins = pins & (pins ^ LastTickPins);
+	LastTickPins = pins;
 	const uint16_t scanlinePos = (uint16_t)ZXEmuState.scanline_y;
 
-	if (scanlinePos == 0)	// clear scanline info on new frame
-		debugger.ResetScanlineEvents();
+	if constexpr ((kFeatures & kZ80TickFeature_Events) != 0)
+	{
+		if (scanlinePos == 0)	// clear scanline info on new frame
+			debugger.ResetScanlineEvents();
+	}
 
 	/* memory and IO requests */
 	if (pins & Z80_MREQ) 
@@ -290,25 +295,30 @@ uint64_t FSpectrumEmu::Z80Tick(int num, uint64_t pins)
 			}
 			else
 			{
-				if (state.bRegisterDataAccesses)
-					RegisterDataRead(state, pc, addr);
+				if constexpr ((kFeatures & kZ80TickFeature_DataAccesses) != 0)
+					state.LogDataRead(pc, addr);
 			}
 		}
 		else if (pins & Z80_WR) 
 		{
-			if (state.bRegisterDataAccesses)
-				RegisterDataWrite(state, pc, addr, value);
-			const FAddressRef addrRef = state.AddressRefFromPhysicalAddress(addr);
-			const FAddressRef pcAddrRef = state.AddressRefFromPhysicalAddress(pc);
-			state.SetLastWriterForAddress(addr, pcAddrRef);
-			
-			if (addr >= kScreenPixMemStart && addr <= kScreenPixMemEnd)
+			if constexpr ((kFeatures & kZ80TickFeature_DataAccesses) != 0)
+				state.LogDataWrite(pc, addr);	// last writer gets set when the log is flushed
+			else
 			{
-				debugger.RegisterEvent((uint8_t)EEventType::ScreenPixWrite, pcAddrRef, addr, value, scanlinePos);
+				state.SetLastWriterForAddress(addr, state.AddressRefFromPhysicalAddress(pc));
+				state.InvalidateDecodedInstructionOnWrite(addr);	// no SMC check without the log
 			}
-			else if (addr >= kScreenAttrMemStart && addr < kScreenAttrMemEnd)
+
+			if constexpr ((kFeatures & kZ80TickFeature_Events) != 0)
 			{
-				debugger.RegisterEvent((uint8_t)EEventType::ScreenAttrWrite, pcAddrRef, addr, value, scanlinePos);
+				if (addr >= kScreenPixMemStart && addr <= kScreenPixMemEnd)
+				{
+					debugger.RegisterEvent((uint8_t)EEventType::ScreenPixWrite, state.AddressRefFromPhysicalAddress(pc), addr, value, scanlinePos);
+				}
+				else if (addr >= kScreenAttrMemStart && addr < kScreenAttrMemEnd)
+				{
+					debugger.RegisterEvent((uint8_t)EEventType::ScreenAttrWrite, state.AddressRefFromPhysicalAddress(pc), addr, value, scanlinePos);
+				}
 			}
 		}
 	}
@@ -322,7 +332,23 @@ uint64_t FSpectrumEmu::Z80Tick(int num, uint64_t pins)
 
 		IOAnalysis.IOHandler(pc, pins);
 
-		if (pins & Z80_RD)
+		if constexpr ((kFeatures & kZ80TickFeature_Events) == 0)
+		{
+			// only need to track the ULA port & handle bank switching
+			if ((pins & Z80_CTRL_PIN_MASK) == (Z80_IORQ | Z80_WR))
+			{
+				if ((pins & Z80_A0) == 0)
+				{
+					LastFE = data;
+				}
+				else if (ZXEmuState.type == ZX_TYPE_128 && (pins & (Z80_A15 | Z80_A1)) == 0 && !ZXEmuState.memory_paging_disabled)
+				{
+					SetROMBank((data & (1 << 4)) ? 1 : 0);
+					SetRAMBank(3, data & 0x7);
+				}
+			}
+		}
+		else if (pins & Z80_RD)
 		{
 			if ((pins & Z80_A0) == 0)
 				debugger.RegisterEvent((uint8_t)EEventType::KeyboardRead, pcAddrRef, addr , data, scanlinePos);
@@ -344,7 +370,6 @@ uint64_t FSpectrumEmu::Z80Tick(int num, uint64_t pins)
 			// handle bank switching on speccy 128
 			if ((pins & Z80_A0) == 0)
 			{
-				static uint8_t LastFE = 0;
 				// Spectrum ULA (...............0)
 
 				// has border colour changed?
@@ -404,6 +429,48 @@ uint64_t FSpectrumEmu::Z80Tick(int num, uint64_t pins)
 	return pins;
 }
 
+template <uint32_t kFeatures>
+static void DebugCBSpecialised(void* user_data, uint64_t pins)
+{
+	FSpectrumEmu* pEmu = (FSpectrumEmu*)user_data;
+	pEmu->Z80TickSpecialised<kFeatures>(pins);
+}
+
+// indexed by feature mask
+static const chips_debug_func_t g_DebugCallbacks[] =
+{
+	DebugCBSpecialised<0>,
+	DebugCBSpecialised<1>,
+	DebugCBSpecialised<2>,
+	DebugCBSpecialised<3>,
+};
+
+uint32_t FSpectrumEmu::GetZ80TickFeatures() const
+{
+	uint32_t features = 0;
+	if (CodeAnalysis.bRegisterDataAccesses)
+		features |= kZ80TickFeature_DataAccesses;
+	if (bCaptureEvents)
+		features |= kZ80TickFeature_Events;
+	return features;
+}
+
+uint64_t FSpectrumEmu::Z80Tick(int num, uint64_t pins)
+{
+	switch (GetZ80TickFeatures())
+	{
+	case 0:
+		return Z80TickSpecialised<0>(pins);
+	case 1:
+		return Z80TickSpecialised<1>(pins);
+	case 2:
+		return Z80TickSpecialised<2>(pins);
+	default:
+		return Z80TickSpecialised<3>(pins);
+	}
+}
+
+
 static uint64_t Z80TickThunk(int num, uint64_t pins, void* user_data)
 {
 	FSpectrumEmu* pEmu = (FSpectrumEmu*)user_data;
@@ -558,7 +625,8 @@ bool FSpectrumEmu::Init(const FSpectrumConfig& config)
 	SetWindowIcon("SALogo.png");
 
 	// Initialise Emulator
-	LoadGlobalConfig(kGlobalConfigFilename);
+	if (config.bLoadGlobalConfig)
+		LoadGlobalConfig(kGlobalConfigFilename);
 	FGlobalConfig& globalConfig = GetGlobalConfig();
 	SetNumberDisplayMode(globalConfig.NumberDisplayMode);
 	CodeAnalysis.Config.bShowOpcodeValues = globalConfig.bShowOpcodeValues;
@@ -658,8 +726,8 @@ bool FSpectrumEmu::Init(const FSpectrumConfig& config)
 	CodeAnalysis.ViewState[0].Enabled = true;	// always have first view enabled
 
 	// Setup memory description handlers
-	AddMemoryRegionDescGenerator(new FScreenPixMemDescGenerator());
-	AddMemoryRegionDescGenerator(new FScreenAttrMemDescGenerator());	
+	AddMemoryRegionDescGenerator(CodeAnalysis, new FScreenPixMemDescGenerator());
+	AddMemoryRegionDescGenerator(CodeAnalysis, new FScreenAttrMemDescGenerator());	
 
 	// register Viewers
 	RegisterStarquakeViewer(this);
@@ -673,7 +741,7 @@ bool FSpectrumEmu::Init(const FSpectrumConfig& config)
 		char bankName[32];
 		sprintf(bankName, "ROM %d", bankNo);
 		ROMBanks[bankNo] = CodeAnalysis.CreateBank(bankName, 16,ZXEmuState.rom[bankNo], true);
-		CodeAnalysis.GetBank(ROMBanks[bankNo])->PrimaryMappedPage = 0;
+		CodeAnalysis.SetBankPrimaryMappedPage(ROMBanks[bankNo], 0);
 	}
 
 	// create & register RAM banks
@@ -682,15 +750,15 @@ bool FSpectrumEmu::Init(const FSpectrumConfig& config)
 		char bankName[32];
 		sprintf(bankName, "RAM %d", bankNo);
 		RAMBanks[bankNo] = CodeAnalysis.CreateBank(bankName, 16, ZXEmuState.ram[bankNo], false);
-		CodeAnalysis.GetBank(RAMBanks[bankNo])->PrimaryMappedPage = 48;
+		CodeAnalysis.SetBankPrimaryMappedPage(RAMBanks[bankNo], 48);
 	}
 
 	// Setup initial machine memory config
 	if (config.Model == ESpectrumModel::Spectrum48K)
 	{
-		CodeAnalysis.GetBank(RAMBanks[0])->PrimaryMappedPage = 16;
-		CodeAnalysis.GetBank(RAMBanks[1])->PrimaryMappedPage = 32;
-		CodeAnalysis.GetBank(RAMBanks[2])->PrimaryMappedPage = 48;
+		CodeAnalysis.SetBankPrimaryMappedPage(RAMBanks[0], 16);
+		CodeAnalysis.SetBankPrimaryMappedPage(RAMBanks[1], 32);
+		CodeAnalysis.SetBankPrimaryMappedPage(RAMBanks[2], 48);
 
 		SetROMBank(0);
 		SetRAMBank(1, 0);	// 0x4000 - 0x7fff
@@ -699,9 +767,9 @@ bool FSpectrumEmu::Init(const FSpectrumConfig& config)
 	}
 	else
 	{
-		CodeAnalysis.GetBank(RAMBanks[5])->PrimaryMappedPage = 16;
-		CodeAnalysis.GetBank(RAMBanks[2])->PrimaryMappedPage = 32;
-		CodeAnalysis.GetBank(RAMBanks[0])->PrimaryMappedPage = 48;
+		CodeAnalysis.SetBankPrimaryMappedPage(RAMBanks[5], 16);
+		CodeAnalysis.SetBankPrimaryMappedPage(RAMBanks[2], 32);
+		CodeAnalysis.SetBankPrimaryMappedPage(RAMBanks[0], 48);
 
 		SetROMBank(0);
 		SetRAMBank(1, 5);	// 0x4000 - 0x7fff
@@ -717,6 +785,10 @@ bool FSpectrumEmu::Init(const FSpectrumConfig& config)
 	{
 		bLoadedGame = StartGame(config.SpecificGame.c_str());
 	}
+	else if (config.SpecificSnapshot.empty() == false)
+	{
+		bLoadedGame = StartGameFromSnapshotFile(config.SpecificSnapshot.c_str());
+	}
 	else if (globalConfig.LastGame.empty() == false)
 	{
 		bLoadedGame = StartGame(globalConfig.LastGame.c_str());
@@ -763,6 +835,8 @@ bool FSpectrumEmu::Init(const FSpectrumConfig& config)
 
 void FSpectrumEmu::Shutdown()
 {
+	EmulationThread.Stop();
+
 	if (RZXManager.GetReplayMode() == EReplayMode::Off)
 		SaveCurrentGameData();	// save on close
 
@@ -956,6 +1030,40 @@ bool FSpectrumEmu::NewGameFromSnapshot(int snapshotIndex)
 	return false;
 }
 
+// Start a game from a snapshot file path
+// if a config already exists for the game then it is used so any previous analysis gets loaded
+bool FSpectrumEmu::StartGameFromSnapshotFile(const char* pSnapshotFile)
+{
+	if (GamesList.LoadGame(pSnapshotFile) == false)
+	{
+		LOGERROR("Failed to load snapshot '%s'", pSnapshotFile);
+		return false;
+	}
+
+	FGameSnapshot snapshot;
+	snapshot.Type = GetSnapshotTypeFromFileName(pSnapshotFile);
+	snapshot.DisplayName = GetFileFromPath(pSnapshotFile);
+	snapshot.FileName = pSnapshotFile;
+
+	const std::string gameName = RemoveFileExtension(snapshot.DisplayName.c_str());
+	for (const auto& pGameConfig : GetGameConfigs())
+	{
+		if (pGameConfig->Name == gameName)
+		{
+			StartGame(pGameConfig);
+			return true;
+		}
+	}
+
+	FGameConfig* pNewConfig = CreateNewGameConfigFromSnapshot(snapshot);
+	if (pNewConfig == nullptr)
+		return false;
+
+	StartGame(pNewConfig);
+	AddGameConfig(pNewConfig);
+	return true;
+}
+
 void FSpectrumEmu::DrawMainMenu(double timeMS)
 {
 	ui_zx_t* pZXUI = &UIZX;
@@ -1189,36 +1297,21 @@ void FSpectrumEmu::DrawMainMenu(double timeMS)
 
 			if (ImGui::BeginMenu("Number Mode"))
 			{
-				bool bClearCode = false;
+				// code text is cached per number mode so doesn't need clearing
 				if (ImGui::MenuItem("Decimal", 0, GetNumberDisplayMode() == ENumberDisplayMode::Decimal))
 				{
 					SetNumberDisplayMode(ENumberDisplayMode::Decimal);
 					CodeAnalysis.SetAllBanksDirty();
-					bClearCode = true;
 				}
 				if (ImGui::MenuItem("Hex - FEh", 0, GetNumberDisplayMode() == ENumberDisplayMode::HexAitch))
 				{
 					SetNumberDisplayMode(ENumberDisplayMode::HexAitch);
 					CodeAnalysis.SetAllBanksDirty();
-					bClearCode = true;
 				}
 				if (ImGui::MenuItem("Hex - $FE", 0, GetNumberDisplayMode() == ENumberDisplayMode::HexDollar))
 				{
 					SetNumberDisplayMode(ENumberDisplayMode::HexDollar);
 					CodeAnalysis.SetAllBanksDirty();
-					bClearCode = true;
-				}
-
-				// clear code text so it can be written again
-				if (bClearCode)
-				{
-					for (int i = 0; i < 1 << 16; i++)
-					{
-						FCodeInfo* pCodeInfo = CodeAnalysis.GetCodeInfoForAddress(i);
-						if (pCodeInfo && pCodeInfo->Text.empty() == false)
-							pCodeInfo->Text.clear();
-
-					}
 				}
 
 				ImGui::EndMenu();
@@ -1489,85 +1582,167 @@ void FSpectrumEmu::Tick()
 {
 	FDebugger& debugger = CodeAnalysis.Debugger;
 
-	SpectrumViewer.Tick();
-
-	if (debugger.IsStopped() == false)
+	// input & the texture updates copy from the emulator so they hold the lock together
 	{
-		const float frameTime = std::min(1000000.0f / ImGui::GetIO().Framerate, 32000.0f) * ExecSpeedScale;
-		//const float frameTime = min(1000000.0f / 50, 32000.0f) * ExecSpeedScale;
-		const uint32_t microSeconds = std::max(static_cast<uint32_t>(frameTime), uint32_t(1));
+		const std::unique_lock<std::mutex> emulationLock = EmulationThread.LockForUI();
 
-		CodeAnalysis.OnFrameStart();
-		StoreRegisters_Z80(CodeAnalysis);
-#if ENABLE_CAPTURES
-		const uint32_t ticks_to_run = clk_ticks_to_run(&ZXEmuState.clk, microSeconds);
-		uint32_t ticks_executed = 0;
-		while (UIZX.dbg.dbg.z80->trap_id != kCaptureTrapId && ticks_executed < ticks_to_run)
+		SpectrumViewer.Tick();
+
+		if (EmulationThread.IsRunning() == false)
 		{
-			ticks_executed += z80_exec(&ZXEmuState.cpu, ticks_to_run - ticks_executed);
+			debugger.ProcessCommands();
 
-			if (UIZX.dbg.dbg.z80->trap_id == kCaptureTrapId)
+			if (bTurboMode)
 			{
-				const uint16_t PC = GetPC();
-				FMachineState* pMachineState = CodeAnalysis.GetMachineState(PC);
-				if (pMachineState == nullptr)
-				{
-					pMachineState = AllocateMachineState(CodeAnalysis);
-					CodeAnalysis.SetMachineStateForAddress(PC, pMachineState);
-				}
+				TickTurbo(TurboTimeBudgetMS);
+			}
+			else if (debugger.IsStopped() == false)
+			{
+				const float frameTime = std::min(1000000.0f / ImGui::GetIO().Framerate, 32000.0f) * ExecSpeedScale;
+				//const float frameTime = min(1000000.0f / 50, 32000.0f) * ExecSpeedScale;
+				const uint32_t microSeconds = std::max(static_cast<uint32_t>(frameTime), uint32_t(1));
 
-				CaptureMachineState(pMachineState, this);
-				UIZX.dbg.dbg.z80->trap_id = 0;
-				_ui_dbg_continue(&UIZX.dbg);
+				TickEmulation(microSeconds);
 			}
 		}
-		clk_ticks_executed(&ZXEmuState.clk, ticks_executed);
-		kbd_update(&ZXEmuState.kbd);
-#else
-		if (RZXManager.GetReplayMode() == EReplayMode::Playback)
-		{
-			if (RZXFetchesRemaining <= 0)
-				RZXFetchesRemaining += RZXManager.Update();
-			const uint32_t fetchesProcessed = ZXExeEmu_UseFetchCount(&ZXEmuState, RZXFetchesRemaining, GetIOInputFunc, this);
-			RZXFetchesRemaining -= fetchesProcessed;
-		}
-		else
+
+		FrameTraceViewer.UpdateTextures();
+		UpdateCharacterSets(CodeAnalysis);
+	}
+
+	// Draw UI - each window takes the lock while it draws, see DrawUI()
+	DrawDockingView();
+}
+
+// Run the machine for a number of microseconds & update the analysis
+// This doesn't touch ImGui so it can be used by the headless batch runner
+// bUpdateDisplay can be false to skip the display conversion & frame trace capture for frames that won't be seen
+void FSpectrumEmu::TickEmulation(uint32_t microSeconds, bool bUpdateDisplay /* = true */)
+{
+	CodeAnalysis.OnFrameStart();
+	StoreRegisters_Z80(CodeAnalysis);
+
+	// pick the specialised tick functions for the features in use this frame
+	ZXEmuState.debug.callback.func = g_DebugCallbacks[GetZ80TickFeatures()];
+	const uint32_t tickFeatures = ZX_TICK_DEBUGHOOK | (bEmulateFloatingBus ? ZX_TICK_FLOATINGBUS : 0);
+#if ENABLE_CAPTURES
+	const uint32_t ticks_to_run = clk_ticks_to_run(&ZXEmuState.clk, microSeconds);
+	uint32_t ticks_executed = 0;
+	while (UIZX.dbg.dbg.z80->trap_id != kCaptureTrapId && ticks_executed < ticks_to_run)
+	{
+		ticks_executed += z80_exec(&ZXEmuState.cpu, ticks_to_run - ticks_executed);
+
+		if (UIZX.dbg.dbg.z80->trap_id == kCaptureTrapId)
 		{
-			ZXExeEmu(&ZXEmuState, microSeconds);
+			const uint16_t PC = GetPC();
+			FMachineState* pMachineState = CodeAnalysis.GetMachineState(PC);
+			if (pMachineState == nullptr)
+			{
+				pMachineState = AllocateMachineState(CodeAnalysis);
+				CodeAnalysis.SetMachineStateForAddress(PC, pMachineState);
+			}
+
+			CaptureMachineState(pMachineState, this);
+			UIZX.dbg.dbg.z80->trap_id = 0;
+			_ui_dbg_continue(&UIZX.dbg);
 		}
+	}
+	clk_ticks_executed(&ZXEmuState.clk, ticks_executed);
+	kbd_update(&ZXEmuState.kbd);
+#else
+	if (RZXManager.GetReplayMode() == EReplayMode::Playback)
+	{
+		if (RZXFetchesRemaining <= 0)
+			RZXFetchesRemaining += RZXManager.Update();
+		uint32_t ticksExecuted = 0;
+		const uint32_t fetchesProcessed = ZXExeEmu_UseFetchCount_Features(&ZXEmuState, RZXFetchesRemaining, GetIOInputFunc, this, tickFeatures, &ticksExecuted);
+		RZXFetchesRemaining -= fetchesProcessed;
+		EmulatedTicks += ticksExecuted;
+	}
+	else
+	{
+		EmulatedTicks += ZXExeEmu_Features(&ZXEmuState, microSeconds, tickFeatures);
+	}
 #endif
-		/*if (RZXManager.GetReplayMode() == EReplayMode::Playback)
-		{
-			assert(ZXEmuState.valid);
-			uint32_t icount = RZXManager.Update();
+	/*if (RZXManager.GetReplayMode() == EReplayMode::Playback)
+	{
+		assert(ZXEmuState.valid);
+		uint32_t icount = RZXManager.Update();
 
-			uint32_t ticks_to_run = clk_ticks_to_run(&ZXEmuState.clk, microSeconds);
-			uint32_t ticks_executed = z80_exec(&ZXEmuState.cpu, ticks_to_run);
-			clk_ticks_executed(&ZXEmuState.clk, ticks_executed);
-			kbd_update(&ZXEmuState.kbd);
-		}
-		else
-		{
-			uint32_t frameTicks = ZXEmuState.frame_scan_lines* ZXEmuState.scanline_period;
-			//zx_exec(&ZXEmuState, microSeconds);
-
-			//uint32_t ticks_to_run = clk_ticks_to_run(&ZXEmuState.clk, microSeconds);
-			//frameTicks = ticks_to_run;
-			ZXEmuState.clk.ticks_to_run = frameTicks;
-			const uint32_t ticksExecuted = z80_exec(&ZXEmuState.cpu, frameTicks);
-			clk_ticks_executed(&ZXEmuState.clk, ticksExecuted);
-			kbd_update(&ZXEmuState.kbd);
-		}*/
+		uint32_t ticks_to_run = clk_ticks_to_run(&ZXEmuState.clk, microSeconds);
+		uint32_t ticks_executed = z80_exec(&ZXEmuState.cpu, ticks_to_run);
+		clk_ticks_executed(&ZXEmuState.clk, ticks_executed);
+		kbd_update(&ZXEmuState.kbd);
+	}
+	else
+	{
+		uint32_t frameTicks = ZXEmuState.frame_scan_lines* ZXEmuState.scanline_period;
+		//zx_exec(&ZXEmuState, microSeconds);
+
+		//uint32_t ticks_to_run = clk_ticks_to_run(&ZXEmuState.clk, microSeconds);
+		//frameTicks = ticks_to_run;
+		ZXEmuState.clk.ticks_to_run = frameTicks;
+		const uint32_t ticksExecuted = z80_exec(&ZXEmuState.cpu, frameTicks);
+		clk_ticks_executed(&ZXEmuState.clk, ticksExecuted);
+		kbd_update(&ZXEmuState.kbd);
+	}*/
+	if (bUpdateDisplay)
+	{
+		SpectrumViewer.UpdateFrameBuffer();
 		FrameTraceViewer.CaptureFrame();
-		//FrameScreenPixWrites.clear();
-		//FrameScreenAttrWrites.clear();
-		CodeAnalysis.OnFrameEnd();
 	}
+	//FrameScreenPixWrites.clear();
+	//FrameScreenAttrWrites.clear();
+	CodeAnalysis.OnFrameEnd();
+}
 
-	UpdateCharacterSets(CodeAnalysis);
+// Fast forward - run whole machine frames until the time budget is used up
+// Only the last frame updates the display, returns the number of frames run
+int FSpectrumEmu::TickTurbo(float timeBudgetMS)
+{
+	using FClock = std::chrono::steady_clock;
 
-	// Draw UI
-	DrawDockingView();
+	FDebugger& debugger = CodeAnalysis.Debugger;
+	const uint32_t frameMicroSeconds = GetFrameMicroSeconds();
+	const auto endTime = FClock::now() + std::chrono::microseconds(static_cast<int64_t>(timeBudgetMS * 1000.0f));
+	const bool bRegisterDataAccesses = CodeAnalysis.bRegisterDataAccesses;
+	const bool bOldCaptureEvents = bCaptureEvents;
+
+	if (bTurboThinAnalysis)
+	{
+		CodeAnalysis.bRegisterDataAccesses = false;
+		bCaptureEvents = false;
+	}
+
+	int noFrames = 0;
+	auto frameStartTime = FClock::now();
+	while (debugger.IsStopped() == false)
+	{
+		// assume the next frame will take as long as the last one
+		const auto now = FClock::now();
+		const bool bLastFrame = now + (now - frameStartTime) >= endTime;
+		frameStartTime = now;
+
+		TickEmulation(frameMicroSeconds, bLastFrame);
+		noFrames++;
+
+		if (bLastFrame)
+			break;
+	}
+
+	CodeAnalysis.bRegisterDataAccesses = bRegisterDataAccesses;
+	bCaptureEvents = bOldCaptureEvents;
+	TurboFramesPerTick = noFrames;
+	return noFrames;
+}
+
+uint32_t FSpectrumEmu::GetFrameMicroSeconds() const
+{
+	const uint64_t frameTicks = (uint64_t)ZXEmuState.frame_scan_lines * ZXEmuState.scanline_period;
+	if (frameTicks == 0 || ZXEmuState.freq_hz == 0)
+		return 20000;	// 50Hz
+
+	return (uint32_t)((frameTicks * 1000000) / ZXEmuState.freq_hz);
 }
 
 void FSpectrumEmu::DrawMemoryTools()
@@ -1628,18 +1803,24 @@ void FSpectrumEmu::DrawUI()
 	//static int maxInst = 0;
 	//maxInst = std::max(maxInst, instructionsThisFrame);
 
-	DrawMainMenu(timeMS);
-	if (pZXUI->memmap.open)
+	// Each window holds the emulation lock while it draws so the emulation thread can run in between windows.
+	// Windows see the state as it was when they were drawn, which can be a frame apart.
 	{
-		UpdateMemmap(pZXUI);
-	}
+		const std::unique_lock<std::mutex> emulationLock = EmulationThread.LockForUI();
 
-	// call the Chips UI functions
-	ui_audio_draw(&pZXUI->audio, pZXUI->zx->audio.sample_pos);
-	ui_z80_draw(&pZXUI->cpu);
-	ui_ay38910_draw(&pZXUI->ay);
-	ui_kbd_draw(&pZXUI->kbd);
-	ui_memmap_draw(&pZXUI->memmap);
+		DrawMainMenu(timeMS);
+		if (pZXUI->memmap.open)
+		{
+			UpdateMemmap(pZXUI);
+		}
+
+		// call the Chips UI functions
+		ui_audio_draw(&pZXUI->audio, pZXUI->zx->audio.sample_pos);
+		ui_z80_draw(&pZXUI->cpu);
+		ui_ay38910_draw(&pZXUI->ay);
+		ui_kbd_draw(&pZXUI->kbd);
+		ui_memmap_draw(&pZXUI->memmap);
+	}
 
 	/*for (int i = 0; i < 4; i++)
 	{
@@ -1652,72 +1833,91 @@ void FSpectrumEmu::DrawUI()
 	{
 		if (Viewer->bOpen)
 		{
+			const std::unique_lock<std::mutex> emulationLock = EmulationThread.LockForUI();
 			if (ImGui::Begin(Viewer->GetName(), &Viewer->bOpen))
 				Viewer->DrawUI();
 			ImGui::End();
 		}
 	}
 
-	if (ImGui::Begin("Debugger"))
 	{
-		CodeAnalysis.Debugger.DrawUI();
+		const std::unique_lock<std::mutex> emulationLock = EmulationThread.LockForUI();
+		if (ImGui::Begin("Debugger"))
+		{
+			CodeAnalysis.Debugger.DrawUI();
+		}
+		ImGui::End();
 	}
-	ImGui::End();
 
 	//DasmDraw(&pUI->FunctionDasm);
 	// show spectrum window
-	if (ImGui::Begin("Spectrum View"))
 	{
-		SpectrumViewer.Draw();
+		const std::unique_lock<std::mutex> emulationLock = EmulationThread.LockForUI();
+		if (ImGui::Begin("Spectrum View"))
+		{
+			SpectrumViewer.Draw();
+		}
+		ImGui::End();
 	}
-	ImGui::End();
 
-	if (ImGui::Begin("Frame Trace"))
 	{
-		FrameTraceViewer.Draw();
-	}
-	ImGui::End();
-
-	if (RZXManager.GetReplayMode() == EReplayMode::Playback)
-	{
-		if (ImGui::Begin("RZX Info"))
+		const std::unique_lock<std::mutex> emulationLock = EmulationThread.LockForUI();
+		if (ImGui::Begin("Frame Trace"))
 		{
-			RZXManager.DrawUI();
+			FrameTraceViewer.Draw();
 		}
 		ImGui::End();
-	}
 
-	// cheats 
-	if (ImGui::Begin("Pokes"))
-	{
-		DrawCheatsUI();
+		if (RZXManager.GetReplayMode() == EReplayMode::Playback)
+		{
+			if (ImGui::Begin("RZX Info"))
+			{
+				RZXManager.DrawUI();
+			}
+			ImGui::End();
+		}
 	}
-	ImGui::End();
 
-	// game viewer
-	if (ImGui::Begin("Game Viewer"))
+	// cheats & game viewer
 	{
-		if (pActiveGame != nullptr)
+		const std::unique_lock<std::mutex> emulationLock = EmulationThread.LockForUI();
+		if (ImGui::Begin("Pokes"))
 		{
-			ImGui::Text(pActiveGame->pConfig->Name.c_str());
-			pActiveGame->pViewerConfig->pDrawFunction(this, pActiveGame);
+			DrawCheatsUI();
 		}
+		ImGui::End();
+
+		if (ImGui::Begin("Game Viewer"))
+		{
+			if (pActiveGame != nullptr)
+			{
+				ImGui::Text(pActiveGame->pConfig->Name.c_str());
+				pActiveGame->pViewerConfig->pDrawFunction(this, pActiveGame);
+			}
 		
+		}
+		ImGui::End();
 	}
-	ImGui::End();
 
 #ifndef NDEBUG
 	// config
 	if (CodeAnalysis.Config.bShowConfigWindow)
 	{
+		const std::unique_lock<std::mutex> emulationLock = EmulationThread.LockForUI();
 		if(ImGui::Begin("Configuration", &CodeAnalysis.Config.bShowConfigWindow))
 			DrawCodeAnalysisConfigWindow(CodeAnalysis);
 		ImGui::End();
 	}
 #endif
 
-	DrawGraphicsViewer(GraphicsViewer);
-	DrawMemoryTools();
+	{
+		const std::unique_lock<std::mutex> emulationLock = EmulationThread.LockForUI();
+		DrawGraphicsViewer(GraphicsViewer);
+	}
+	{
+		const std::unique_lock<std::mutex> emulationLock = EmulationThread.LockForUI();
+		DrawMemoryTools();
+	}
 
 	// COde analysis views
 	for (int codeAnalysisNo = 0; codeAnalysisNo < FCodeAnalysisState::kNoViewStates; codeAnalysisNo++)
@@ -1726,6 +1926,7 @@ void FSpectrumEmu::DrawUI()
 		sprintf(name, "Code Analysis %d", codeAnalysisNo + 1);
 		if(CodeAnalysis.ViewState[codeAnalysisNo].Enabled)
 		{
+			const std::unique_lock<std::mutex> emulationLock = EmulationThread.LockForUI();
 			if (ImGui::Begin(name,&CodeAnalysis.ViewState[codeAnalysisNo].Enabled))
 			{
 				DrawCodeAnalysisData(CodeAnalysis, codeAnalysisNo);
@@ -1735,15 +1936,18 @@ void FSpectrumEmu::DrawUI()
 
 	}
 
-	ImGui::SetNextWindowSize(ImVec2(500, 400), ImGuiCond_FirstUseEver);
-	if (ImGui::Begin("Character Maps"))
 	{
-		DrawCharacterMapViewer(CodeAnalysis, CodeAnalysis.GetFocussedViewState());
+		const std::unique_lock<std::mutex> emulationLock = EmulationThread.LockForUI();
+		ImGui::SetNextWindowSize(ImVec2(500, 400), ImGuiCond_FirstUseEver);
+		if (ImGui::Begin("Character Maps"))
+		{
+			DrawCharacterMapViewer(CodeAnalysis, CodeAnalysis.GetFocussedViewState());
+		}
+		ImGui::End();
 	}
-	ImGui::End();
 
 	if (bShowDebugLog)
-		g_ImGuiLog.Draw("Debug Log", &bShowDebugLog);
+		g_ImGuiLog.Draw("Debug Log", &bShowDebugLog);	// the log has its own lock
 }
 
 bool FSpectrumEmu::DrawDockingView()
@@ -1927,11 +2131,8 @@ void FSpectrumEmu::DrawCheatsUI()
 					WriteByte( entry.Address, entry.OldValue);
 				}
 
-				// if code has been modified then clear the code text so it gets regenerated
-				FCodeInfo* pCodeInfo = CodeAnalysis.GetCodeInfoForAddress(entry.Address);
-				if (pCodeInfo)
-					pCodeInfo->Text.clear();
-			
+				// code text is regenerated from the new opcode bytes when it's next drawn
+				CodeAnalysis.InvalidateDecodedInstruction(entry.Address);
 				CodeAnalysis.SetCodeAnalysisDirty(entry.Address);
 			}
 
@@ -2079,6 +2280,15 @@ void FSpectrumConfig::ParseCommandline(int argc, char** argv)
 			}
 			SpecificGame = *++argIt;
 		}
+		else if (*argIt == std::string("-snapshot"))
+		{
+			if (++argIt == argList.end())
+			{
+				LOGERROR("-snapshot : No snapshot file specified");
+				break;
+			}
+			SpecificSnapshot = *argIt;
+		}
 		else if (*argIt == std::string("-skoolfile"))
 		{
 			if (++argIt == argList.end())
@@ -41,6 +41,7 @@
 #include "SnapshotLoaders/GamesList.h"
 #include "IOAnalysis.h"
 #include "SnapshotLoaders/RZXLoader.h"
+#include "EmulationThread.h"
 #include "Util/Misc.h"
 
 struct FGame;
@@ -50,6 +51,8 @@ struct FGameConfig;
 struct FViewerConfig;
 struct FSkoolFileInfo;
 
+extern const char* kGlobalConfigFilename;
+
 enum class ESpectrumModel
 {
 	Spectrum48K,
@@ -63,9 +66,15 @@ struct FSpectrumConfig
 	void ParseCommandline(int argc, char** argv);
 	ESpectrumModel	Model = ESpectrumModel::Spectrum48K;
 	std::string		SpecificGame;
+	std::string		SpecificSnapshot;	// snapshot file to start a game from (if no specific game)
 	std::string		SkoolkitImport;
+	bool			bLoadGlobalConfig = true;	// headless tools load it once before setting up emulators
 };
 
+// Per tick analysis features - Z80Tick has a specialised version for each combination
+static const uint32_t kZ80TickFeature_DataAccesses	= 1 << 0;	// register data reads & writes
+static const uint32_t kZ80TickFeature_Events		= 1 << 1;	// capture debugger events
+
 struct FGame
 {
 	FGameConfig *		pConfig	= nullptr;
@@ -95,6 +104,7 @@ public:
 	bool	StartGame(const char* pGameName);
 	void	SaveCurrentGameData();
 	bool	NewGameFromSnapshot(int snapshotIndex);
+	bool	StartGameFromSnapshotFile(const char* pSnapshotFile);
 
 	void	DrawMainMenu(double timeMS);
 	void	DrawExportAsmModalPopup();
@@ -107,8 +117,13 @@ public:
 
 	void	OnInstructionExecuted(int ticks, uint64_t pins);
 	uint64_t Z80Tick(int num, uint64_t pins);
+	template <uint32_t kFeatures> uint64_t Z80TickSpecialised(uint64_t pins);
+	uint32_t GetZ80TickFeatures() const;
 
 	void	Tick();
+	void	TickEmulation(uint32_t microSeconds, bool bUpdateDisplay = true);	// run the machine - no UI
+	int		TickTurbo(float timeBudgetMS);	// run as many frames as fit in the time budget
+	uint32_t	GetFrameMicroSeconds() const;	// length of a machine frame
 	void	DrawMemoryTools();
 	void	DrawUI();
 	bool	DrawDockingView();
@@ -178,6 +193,15 @@ public:
 
 	float			ExecSpeedScale = 1.0f;
 
+	bool			bEmulateFloatingBus = true;
+	bool			bCaptureEvents = true;
+
+	// Turbo mode - fast forward with no audio, display only updated once per time budget
+	bool			bTurboMode = false;
+	bool			bTurboThinAnalysis = false;	// don't register data accesses or capture events when in turbo mode
+	float			TurboTimeBudgetMS = 14.0f;
+	int				TurboFramesPerTick = 0;
+
 	// Chips UI
 	ui_zx_t			UIZX;
 
@@ -213,9 +237,14 @@ public:
 	// interrupt handling info
 	bool			bHasInterruptHandler = false;
 	uint16_t		InterruptHandlerAddress = 0;
+	uint64_t		LastTickPins = 0;	// for detecting pin edges between ticks
+	uint8_t			LastFE = 0;			// last value written to the ULA port
 	
 	uint16_t		PreviousPC = 0;		// store previous pc
 	int				InstructionsTicks = 0;
+	uint64_t		EmulatedTicks = 0;	// T-states run by TickEmulation
+
+	FEmulationThread	EmulationThread;
 
 	FRZXManager		RZXManager;
 	int				RZXFetchesRemaining = 0;
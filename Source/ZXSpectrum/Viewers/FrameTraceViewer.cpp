@@ -18,8 +18,10 @@ void FFrameTraceViewer::Init(FSpectrumEmu* pEmu)
 	for (int i = 0; i < kNoFramesInTrace; i++)
 	{
 		FrameTrace[i].Texture = ImGui_CreateTextureRGBA(pSpectrumEmu->SpectrumViewer.GetFrameBuffer(), dispInfo.frame.dim.width, dispInfo.frame.dim.height);
+		FrameTrace[i].FramePixels.resize(dispInfo.frame.buffer.size);
 		FrameTrace[i].CPUState = malloc(sizeof(z80_t));
 	}
+	TextureBuffer.resize(std::max((size_t)dispInfo.frame.buffer.size, (size_t)(dispInfo.frame.dim.width * dispInfo.frame.dim.height)));
 
 	ShowWritesView = new FZXGraphicsView(320, 256);
 }
@@ -54,11 +56,15 @@ void FFrameTraceViewer::CaptureFrame()
 {
 	// set up new trace frame
 	FSpeccyFrameTrace& frame = FrameTrace[CurrentTraceFrame];
-	ImGui_UpdateTextureRGBA(frame.Texture, pSpectrumEmu->SpectrumViewer.GetFrameBuffer());
 	frame.InstructionTrace = pSpectrumEmu->CodeAnalysis.Debugger.GetFrameTrace();	// copy frame trace - use method?
 	frame.FrameEvents = pSpectrumEmu->CodeAnalysis.Debugger.GetEventTrace();
 	frame.FrameOverview.clear();
 
+	// copy the display - capture may be on the emulation thread so the texture is updated later on the UI thread
+	const chips_display_info_t dispInfo = zx_display_info(&pSpectrumEmu->ZXEmuState);
+	memcpy(frame.FramePixels.data(), dispInfo.frame.buffer.ptr, frame.FramePixels.size());
+	frame.bTextureDirty = true;
+
 	// copy memory
 	const int noBanks = pSpectrumEmu->ZXEmuState.type == ZX_TYPE_48K ? 3:8;
 	for (int i = 0; i < noBanks; i++)
@@ -80,6 +86,24 @@ void FFrameTraceViewer::CaptureFrame()
 		CurrentTraceFrame = 0;
 }
 
+// Update the textures for the frames captured since the last call
+void FFrameTraceViewer::UpdateTextures()
+{
+	const chips_display_info_t dispInfo = zx_display_info(&pSpectrumEmu->ZXEmuState);
+	const uint32_t* pal = (const uint32_t*)dispInfo.palette.ptr;
+
+	for (int i = 0; i < kNoFramesInTrace; i++)
+	{
+		FSpeccyFrameTrace& frame = FrameTrace[i];
+		if (frame.bTextureDirty == false)
+			continue;
+
+		for (size_t pixNo = 0; pixNo < frame.FramePixels.size(); pixNo++)
+			TextureBuffer[pixNo] = pal[frame.FramePixels[pixNo]];
+		ImGui_UpdateTextureRGBA(frame.Texture, TextureBuffer.data());
+		frame.bTextureDirty = false;
+	}
+}
 
 void FFrameTraceViewer::RestoreFrame(const FSpeccyFrameTrace& frame)
 {
@@ -130,9 +154,9 @@ void FFrameTraceViewer::Draw()
 	if (ImGui::SliderInt("Backwards Offset", &ShowFrame, 0, kNoFramesInTrace - 1))
 	{
 		if (ShowFrame == 0)
-			pSpectrumEmu->CodeAnalysis.Debugger.Continue();
+			pSpectrumEmu->CodeAnalysis.Debugger.QueueCommand(EDebugCommand::Continue);
 		else
-			pSpectrumEmu->CodeAnalysis.Debugger.Break();
+			pSpectrumEmu->CodeAnalysis.Debugger.QueueCommand(EDebugCommand::Break);
 
 		PixelWriteline = -1;
 		SelectedTraceLine = -1;
@@ -158,7 +182,7 @@ void FFrameTraceViewer::Draw()
 		RestoreFrame(frame);
 
 		// continue running
-		pSpectrumEmu->CodeAnalysis.Debugger.Continue();
+		pSpectrumEmu->CodeAnalysis.Debugger.QueueCommand(EDebugCommand::Continue);
 
 		CurrentTraceFrame = frameNo;
 		ShowFrame = 0;
@@ -233,7 +257,11 @@ void	FFrameTraceViewer::DrawInstructionTrace(const FSpeccyFrameTrace& frame)
 			FCodeInfo* pCodeInfo = state.GetCodeInfoForAddress(instAddr);
 			if (pCodeInfo)
 			{
-				ImGui::Text("%s %s", NumStr(instAddr.Address), pCodeInfo->Text.c_str());
+				// disassembly is generated from the memory currently mapped in
+				if (state.IsBankIdMapped(instAddr.BankId))
+					ImGui::Text("%s %s", NumStr(instAddr.Address), GetDisassemblyText(state, instAddr.Address, pCodeInfo).c_str());
+				else
+					ImGui::Text("%s", NumStr(instAddr.Address));
 				ImGui::SameLine();
 				DrawAddressLabel(state, viewState, instAddr);
 			}
@@ -251,38 +279,36 @@ void	FFrameTraceViewer::GenerateTraceOverview(FSpeccyFrameTrace& frame)
 	{
 		const FAddressRef instAddr = frame.InstructionTrace[i];
 
-		// TODO: find closest global label
-		int labelOffset = 0;
+		// find the nearest function, and the code label closest to it
 		uint16_t labelAddress = 0;
 		uint16_t functionAddress = 0;
 		const char* pLabelString = nullptr;
 		bool bFound = false;
 
-		//for (int traceIndex = i; traceIndex >= 0; traceIndex--)
-		for (int addrVal = instAddr.Address; addrVal >= 0; addrVal--)
+		const uint32_t labelTypeMask = (1 << (int)ELabelType::Code) | (1 << (int)ELabelType::Function);
+		FAddressRef searchAddr = state.AddressRefFromPhysicalAddress(instAddr.Address);
+		uint16_t addrVal = 0;
+		while (const FLabelInfo* pLabel = state.FindLabelAtOrBeforeAddress(searchAddr, addrVal, labelTypeMask))
 		{
-			//uint16_t addrVal = frame.InstructionTrace[traceIndex];
-			const FLabelInfo* pLabel = state.GetLabelForPhysicalAddress(addrVal);
-			if (pLabel != nullptr && (pLabel->LabelType == ELabelType::Code || pLabel->LabelType == ELabelType::Function))
+			if (pLabel->LabelType == ELabelType::Function)
 			{
-				if (pLabel->LabelType == ELabelType::Function)
-				{
-					functionAddress = addrVal;
-					pLabelString = pLabel->Name.c_str();
-					bFound = true;
-					if (labelAddress == 0)	// we found a function before a label
-					{
-						labelAddress = functionAddress;
-					}
-					break;
-				}
-				if (pLabel->LabelType == ELabelType::Code)
+				functionAddress = addrVal;
+				pLabelString = pLabel->Name.c_str();
+				bFound = true;
+				if (labelAddress == 0)	// we found a function before a label
 				{
-					labelAddress = addrVal;
+					labelAddress = functionAddress;
 				}
+				break;
+			}
+			if (pLabel->LabelType == ELabelType::Code)
+			{
+				labelAddress = addrVal;
 			}
 
-			labelOffset++;
+			if (addrVal == 0)
+				break;
+			searchAddr = state.AddressRefFromPhysicalAddress(addrVal - 1);
 		}
 
 		if (bFound)
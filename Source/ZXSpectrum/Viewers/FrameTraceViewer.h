@@ -45,6 +45,8 @@ struct FMemoryDiff
 struct FSpeccyFrameTrace
 {
 	void*					Texture = nullptr;
+	std::vector<uint8_t>	FramePixels;	// emulator display palette indices, converted when the texture is updated
+	bool					bTextureDirty = false;
 	uint8_t					MemoryBanks[8][16 * 1024];	// 8 x 16K banks
 	uint8_t					MemoryBankRegister = 0;
 	void*					CPUState = nullptr;
@@ -63,6 +65,7 @@ public:
 	void	Reset();
 	void	Shutdown();
 	void	CaptureFrame();
+	void	UpdateTextures();	// must be called from the UI thread
 	void	Draw();
 private:
 	void	RestoreFrame(const FSpeccyFrameTrace& frame);
@@ -81,6 +84,7 @@ private:
 	bool				RestoreOnScrub = false;
 	static const int	kNoFramesInTrace = 300;
 	FSpeccyFrameTrace	FrameTrace[kNoFramesInTrace];
+	std::vector<uint32_t>	TextureBuffer;	// RGBA conversion buffer for texture updates
 
 	int		SelectedTraceLine = -1;
 	int		PixelWriteline = -1;
@@ -5,7 +5,9 @@
 #include "../SpectrumEmu.h"
 #include "../GameConfig.h"
 #include <algorithm>
+#include <vector>
 #include "CodeAnalyser/UI/CodeAnalyserUI.h"
+#include "CodeAnalyser/UI/MemoryHeatmap.h"
 
 #include "misc/cpp/imgui_stdlib.h"
 #include <Util/Misc.h>
@@ -63,37 +65,6 @@ uint16_t GetAddressOffsetFromPositionInView(const FGraphicsViewerState &viewerSt
 	return ((addrInput + xp) + (column * columnSize) + (y * xSizeChars)) % viewerState.MemorySize;
 }
 
-uint8_t GetHeatmapColourForMemoryAddress(const FCodeAnalysisPage& page, uint16_t addr, int currentFrameNo, int frameThreshold)
-{
-	const uint16_t pageAddress = addr & FCodeAnalysisPage::kPageMask;
-	const FCodeInfo* pCodeInfo = page.CodeInfo[pageAddress];
-
-	if (pCodeInfo)
-	{
-		const int framesSinceExecuted = currentFrameNo - pCodeInfo->FrameLastExecuted;
-		if (pCodeInfo->FrameLastExecuted != -1 && (framesSinceExecuted < frameThreshold))
-			return 6;	// yellow code
-	}
-
-	const FDataInfo& dataInfo = page.DataInfo[pageAddress];
-	
-	if (dataInfo.LastFrameWritten != -1)
-	{
-		const int framesSinceWritten = currentFrameNo - dataInfo.LastFrameWritten;
-		if (framesSinceWritten < frameThreshold)
-			return 2; // red
-	}
-
-	if (dataInfo.LastFrameRead != -1)
-	{
-		const int framesSinceRead = currentFrameNo - dataInfo.LastFrameRead;
-		if (framesSinceRead < frameThreshold)
-			return 4;	// green
-	}	
-
-	return 7;
-}
-
 void DrawMemoryBankAsGraphicsColumn(FGraphicsViewerState& viewerState, int16_t bankId, uint16_t memAddr, int xPos, int columnWidth)
 {
 	FZXGraphicsView* pGraphicsView = viewerState.pGraphicsView;
@@ -101,15 +72,19 @@ void DrawMemoryBankAsGraphicsColumn(FGraphicsViewerState& viewerState, int16_t b
 	FCodeAnalysisBank* pBank = state.GetBank(bankId);
 	const uint16_t bankSizeMask = pBank->SizeMask;
 
+	// column is contiguous memory so get the heatmap for all of it in one go
+	std::vector<uint8_t>& heatmapColours = viewerState.HeatmapColours;
+	heatmapColours.resize(kGraphicsViewerHeight * columnWidth);
+	GetBankHeatmapColours(*pBank, memAddr, (int)heatmapColours.size(), state.CurrentFrameNo, viewerState.HeatmapThreshold, heatmapColours.data());
+	const uint8_t* pColour = heatmapColours.data();
+
 	for (int y = 0; y < kGraphicsViewerHeight; y++)
 	{
 		for (int xChar = 0; xChar < columnWidth; xChar++)
 		{
 			const uint16_t bankAddr = memAddr & bankSizeMask;
 			const uint8_t charLine = pBank->Memory[bankAddr];
-			FCodeAnalysisPage& page = pBank->Pages[bankAddr >> FCodeAnalysisPage::kPageShift];
-			const uint8_t col = GetHeatmapColourForMemoryAddress(page, memAddr, state.CurrentFrameNo,viewerState.HeatmapThreshold);
-			pGraphicsView->DrawCharLine(charLine, xPos + (xChar * 8), y, col);
+			pGraphicsView->DrawCharLine(charLine, xPos + (xChar * 8), y, *pColour++);
 
 			memAddr++;
 		}
@@ -392,6 +367,9 @@ void DrawScreenViewer(FGraphicsViewerState& viewerState)
 	const int16_t bankId = viewerState.Bank == -1 ? state.GetBankFromAddress(0x4000) : viewerState.Bank;
 	const FCodeAnalysisBank* pBank = state.GetBank(bankId);
 
+	uint8_t heatmapColours[0x1800];	// bitmap part of the screen
+	GetBankHeatmapColours(*pBank, 0, sizeof(heatmapColours), state.CurrentFrameNo, viewerState.HeatmapThreshold, heatmapColours);
+
 	uint16_t bankAddr = 0;
 	for (int y = 0; y < 192; y++)
 	{
@@ -407,8 +385,7 @@ void DrawScreenViewer(FGraphicsViewerState& viewerState)
 		for (int x = 0; x < 256 / 8; x++)
 		{
 			const uint8_t charLine = pBank->Memory[bankAddr];
-			const FCodeAnalysisPage& page = pBank->Pages[bankAddr >> 10];
-			const uint8_t col = GetHeatmapColourForMemoryAddress(page, bankAddr, state.CurrentFrameNo, viewerState.HeatmapThreshold);
+			const uint8_t col = heatmapColours[bankAddr];
 
 			for (int xpix = 0; xpix < 8; xpix++)
 			{
@@ -5,6 +5,7 @@
 #include "SpriteViewer.h"
 #include <map>
 #include <string>
+#include <vector>
 
 #include <CodeAnalyser/CodeAnalyserTypes.h>
 
@@ -48,6 +49,7 @@ struct FGraphicsViewerState
 	FZXGraphicsView* pScreenView = nullptr;
 	FSpectrumEmu*	pEmu = nullptr;		// can we phase this out?
 	FGame*			pGame = nullptr;	// can we phase this out?
+	std::vector<uint8_t>	HeatmapColours;	// scratch buffer for drawing a column's heatmap
 
 };
 
@@ -51,9 +51,8 @@ void FOverviewViewer::CalculateStats()
         }
         else
         {
-            const FDataInfo *pDataInfo = pSpectrumEmu->CodeAnalysis.GetReadDataInfoForAddress(i);
-            const bool bRead = pDataInfo->LastFrameRead != -1;
-            const bool bWrite = pDataInfo->LastFrameWritten != -1;
+            const bool bRead = pSpectrumEmu->CodeAnalysis.GetLastFrameReadForAddress((uint16_t)i) != -1;
+            const bool bWrite = pSpectrumEmu->CodeAnalysis.GetLastFrameWrittenForAddress((uint16_t)i) != -1;
 
             if (bInRom)
             {
@@ -27,28 +27,41 @@ void FSpectrumViewer::Init(FSpectrumEmu* pEmu)
 
 	// setup pixel buffer
 	const size_t pixelBufferSize = dispInfo.frame.dim.width * dispInfo.frame.dim.height;
-	FrameBuffer = new uint32_t[pixelBufferSize * 2];
-	ScreenTexture = ImGui_CreateTextureRGBA(FrameBuffer, dispInfo.frame.dim.width, dispInfo.frame.dim.height);
+	for (int i = 0; i < 2; i++)
+		FrameBuffers[i] = new uint32_t[pixelBufferSize * 2];
+	ScreenTexture = ImGui_CreateTextureRGBA(GetFrameBuffer(), dispInfo.frame.dim.width, dispInfo.frame.dim.height);
 
 	//SetInputEventHandler(this);
 }
 
-void FSpectrumViewer::Draw()
+// Called by the emulation at the end of each frame
+void FSpectrumViewer::UpdateFrameBuffer()
 {
-	const FGlobalConfig& config = GetGlobalConfig();
-	FCodeAnalysisState& codeAnalysis = pSpectrumEmu->CodeAnalysis;
-	FDebugger& debugger = codeAnalysis.Debugger;
-	FCodeAnalysisViewState& viewState = codeAnalysis.GetFocussedViewState();
-
+	const int backBuffer = FrontBuffer ^ 1;
+	uint32_t* pFrameBuffer = FrameBuffers[backBuffer];
 	chips_display_info_t disp = zx_display_info(&pSpectrumEmu->ZXEmuState);
 
 	// convert texture to RGBA
 	const uint8_t* pix = (const uint8_t*)disp.frame.buffer.ptr;
 	const uint32_t* pal = (const uint32_t*)disp.palette.ptr;
 	for (int i = 0; i < disp.frame.buffer.size; i++)
-		FrameBuffer[i] = pal[pix[i]];
+		pFrameBuffer[i] = pal[pix[i]];
 
-	ImGui_UpdateTextureRGBA(ScreenTexture, FrameBuffer);
+	FrontBuffer = backBuffer;
+}
+
+void FSpectrumViewer::Draw()
+{
+	const FGlobalConfig& config = GetGlobalConfig();
+	FCodeAnalysisState& codeAnalysis = pSpectrumEmu->CodeAnalysis;
+	FDebugger& debugger = codeAnalysis.Debugger;
+	FCodeAnalysisViewState& viewState = codeAnalysis.GetFocussedViewState();
+
+	// show the live display when stepping through code
+	if (debugger.IsStopped())
+		UpdateFrameBuffer();
+
+	ImGui_UpdateTextureRGBA(ScreenTexture, GetFrameBuffer());
 
 	const ImVec2 pos = ImGui::GetCursorScreenPos();
 	//ImGui::Text("Instructions this frame: %d \t(max:%d)", instructionsThisFrame,maxInst);
@@ -214,6 +227,16 @@ void FSpectrumViewer::Draw()
 	ImGui::SameLine();
 	if (ImGui::Button("Reset"))
 		pSpectrumEmu->ExecSpeedScale = 1.0f;
+	ImGui::Checkbox("Turbo", &pSpectrumEmu->bTurboMode);
+	ImGui::SameLine();
+	ImGui::Checkbox("Thin Analysis", &pSpectrumEmu->bTurboThinAnalysis);
+	if (ImGui::IsItemHovered())
+		ImGui::SetTooltip("When in turbo mode don't register data reads & writes or capture events.\nIO analysis only tracks the ULA port & bank switching.");
+	if (pSpectrumEmu->bTurboMode)
+	{
+		ImGui::SameLine();
+		ImGui::Text("%d frames/tick", pSpectrumEmu->TurboFramesPerTick);
+	}
 	ImGui::Text("Application average %.3f ms/frame (%.1f FPS)", 1000.0f / ImGui::GetIO().Framerate, ImGui::GetIO().Framerate);
 
 	if (pSpectrumEmu->bHasInterruptHandler)
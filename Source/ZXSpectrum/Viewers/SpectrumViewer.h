@@ -1,5 +1,6 @@
 #pragma once
 
+#include <atomic>
 #include <cstdint>
 
 #include "imgui.h"
@@ -19,7 +20,9 @@ public:
 	void	Draw();
 	void	Tick(void);
 
-	const uint32_t* GetFrameBuffer() const { return FrameBuffer; }
+	void	UpdateFrameBuffer();	// convert the emulator display into the back buffer & flip
+
+	const uint32_t* GetFrameBuffer() const { return FrameBuffers[FrontBuffer]; }
 
 private:
 	// private methods
@@ -29,7 +32,8 @@ private:
 private:
 	FSpectrumEmu* pSpectrumEmu = nullptr;
 
-	uint32_t*		FrameBuffer;	// pixel buffer to store emu output
+	uint32_t*		FrameBuffers[2] = { nullptr, nullptr };	// double buffered pixel buffer to store emu output
+	std::atomic<int>	FrontBuffer = 0;
 	ImTextureID		ScreenTexture;		// texture 
 
 	// screen inspector
@@ -11,6 +11,7 @@
 #include <tchar.h>
 
 #include "../SpectrumEmu.h"
+#include "../GlobalConfig.h"
 
 #define SOKOL_IMPL
 #include "sokol_audio.h"
@@ -131,6 +132,9 @@ int main(int argc, char** argv)
     if (argc > 2)
         pSpectrumEmulator->ImportSkoolFile(argv[2]);
 
+    if (GetGlobalConfig().bThreadedEmulation)
+        pSpectrumEmulator->EmulationThread.Start(pSpectrumEmulator);
+
     // Main loop
     MSG msg;
     ZeroMemory(&msg, sizeof(msg));
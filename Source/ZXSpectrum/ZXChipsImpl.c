@@ -70,124 +70,175 @@ uint64_t ReadInputIOTick(uint64_t pins, GetIOInput ioInputCB, void* pUserData)
 	return pins;
 }
 
-uint32_t ZXExeEmu(zx_t* sys, uint32_t micro_seconds) 
+#if defined(_MSC_VER)
+#define ZX_FORCE_INLINE __forceinline
+#else
+#define ZX_FORCE_INLINE inline __attribute__((always_inline))
+#endif
+
+uint32_t clk_ticks_to_us(uint64_t freq_hz, uint32_t ticks);
+
+// Generic tick loop - 'features' is always a constant so each caller below gets its own loop with the unused branches removed
+// The loop stops early if the debugger stops - pTickCount gets the number of ticks actually run
+static ZX_FORCE_INLINE uint64_t ZXTickLoop(zx_t* sys, uint64_t pins, uint32_t num_ticks, uint32_t* pTickCount, const uint32_t features)
 {
-	CHIPS_ASSERT(sys && sys->valid);
-	const uint32_t num_ticks = clk_us_to_ticks(sys->freq_hz, micro_seconds);
-	uint64_t pins = sys->pins;
-	
-	if (sys->debug.callback.func == NULL) 
+	uint32_t tick = 0;
+	if (features & ZX_TICK_DEBUGHOOK)
 	{
-		// run without debug hook
-		for (uint32_t tick = 0; tick < num_ticks; tick++) 
+		for (; (tick < num_ticks) && !(*sys->debug.stopped); tick++)
 		{
 			pins = _zx_tick(sys, pins);
-			pins = FloatingBusTick(sys, pins);
+			if (features & ZX_TICK_FLOATINGBUS)
+				pins = FloatingBusTick(sys, pins);
+			sys->debug.callback.func(sys->debug.callback.user_data, pins);
 		}
 	}
-	else 
+	else
 	{
-		// run with debug hook
-		for (uint32_t tick = 0; (tick < num_ticks) && !(*sys->debug.stopped); tick++) 
+		for (; tick < num_ticks; tick++)
 		{
 			pins = _zx_tick(sys, pins);
-			pins = FloatingBusTick(sys, pins);
-			sys->debug.callback.func(sys->debug.callback.user_data, pins);
+			if (features & ZX_TICK_FLOATINGBUS)
+				pins = FloatingBusTick(sys, pins);
 		}
 	}
-	sys->pins = pins;
-	kbd_update(&sys->kbd, micro_seconds);
-	return num_ticks;
+	*pTickCount = tick;
+	return pins;
 }
 
-uint32_t clk_ticks_to_us(uint64_t freq_hz, uint32_t ticks) 
+#define ZX_TICK_LOOP(name, features) \
+	static uint64_t name(zx_t* sys, uint64_t pins, uint32_t num_ticks, uint32_t* pTickCount) { return ZXTickLoop(sys, pins, num_ticks, pTickCount, features); }
+
+ZX_TICK_LOOP(ZXTickLoop_0, 0)
+ZX_TICK_LOOP(ZXTickLoop_1, 1)
+ZX_TICK_LOOP(ZXTickLoop_2, 2)
+ZX_TICK_LOOP(ZXTickLoop_3, 3)
+
+typedef uint64_t(*ZXTickLoopFunc)(zx_t* sys, uint64_t pins, uint32_t num_ticks, uint32_t* pTickCount);
+
+// indexed by feature mask
+static const ZXTickLoopFunc g_ZXTickLoops[] =
 {
-	return (uint32_t)((ticks * 1000000) / freq_hz);
+	ZXTickLoop_0, ZXTickLoop_1, ZXTickLoop_2, ZXTickLoop_3,
+};
+
+uint32_t ZXExeEmu(zx_t* sys, uint32_t micro_seconds) 
+{
+	uint32_t features = ZX_TICK_FLOATINGBUS;
+	if (sys->debug.callback.func != NULL)
+		features |= ZX_TICK_DEBUGHOOK;
+
+	return ZXExeEmu_Features(sys, micro_seconds, features);
 }
 
-uint32_t ZXExeEmu_UseFetchCount(zx_t* sys, uint32_t noFetches, GetIOInput ioInputCB, void* pUserData)
+uint32_t ZXExeEmu_Features(zx_t* sys, uint32_t micro_seconds, uint32_t features)
 {
 	CHIPS_ASSERT(sys && sys->valid);
-	uint64_t pins = sys->pins;
-	uint32_t fetchCount = 0;
+	const uint32_t num_ticks = clk_us_to_ticks(sys->freq_hz, micro_seconds);
 	uint32_t tickCount = 0;
 
-	uint32_t rCounter = 0;
-
 	if (sys->debug.callback.func == NULL)
-	{
-		// run without debug hook
-		while(fetchCount < noFetches)
-		{
-			pins = _zx_tick(sys, pins);
-			pins = FloatingBusTick(sys, pins);
-			if (ioInputCB)
-				pins = ReadInputIOTick(pins, ioInputCB, pUserData);
+		features &= ~ZX_TICK_DEBUGHOOK;
 
-			if (z80_opdone(&sys->cpu))
-			{
-				const uint16_t pc = pins & 0xffff;
-				const uint8_t opcode = mem_rd(&sys->mem, pc);
-				if (opcode == 0xED || opcode == 0xCB)
-					fetchCount++;
-				else if (opcode == 0xDD || opcode == 0xFD)
-				{
-					fetchCount++;
-					const uint8_t opcode2 = mem_rd(&sys->mem, pc + 1);
-					if (opcode2 == 0xCB)
-						fetchCount++;
-				}
-
-				fetchCount++;
-			}
-			tickCount++;
-		}
+	sys->pins = g_ZXTickLoops[features & (ZX_TICK_FLOATINGBUS | ZX_TICK_DEBUGHOOK)](sys, sys->pins, num_ticks, &tickCount);
+	kbd_update(&sys->kbd, tickCount == num_ticks ? micro_seconds : clk_ticks_to_us(sys->freq_hz, tickCount));
+	return tickCount;
+}
+
+uint32_t clk_ticks_to_us(uint64_t freq_hz, uint32_t ticks) 
+{
+	return (uint32_t)(((uint64_t)ticks * 1000000) / freq_hz);
+}
+
+// Count opcode fetches for the instruction that's just been completed
+static ZX_FORCE_INLINE uint32_t ZXCountOpcodeFetches(zx_t* sys, uint64_t pins)
+{
+	const uint16_t pc = pins & 0xffff;
+	const uint8_t opcode = mem_rd(&sys->mem, pc);
+	if (opcode == 0xED || opcode == 0xCB)
+		return 2;
+	if (opcode == 0xDD || opcode == 0xFD)
+	{
+		const uint8_t opcode2 = mem_rd(&sys->mem, pc + 1);
+		return opcode2 == 0xCB ? 3 : 2;
 	}
-	else
+	return 1;
+}
+
+// Generic fetch counting loop - specialised the same way as ZXTickLoop
+static ZX_FORCE_INLINE uint64_t ZXFetchCountLoop(zx_t* sys, uint64_t pins, uint32_t noFetches, GetIOInput ioInputCB, void* pUserData, uint32_t* pFetchCount, uint32_t* pTickCount, const uint32_t features)
+{
+	uint32_t fetchCount = 0;
+	uint32_t tickCount = 0;
+
+	while (fetchCount < noFetches)
 	{
-		// run with debug hook
-		while (fetchCount < noFetches && !(*sys->debug.stopped))
-		{
-			/*switch (sys->cpu.step)
-			{
-			case 1:
-			case 4:
-			case 23:
-			case 26:
-			case 1471:
-			case 1490:
-			case 1507:
-				fetchCount++;
-			}*/
+		if ((features & ZX_TICK_DEBUGHOOK) && *sys->debug.stopped)
+			break;
 
-			pins = _zx_tick(sys, pins);
+		pins = _zx_tick(sys, pins);
+		if (features & ZX_TICK_FLOATINGBUS)
 			pins = FloatingBusTick(sys, pins);
-			if (ioInputCB)
-				pins = ReadInputIOTick(pins, ioInputCB, pUserData);
+		if (features & ZX_TICK_IOINPUT)
+			pins = ReadInputIOTick(pins, ioInputCB, pUserData);
+		if (features & ZX_TICK_DEBUGHOOK)
 			sys->debug.callback.func(sys->debug.callback.user_data, pins);
-			if (z80_opdone(&sys->cpu))
-			{
-				const uint16_t pc = pins & 0xffff;
-				const uint8_t opcode = mem_rd(&sys->mem, pc);
-				if (opcode == 0xED || opcode == 0xCB)
-					fetchCount++;
-				else if (opcode == 0xDD || opcode == 0xFD)
-				{
-					fetchCount++;
-					const uint8_t opcode2 = mem_rd(&sys->mem, pc+1);
-					if(opcode2 == 0xCB)
-						fetchCount++;
-				}
-
-				fetchCount++;
-			}
 
-			tickCount++;
-		}
+		if (z80_opdone(&sys->cpu))
+			fetchCount += ZXCountOpcodeFetches(sys, pins);
+
+		tickCount++;
 	}
 
-	sys->pins = pins;
+	*pFetchCount = fetchCount;
+	*pTickCount = tickCount;
+	return pins;
+}
+
+#define ZX_FETCHCOUNT_LOOP(name, features) \
+	static uint64_t name(zx_t* sys, uint64_t pins, uint32_t noFetches, GetIOInput ioInputCB, void* pUserData, uint32_t* pFetchCount, uint32_t* pTickCount) \
+	{ return ZXFetchCountLoop(sys, pins, noFetches, ioInputCB, pUserData, pFetchCount, pTickCount, features); }
+
+ZX_FETCHCOUNT_LOOP(ZXFetchCountLoop_0, 0)
+ZX_FETCHCOUNT_LOOP(ZXFetchCountLoop_1, 1)
+ZX_FETCHCOUNT_LOOP(ZXFetchCountLoop_2, 2)
+ZX_FETCHCOUNT_LOOP(ZXFetchCountLoop_3, 3)
+ZX_FETCHCOUNT_LOOP(ZXFetchCountLoop_4, 4)
+ZX_FETCHCOUNT_LOOP(ZXFetchCountLoop_5, 5)
+ZX_FETCHCOUNT_LOOP(ZXFetchCountLoop_6, 6)
+ZX_FETCHCOUNT_LOOP(ZXFetchCountLoop_7, 7)
+
+typedef uint64_t(*ZXFetchCountLoopFunc)(zx_t* sys, uint64_t pins, uint32_t noFetches, GetIOInput ioInputCB, void* pUserData, uint32_t* pFetchCount, uint32_t* pTickCount);
+
+// indexed by feature mask
+static const ZXFetchCountLoopFunc g_ZXFetchCountLoops[] =
+{
+	ZXFetchCountLoop_0, ZXFetchCountLoop_1, ZXFetchCountLoop_2, ZXFetchCountLoop_3,
+	ZXFetchCountLoop_4, ZXFetchCountLoop_5, ZXFetchCountLoop_6, ZXFetchCountLoop_7,
+};
+
+uint32_t ZXExeEmu_UseFetchCount(zx_t* sys, uint32_t noFetches, GetIOInput ioInputCB, void* pUserData)
+{
+	return ZXExeEmu_UseFetchCount_Features(sys, noFetches, ioInputCB, pUserData, ZX_TICK_FLOATINGBUS | ZX_TICK_DEBUGHOOK, NULL);
+}
+
+uint32_t ZXExeEmu_UseFetchCount_Features(zx_t* sys, uint32_t noFetches, GetIOInput ioInputCB, void* pUserData, uint32_t features, uint32_t* pTicksExecuted)
+{
+	CHIPS_ASSERT(sys && sys->valid);
+	uint32_t fetchCount = 0;
+	uint32_t tickCount = 0;
+
+	if (sys->debug.callback.func == NULL)
+		features &= ~ZX_TICK_DEBUGHOOK;
+	if (ioInputCB != NULL)
+		features |= ZX_TICK_IOINPUT;
+	else
+		features &= ~ZX_TICK_IOINPUT;
+
+	sys->pins = g_ZXFetchCountLoops[features & (ZX_TICK_FLOATINGBUS | ZX_TICK_DEBUGHOOK | ZX_TICK_IOINPUT)](sys, sys->pins, noFetches, ioInputCB, pUserData, &fetchCount, &tickCount);
 	kbd_update(&sys->kbd, clk_ticks_to_us(sys->freq_hz, tickCount));
 
+	if (pTicksExecuted != NULL)
+		*pTicksExecuted = tickCount;
 	return fetchCount;
-}
\ No newline at end of file
+}
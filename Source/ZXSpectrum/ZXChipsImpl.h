@@ -17,9 +17,16 @@ extern "C" {
 	
 typedef bool(*GetIOInput)(uint16_t port, uint8_t* pInVal, void* pUserData);
 
+// Tick loop features - there is a specialised loop for each combination
+#define ZX_TICK_FLOATINGBUS		(1 << 0)	// emulate floating bus reads
+#define ZX_TICK_DEBUGHOOK		(1 << 1)	// call the debug callback every tick (ignored if there isn't one)
+#define ZX_TICK_IOINPUT			(1 << 2)	// read IO input from callback (fetch count loop only, set when there's a callback)
+
 void ZXDecodeScreen(zx_t* pZX);
 uint32_t ZXExeEmu(zx_t* sys, uint32_t micro_seconds);
+uint32_t ZXExeEmu_Features(zx_t* sys, uint32_t micro_seconds, uint32_t features);	// returns the number of ticks run - fewer than requested if the debugger stops
 uint32_t ZXExeEmu_UseFetchCount(zx_t* sys, uint32_t noFetches, GetIOInput ioInputCB, void* pUserData);
+uint32_t ZXExeEmu_UseFetchCount_Features(zx_t* sys, uint32_t noFetches, GetIOInput ioInputCB, void* pUserData, uint32_t features, uint32_t* pTicksExecuted);	// pTicksExecuted can be NULL
 
 #ifdef __cplusplus
 } // extern "C"